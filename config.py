@@ -11,4 +11,4 @@ def get_doc_path():
 
 
 def get_doc_classes():
-    return ["Slicer", "SlicedMesh"]
+    return ["Slicer", "SlicedMesh", "SliceTask", "SliceEngine", "SliceJob"]
@@ -31,6 +31,9 @@
 #include "register_types.h"
 
 #include "core/object/class_db.h"
+#include "slice_engine.h"
+#include "slice_job.h"
+#include "slice_task.h"
 #include "sliced_mesh.h"
 #include "slicer.h"
 
@@ -40,6 +43,9 @@ void initialize_slicer_module(ModuleInitializationLevel p_level) {
 	}
 	GDREGISTER_CLASS(Slicer);
 	GDREGISTER_CLASS(SlicedMesh);
+	GDREGISTER_CLASS(SliceEngine);
+	GDREGISTER_CLASS(SliceTask);
+	GDREGISTER_CLASS(SliceJob);
 }
 
 void uninitialize_slicer_module(ModuleInitializationLevel p_level) {
@@ -0,0 +1,636 @@
+/**************************************************************************/
+/*  slice_engine.cpp                                                      */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "slice_engine.h"
+
+#include "core/error/error_macros.h"
+#include "core/math/convex_hull.h"
+#include "core/math/random_pcg.h"
+#include "core/object/worker_thread_pool.h"
+#include "slice_job.h"
+#include "slice_task.h"
+#include "utils/dicer.h"
+#include "utils/face_buffer.h"
+#include "utils/intersector.h"
+#include "utils/parsed_mesh.h"
+#include "utils/triangulator.h"
+
+Ref<SlicedMesh> SliceEngine::slice_by_plane(const Ref<Mesh> &mesh, const Plane &plane, const Ref<Material> &cross_section_material) const {
+	return slice_by_plane_with(get_settings(), mesh, plane, cross_section_material);
+}
+
+Ref<SlicedMesh> SliceEngine::slice_by_plane_with(const Settings &settings, const Ref<Mesh> &mesh, const Plane &plane, const Ref<Material> &cross_section_material) {
+	PlaneSliceInput input;
+	if (!read_for_plane(settings, mesh, plane, input)) {
+		return Ref<SlicedMesh>();
+	}
+	return slice_input_by_plane(settings, input, plane, cross_section_material);
+}
+
+bool SliceEngine::read_for_plane(const Settings &settings, const Ref<Mesh> &mesh, const Plane &plane, PlaneSliceInput &r_input) {
+	ERR_FAIL_COND_V(mesh.is_null(), false);
+
+	// A plane that misses the mesh's bounds can't produce any intersection points, so
+	// bail before paying for reading in a single face
+	if (Intersector::get_side_of_aabb(plane, mesh->get_aabb()) != Intersector::SideOfPlane::ON) {
+		return false;
+	}
+
+	r_input.parsed = settings.use_mesh_cache ? settings.mesh_cache->get_parsed_mesh(mesh, settings.preserve_indices, settings.use_bvh) : ParsedMesh::parse_for_plane(mesh, settings.preserve_indices, plane);
+	ERR_FAIL_COND_V(r_input.parsed.is_null(), false);
+
+	// Surfaces passed through untouched still need their arrays read out of the mesh
+	r_input.split_results.resize(r_input.parsed->surfaces.size());
+	for (int i = 0; i < (int)r_input.parsed->surfaces.size(); i++) {
+		prepare_split(settings, mesh, r_input.parsed->surfaces[i], i, plane, r_input.split_results.write[i]);
+	}
+	return true;
+}
+
+Ref<SlicedMesh> SliceEngine::slice_input_by_plane(const Settings &settings, PlaneSliceInput &input, const Plane &plane, const Ref<Material> &cross_section_material) {
+	const Ref<ParsedMesh> &parsed = input.parsed;
+	ERR_FAIL_COND_V(parsed.is_null(), Ref<SlicedMesh>());
+
+	// The upper and lower meshes will share the same cross section, traced out by the
+	// segments cut across every surface
+	Vector<Vector3> cut_segments;
+
+	for (int i = 0; i < (int)parsed->surfaces.size(); i++) {
+		// Split straight into the stored result, copying a SplitResult now means copying
+		// whole face buffers
+		Intersector::SplitResult &results = input.split_results.write[i];
+		const ParsedMesh::Surface &surface = parsed->surfaces[i];
+		if (results.unsplit_side != Intersector::SideOfPlane::ON) {
+			continue;
+		}
+
+		// The segments go straight on the end of the ones cut so far, handing the one array
+		// from surface to surface rather than growing a new one for each
+		results.cut_segments = cut_segments;
+		cut_segments = Vector<Vector3>();
+		Intersector::split_surface_by_plane(plane, surface.faces, results, &surface.bvh);
+		cut_segments = results.cut_segments;
+		results.cut_segments = Vector<Vector3>();
+	}
+
+	// If no intersection has occurred then there's really nothing for us to do
+	// but still, is this the expected behavior? Would it be better to return an
+	// actual SliceMesh with either the upper_mesh or lower_mesh null?
+	if (cut_segments.size() == 0) {
+		return Ref<SlicedMesh>();
+	}
+
+	FaceBuffer cross_section_faces = Triangulator::triangulate_segments(cut_segments, plane.normal, settings.preserve_indices);
+	return create_sliced_mesh(settings, input.split_results, cross_section_faces, cross_section_material);
+}
+
+bool SliceEngine::prepare_split(const Settings &settings, const Ref<Mesh> &mesh, const ParsedMesh::Surface &surface, int surface_idx, const Plane &plane, Intersector::SplitResult &results) {
+	results.material = surface.material;
+	results.keep_upper = settings.halves != HALVES_LOWER;
+	results.keep_lower = settings.halves != HALVES_UPPER;
+
+	// Surfaces that sit entirely on one side of the plane have nothing to split and
+	// go to that half untouched, unless that half isn't wanted at all
+	Intersector::SideOfPlane side = Intersector::get_side_of_aabb(plane, surface.aabb);
+	if (side != Intersector::SideOfPlane::ON && (surface.faces.size() > 0 || !surface.arrays.is_empty())) {
+		results.unsplit_side = side;
+		if (results.keeps(side)) {
+			results.unsplit_arrays = surface.arrays.is_empty() ? mesh->surface_get_arrays(surface_idx) : surface.arrays;
+			results.unsplit_format = mesh->surface_get_format(surface_idx);
+		}
+		return false;
+	}
+
+	results.set_format(surface.faces.format);
+	return true;
+}
+
+Ref<SlicedMesh> SliceEngine::create_sliced_mesh(const Settings &settings, const Vector<Intersector::SplitResult> &split_results, const FaceBuffer &cross_section_faces, const Ref<Material> &cross_section_material) {
+	bool keep_upper = settings.halves != HALVES_LOWER;
+	bool keep_lower = settings.halves != HALVES_UPPER;
+
+	Ref<SlicedMesh> sliced_mesh;
+	sliced_mesh.instantiate();
+	if (!settings.use_mesh_cache || !settings.keep_sliced_faces) {
+		// Nothing needs the halves yet, so they're left to be built when first asked for
+		sliced_mesh->defer_mesh(split_results, cross_section_faces, cross_section_material, keep_upper, keep_lower);
+		return sliced_mesh;
+	}
+
+	// Caching the halves means building them right away, the cache is keyed on the meshes
+	sliced_mesh->create_mesh(split_results, cross_section_faces, cross_section_material, true, keep_upper, keep_lower);
+
+	// The halves are brand new meshes, so nothing can have changed them since
+	if (keep_upper) {
+		settings.mesh_cache->add_parsed_mesh(sliced_mesh->get_upper_mesh(), sliced_mesh->upper_parsed);
+	}
+	if (keep_lower) {
+		settings.mesh_cache->add_parsed_mesh(sliced_mesh->get_lower_mesh(), sliced_mesh->lower_parsed);
+	}
+	return sliced_mesh;
+}
+
+TypedArray<Mesh> SliceEngine::slice_by_planes(const Ref<Mesh> &mesh, const TypedArray<Plane> &planes, const Ref<Material> &cross_section_material) const {
+	ERR_FAIL_COND_V(mesh.is_null(), TypedArray<Mesh>());
+	ERR_FAIL_COND_V(planes.is_empty(), TypedArray<Mesh>());
+
+	// Every plane gets turned around to face the same way as the first, which leaves them
+	// as a single axis of offsets along its normal
+	Vector3 normal = Plane(planes[0]).normalized().normal;
+	Vector<real_t> offsets;
+	for (int i = 0; i < planes.size(); i++) {
+		Plane plane = Plane(planes[i]).normalized();
+		if (plane.normal.is_equal_approx(normal)) {
+			offsets.push_back(plane.d);
+		} else if (plane.normal.is_equal_approx(-normal)) {
+			offsets.push_back(-plane.d);
+		} else {
+			ERR_FAIL_V_MSG(TypedArray<Mesh>(), "The planes passed to slice_by_planes must all be parallel.");
+		}
+	}
+
+	Dicer dicer;
+	dicer.add_axis(normal, offsets);
+	return dice_mesh(get_settings(), mesh, dicer, cross_section_material);
+}
+
+TypedArray<Mesh> SliceEngine::slice_by_grid(const Ref<Mesh> &mesh, const PackedFloat32Array &x_offsets, const PackedFloat32Array &y_offsets, const PackedFloat32Array &z_offsets, const Ref<Material> &cross_section_material) const {
+	ERR_FAIL_COND_V(mesh.is_null(), TypedArray<Mesh>());
+
+	const PackedFloat32Array *axis_offsets[3] = { &x_offsets, &y_offsets, &z_offsets };
+	Dicer dicer;
+	for (int i = 0; i < 3; i++) {
+		if (axis_offsets[i]->is_empty()) {
+			continue;
+		}
+
+		Vector3 normal;
+		normal[i] = 1;
+		Vector<real_t> offsets;
+		offsets.resize(axis_offsets[i]->size());
+		for (int j = 0; j < offsets.size(); j++) {
+			offsets.write[j] = (*axis_offsets[i])[j];
+		}
+		dicer.add_axis(normal, offsets);
+	}
+
+	return dice_mesh(get_settings(), mesh, dicer, cross_section_material);
+}
+
+TypedArray<Mesh> SliceEngine::dice_mesh(const Settings &settings, const Ref<Mesh> &mesh, Dicer &dicer, const Ref<Material> &cross_section_material) {
+	// Dicing only works on loose faces, so the mesh is always parsed without its indices
+	Ref<ParsedMesh> parsed = settings.use_mesh_cache ? settings.mesh_cache->get_parsed_mesh(mesh, false) : ParsedMesh::parse(mesh, false);
+	ERR_FAIL_COND_V(parsed.is_null(), TypedArray<Mesh>());
+
+	Vector<Ref<Material>> materials;
+	dicer.begin(parsed->surfaces.size());
+	for (uint32_t i = 0; i < parsed->surfaces.size(); i++) {
+		materials.push_back(parsed->surfaces[i].material);
+		dicer.dice_surface(i, parsed->surfaces[i].faces);
+	}
+	dicer.build_cross_sections();
+
+	TypedArray<Mesh> pieces;
+	for (uint32_t i = 0; i < dicer.cells.size(); i++) {
+		const Dicer::Cell &cell = dicer.cells[i];
+		if (!cell.is_empty()) {
+			pieces.push_back(SlicedMesh::create_piece(cell.surfaces, materials, cell.cross_section, cross_section_material));
+		}
+	}
+	return pieces;
+}
+
+Ref<SlicedMesh> SliceEngine::slice_by_convex(const Ref<Mesh> &mesh, const TypedArray<Plane> &planes, const Ref<Material> &cross_section_material) const {
+	ERR_FAIL_COND_V(mesh.is_null(), Ref<SlicedMesh>());
+	ERR_FAIL_COND_V(planes.is_empty(), Ref<SlicedMesh>());
+
+	Vector<Plane> volume;
+	for (int i = 0; i < planes.size(); i++) {
+		volume.push_back(Plane(planes[i]).normalized());
+	}
+	return slice_by_volume(get_settings(), mesh, volume, cross_section_material);
+}
+
+Ref<SlicedMesh> SliceEngine::slice_by_convex_shape(const Ref<Mesh> &mesh, const Ref<ConvexPolygonShape3D> &shape, const Transform3D &shape_transform, const Ref<Material> &cross_section_material) const {
+	ERR_FAIL_COND_V(mesh.is_null(), Ref<SlicedMesh>());
+	ERR_FAIL_COND_V(shape.is_null(), Ref<SlicedMesh>());
+
+	Vector<Vector3> points = shape->get_points();
+	for (int i = 0; i < points.size(); i++) {
+		points.write[i] = shape_transform.xform(points[i]);
+	}
+
+	Geometry3D::MeshData hull;
+	Error err = ConvexHullComputer::convex_hull(points, hull);
+	ERR_FAIL_COND_V_MSG(err != OK || hull.faces.size() < 4, Ref<SlicedMesh>(), "Couldn't build a closed convex hull out of the shape's points.");
+
+	Vector<Plane> volume;
+	for (uint32_t i = 0; i < hull.faces.size(); i++) {
+		volume.push_back(hull.faces[i].plane);
+	}
+	return slice_by_volume(get_settings(), mesh, volume, cross_section_material);
+}
+
+/**
+ * Cuts every surface of the parsed mesh by a convex volume, see slice_by_convex. Surfaces
+ * which don't reach any of the planes get marked as unsplit, but since this also runs off
+ * the main thread filling in their arrays is left to the caller
+ */
+static void split_by_volume(const ParsedMesh &parsed, const Vector<Plane> &planes, bool p_keep_outside, bool p_keep_inside, Vector<Intersector::SplitResult> &r_split_results, FaceBuffer &r_cross_section_faces) {
+	r_split_results.resize(parsed.surfaces.size());
+	LocalVector<Vector<Vector3>> plane_segments;
+	plane_segments.resize(planes.size());
+	LocalVector<Vector<Vector3>> surface_segments;
+
+	for (int i = 0; i < (int)parsed.surfaces.size(); i++) {
+		Intersector::SplitResult &results = r_split_results.write[i];
+		const ParsedMesh::Surface &surface = parsed.surfaces[i];
+		results.material = surface.material;
+		results.keep_upper = p_keep_outside;
+		results.keep_lower = p_keep_inside;
+
+		// A surface which doesn't reach any of the planes is either outside of one of them
+		// or inside all of them, and goes to that side untouched
+		Intersector::SideOfPlane side = Intersector::SideOfPlane::UNDER;
+		for (int p = 0; p < planes.size() && side != Intersector::SideOfPlane::ON; p++) {
+			Intersector::SideOfPlane plane_side = Intersector::get_side_of_aabb(planes[p], surface.aabb);
+			if (plane_side != Intersector::SideOfPlane::UNDER) {
+				side = plane_side;
+			}
+		}
+		if (side != Intersector::SideOfPlane::ON && surface.faces.size() > 0) {
+			results.unsplit_side = side;
+			continue;
+		}
+
+		results.set_format(surface.faces.format);
+		Intersector::split_surface_by_convex(planes, surface.faces, results, surface_segments, p_keep_outside);
+		for (int p = 0; p < planes.size(); p++) {
+			plane_segments[p].append_array(surface_segments[p]);
+			surface_segments[p].resize(0);
+		}
+	}
+
+	// Each plane's cross section covers the whole mesh along it, of which only the part
+	// behind every other plane is actually on the surface of the volume
+	for (int p = 0; p < planes.size(); p++) {
+		if (plane_segments[p].size() == 0) {
+			continue;
+		}
+
+		Vector<Plane> other_planes = planes;
+		other_planes.remove_at(p);
+
+		FaceBuffer caps = Triangulator::triangulate_segments(plane_segments[p], planes[p].normal);
+		Intersector::SplitResult clipped;
+		clipped.set_format(caps.format);
+		Intersector::split_surface_by_convex(other_planes, caps, clipped, surface_segments, false);
+
+		if (r_cross_section_faces.size() == 0) {
+			r_cross_section_faces.set_format(caps.format);
+		}
+		r_cross_section_faces.append_faces(clipped.lower_faces);
+	}
+}
+
+Ref<SlicedMesh> SliceEngine::slice_by_volume(const Settings &settings, const Ref<Mesh> &mesh, const Vector<Plane> &planes, const Ref<Material> &cross_section_material) {
+	// A volume entirely off to one side of any of its planes can't reach the mesh
+	AABB aabb = mesh->get_aabb();
+	for (int i = 0; i < planes.size(); i++) {
+		if (Intersector::get_side_of_aabb(planes[i], aabb) == Intersector::SideOfPlane::OVER) {
+			return Ref<SlicedMesh>();
+		}
+	}
+
+	// Volumes only split loose faces, so the mesh is always parsed without its indices
+	Ref<ParsedMesh> parsed = settings.use_mesh_cache ? settings.mesh_cache->get_parsed_mesh(mesh, false) : ParsedMesh::parse(mesh, false);
+	ERR_FAIL_COND_V(parsed.is_null(), Ref<SlicedMesh>());
+
+	Vector<Intersector::SplitResult> split_results;
+	FaceBuffer cross_section_faces;
+	split_by_volume(*parsed.ptr(), planes, settings.halves != HALVES_LOWER, settings.halves != HALVES_UPPER, split_results, cross_section_faces);
+
+	// Same as with a single plane, nothing to do when the volume never touched a face
+	if (cross_section_faces.size() == 0) {
+		return Ref<SlicedMesh>();
+	}
+
+	for (int i = 0; i < split_results.size(); i++) {
+		if (split_results[i].unsplit_side != Intersector::SideOfPlane::ON && split_results[i].keeps(split_results[i].unsplit_side)) {
+			split_results.write[i].unsplit_arrays = mesh->surface_get_arrays(i);
+			split_results.write[i].unsplit_format = mesh->surface_get_format(i);
+		}
+	}
+
+	return create_sliced_mesh(settings, split_results, cross_section_faces, cross_section_material);
+}
+
+/**
+ * The shared state of a fracture. Every cell gets cut out of the same parsed mesh by its
+ * own task and only ever writes to its own slots, so the results come out the same no
+ * matter how many threads pick the cells up or in which order
+ */
+struct FractureCells {
+	Ref<ParsedMesh> parsed;
+	AABB aabb;
+	Vector<Vector3> seeds;
+
+	LocalVector<Vector<Intersector::SplitResult>> split_results;
+	LocalVector<FaceBuffer> cross_sections;
+	LocalVector<uint8_t> is_empty;
+
+	void split_cell(uint32_t p_index, void *p_userdata) {
+		is_empty[p_index] = true;
+
+		// The cell is everything closer to its own seed than to any other, bounded by the
+		// planes halfway between them. Planes that don't reach the mesh don't cut anything
+		// and one with the whole mesh on its far side leaves the cell empty
+		const Vector3 &seed = seeds[p_index];
+		Vector<Plane> planes;
+		for (int i = 0; i < seeds.size(); i++) {
+			Vector3 normal = seeds[i] - seed;
+			if (normal.is_zero_approx()) {
+				continue;
+			}
+
+			normal.normalize();
+			Plane plane(normal, normal.dot((seed + seeds[i]) * 0.5));
+			Intersector::SideOfPlane side = Intersector::get_side_of_aabb(plane, aabb);
+			if (side == Intersector::SideOfPlane::OVER) {
+				return;
+			}
+			if (side == Intersector::SideOfPlane::ON) {
+				planes.push_back(plane);
+			}
+		}
+
+		split_by_volume(*parsed.ptr(), planes, false, true, split_results[p_index], cross_sections[p_index]);
+		for (int i = 0; i < split_results[p_index].size(); i++) {
+			const Intersector::SplitResult &split = split_results[p_index][i];
+			if (split.lower_faces.size() > 0 || split.unsplit_side == Intersector::SideOfPlane::UNDER) {
+				is_empty[p_index] = false;
+			}
+		}
+	}
+};
+
+TypedArray<Mesh> SliceEngine::fracture(const Ref<Mesh> &mesh, const PackedVector3Array &seeds, const Ref<Material> &cross_section_material) const {
+	ERR_FAIL_COND_V(mesh.is_null(), TypedArray<Mesh>());
+	Settings settings = get_settings();
+
+	FractureCells cells;
+	cells.parsed = settings.use_mesh_cache ? settings.mesh_cache->get_parsed_mesh(mesh, false) : ParsedMesh::parse(mesh, false);
+	ERR_FAIL_COND_V(cells.parsed.is_null(), TypedArray<Mesh>());
+	cells.aabb = mesh->get_aabb();
+	cells.seeds = seeds;
+	cells.split_results.resize(seeds.size());
+	cells.cross_sections.resize(seeds.size());
+	cells.is_empty.resize(seeds.size());
+
+	WorkerThreadPool::GroupID group_id = WorkerThreadPool::get_singleton()->add_template_group_task(&cells, &FractureCells::split_cell, (void *)nullptr, seeds.size(), -1, true, "Slicer fracture");
+	WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_id);
+
+	// Building the meshes stays on the calling thread, with the arrays of any surface
+	// landing whole in a cell read back once no matter how many cells use them
+	Vector<Array> surface_arrays;
+	surface_arrays.resize(cells.parsed->surfaces.size());
+
+	TypedArray<Mesh> fragments;
+	fragments.resize(seeds.size());
+	for (int i = 0; i < seeds.size(); i++) {
+		if (cells.is_empty[i]) {
+			continue;
+		}
+
+		Vector<Intersector::SplitResult> &split_results = cells.split_results[i];
+		for (int j = 0; j < split_results.size(); j++) {
+			if (split_results[j].unsplit_side != Intersector::SideOfPlane::UNDER) {
+				continue;
+			}
+			if (surface_arrays[j].is_empty()) {
+				surface_arrays.write[j] = mesh->surface_get_arrays(j);
+			}
+			split_results.write[j].unsplit_arrays = surface_arrays[j];
+			split_results.write[j].unsplit_format = mesh->surface_get_format(j);
+		}
+
+		fragments[i] = SlicedMesh::create_mesh_half(split_results, cells.cross_sections[i], cross_section_material, false);
+	}
+	return fragments;
+}
+
+TypedArray<Mesh> SliceEngine::fracture_random(const Ref<Mesh> &mesh, int seed_count, int64_t random_seed, const Ref<Material> &cross_section_material) const {
+	ERR_FAIL_COND_V(mesh.is_null(), TypedArray<Mesh>());
+	ERR_FAIL_COND_V(seed_count <= 0, TypedArray<Mesh>());
+
+	AABB aabb = mesh->get_aabb();
+	Vector3 end = aabb.position + aabb.size;
+	RandomPCG rng(random_seed);
+	PackedVector3Array seeds;
+	seeds.resize(seed_count);
+	for (int i = 0; i < seed_count; i++) {
+		seeds.write[i] = Vector3(
+				rng.random(aabb.position.x, end.x),
+				rng.random(aabb.position.y, end.y),
+				rng.random(aabb.position.z, end.z));
+	}
+	return fracture(mesh, seeds, cross_section_material);
+}
+
+/**
+ * The plane through position along normal, both given in the space the mesh is placed in by
+ * mesh_transform, moved into the mesh's own space
+ */
+static Plane get_mesh_plane(const Transform3D &mesh_transform, const Vector3 &position, const Vector3 &normal) {
+	// We need to reorient the plane so that it will correctly slice the mesh whose vertices are based on the origin
+	Vector3 origin = position - mesh_transform.origin;
+	real_t dist = normal.dot(origin);
+	Vector3 adjusted_normal = mesh_transform.basis.xform_inv(normal);
+	return Plane(adjusted_normal, dist);
+}
+
+Ref<SlicedMesh> SliceEngine::slice_mesh(const Ref<Mesh> &mesh, const Vector3 &position, const Vector3 &normal, const Ref<Material> &cross_section_material) const {
+	Plane plane(normal, normal.dot(position));
+	return slice_by_plane(mesh, plane, cross_section_material);
+}
+
+Ref<SlicedMesh> SliceEngine::slice(const Ref<Mesh> &mesh, const Transform3D &mesh_transform, const Vector3 &position, const Vector3 &normal, const Ref<Material> &cross_section_material) const {
+	return slice_by_plane(mesh, get_mesh_plane(mesh_transform, position, normal), cross_section_material);
+}
+
+Ref<SliceTask> SliceEngine::slice_by_plane_async(const Ref<Mesh> &mesh, const Plane &plane, const Ref<Material> &cross_section_material) {
+	ERR_FAIL_COND_V(mesh.is_null(), Ref<SliceTask>());
+
+	Ref<SliceTask> task;
+	task.instantiate();
+	task->start(Ref<SliceEngine>(this), mesh, plane, cross_section_material);
+	return task;
+}
+
+Ref<SliceTask> SliceEngine::slice_mesh_async(const Ref<Mesh> &mesh, const Vector3 &position, const Vector3 &normal, const Ref<Material> &cross_section_material) {
+	return slice_by_plane_async(mesh, Plane(normal, normal.dot(position)), cross_section_material);
+}
+
+Ref<SliceTask> SliceEngine::slice_async(const Ref<Mesh> &mesh, const Transform3D &mesh_transform, const Vector3 &position, const Vector3 &normal, const Ref<Material> &cross_section_material) {
+	return slice_by_plane_async(mesh, get_mesh_plane(mesh_transform, position, normal), cross_section_material);
+}
+
+Ref<SliceJob> SliceEngine::create_slice_job(const Ref<Mesh> &mesh, const Plane &plane, const Ref<Material> &cross_section_material) {
+	ERR_FAIL_COND_V(mesh.is_null(), Ref<SliceJob>());
+
+	Ref<SliceJob> job;
+	job.instantiate();
+	job->start(Ref<SliceEngine>(this), mesh, plane, cross_section_material);
+	return job;
+}
+
+SliceEngine::Settings SliceEngine::get_settings() const {
+	MutexLock lock(mutex);
+	return settings;
+}
+
+void SliceEngine::set_halves(Halves p_halves) {
+	MutexLock lock(mutex);
+	settings.halves = p_halves;
+}
+
+SliceEngine::Halves SliceEngine::get_halves() const {
+	MutexLock lock(mutex);
+	return settings.halves;
+}
+
+void SliceEngine::set_preserve_indices(bool p_preserve_indices) {
+	MutexLock lock(mutex);
+	settings.preserve_indices = p_preserve_indices;
+}
+
+bool SliceEngine::get_preserve_indices() const {
+	MutexLock lock(mutex);
+	return settings.preserve_indices;
+}
+
+void SliceEngine::set_use_mesh_cache(bool p_use_mesh_cache) {
+	{
+		MutexLock lock(mutex);
+		settings.use_mesh_cache = p_use_mesh_cache;
+	}
+	if (!p_use_mesh_cache) {
+		mesh_cache->clear();
+	}
+}
+
+bool SliceEngine::get_use_mesh_cache() const {
+	MutexLock lock(mutex);
+	return settings.use_mesh_cache;
+}
+
+void SliceEngine::set_use_bvh(bool p_use_bvh) {
+	MutexLock lock(mutex);
+	settings.use_bvh = p_use_bvh;
+}
+
+bool SliceEngine::get_use_bvh() const {
+	MutexLock lock(mutex);
+	return settings.use_bvh;
+}
+
+void SliceEngine::set_keep_sliced_faces(bool p_keep_sliced_faces) {
+	MutexLock lock(mutex);
+	settings.keep_sliced_faces = p_keep_sliced_faces;
+}
+
+bool SliceEngine::get_keep_sliced_faces() const {
+	MutexLock lock(mutex);
+	return settings.keep_sliced_faces;
+}
+
+void SliceEngine::set_mesh_cache_memory_limit(int64_t p_memory_limit) {
+	ERR_FAIL_COND(p_memory_limit < 0);
+	mesh_cache->set_memory_limit(p_memory_limit);
+}
+
+int64_t SliceEngine::get_mesh_cache_memory_limit() const {
+	return mesh_cache->get_memory_limit();
+}
+
+void SliceEngine::clear_mesh_cache() {
+	mesh_cache->clear();
+}
+
+void SliceEngine::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("slice_by_plane", "mesh", "plane", "cross_section_material"), &SliceEngine::slice_by_plane);
+	ClassDB::bind_method(D_METHOD("slice_by_planes", "mesh", "planes", "cross_section_material"), &SliceEngine::slice_by_planes);
+	ClassDB::bind_method(D_METHOD("slice_by_grid", "mesh", "x_offsets", "y_offsets", "z_offsets", "cross_section_material"), &SliceEngine::slice_by_grid);
+	ClassDB::bind_method(D_METHOD("slice_by_convex", "mesh", "planes", "cross_section_material"), &SliceEngine::slice_by_convex);
+	ClassDB::bind_method(D_METHOD("slice_by_convex_shape", "mesh", "shape", "shape_transform", "cross_section_material"), &SliceEngine::slice_by_convex_shape);
+	ClassDB::bind_method(D_METHOD("fracture", "mesh", "seeds", "cross_section_material"), &SliceEngine::fracture);
+	ClassDB::bind_method(D_METHOD("fracture_random", "mesh", "seed_count", "random_seed", "cross_section_material"), &SliceEngine::fracture_random);
+	ClassDB::bind_method(D_METHOD("slice_mesh", "mesh", "position", "normal", "cross_section_material"), &SliceEngine::slice_mesh);
+	ClassDB::bind_method(D_METHOD("slice", "mesh", "mesh_transform", "position", "normal", "cross_section_material"), &SliceEngine::slice);
+	ClassDB::bind_method(D_METHOD("slice_by_plane_async", "mesh", "plane", "cross_section_material"), &SliceEngine::slice_by_plane_async);
+	ClassDB::bind_method(D_METHOD("slice_mesh_async", "mesh", "position", "normal", "cross_section_material"), &SliceEngine::slice_mesh_async);
+	ClassDB::bind_method(D_METHOD("slice_async", "mesh", "mesh_transform", "position", "normal", "cross_section_material"), &SliceEngine::slice_async);
+	ClassDB::bind_method(D_METHOD("create_slice_job", "mesh", "plane", "cross_section_material"), &SliceEngine::create_slice_job);
+
+	ClassDB::bind_method(D_METHOD("set_halves", "halves"), &SliceEngine::set_halves);
+	ClassDB::bind_method(D_METHOD("get_halves"), &SliceEngine::get_halves);
+	ClassDB::bind_method(D_METHOD("set_preserve_indices", "preserve_indices"), &SliceEngine::set_preserve_indices);
+	ClassDB::bind_method(D_METHOD("get_preserve_indices"), &SliceEngine::get_preserve_indices);
+
+	ClassDB::bind_method(D_METHOD("set_use_mesh_cache", "use_mesh_cache"), &SliceEngine::set_use_mesh_cache);
+	ClassDB::bind_method(D_METHOD("get_use_mesh_cache"), &SliceEngine::get_use_mesh_cache);
+	ClassDB::bind_method(D_METHOD("set_use_bvh", "use_bvh"), &SliceEngine::set_use_bvh);
+	ClassDB::bind_method(D_METHOD("get_use_bvh"), &SliceEngine::get_use_bvh);
+	ClassDB::bind_method(D_METHOD("set_keep_sliced_faces", "keep_sliced_faces"), &SliceEngine::set_keep_sliced_faces);
+	ClassDB::bind_method(D_METHOD("get_keep_sliced_faces"), &SliceEngine::get_keep_sliced_faces);
+	ClassDB::bind_method(D_METHOD("set_mesh_cache_memory_limit", "memory_limit"), &SliceEngine::set_mesh_cache_memory_limit);
+	ClassDB::bind_method(D_METHOD("get_mesh_cache_memory_limit"), &SliceEngine::get_mesh_cache_memory_limit);
+	ClassDB::bind_method(D_METHOD("clear_mesh_cache"), &SliceEngine::clear_mesh_cache);
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "halves", PROPERTY_HINT_ENUM, "Both,Upper,Lower"), "set_halves", "get_halves");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "preserve_indices"), "set_preserve_indices", "get_preserve_indices");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "use_mesh_cache"), "set_use_mesh_cache", "get_use_mesh_cache");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "use_bvh"), "set_use_bvh", "get_use_bvh");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "keep_sliced_faces"), "set_keep_sliced_faces", "get_keep_sliced_faces");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "mesh_cache_memory_limit", PROPERTY_HINT_RANGE, "0,1073741824,1,or_greater,suffix:B"), "set_mesh_cache_memory_limit", "get_mesh_cache_memory_limit");
+
+	BIND_ENUM_CONSTANT(HALVES_BOTH);
+	BIND_ENUM_CONSTANT(HALVES_UPPER);
+	BIND_ENUM_CONSTANT(HALVES_LOWER);
+}
+
+SliceEngine::SliceEngine() {
+	mesh_cache = memnew(MeshCache);
+	settings.mesh_cache = mesh_cache;
+}
+
+SliceEngine::~SliceEngine() {
+	memdelete(mesh_cache);
+}
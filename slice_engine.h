@@ -0,0 +1,185 @@
+/**************************************************************************/
+/*  slice_engine.h                                                        */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef SLICE_ENGINE_H
+#define SLICE_ENGINE_H
+
+#include "core/object/ref_counted.h"
+#include "core/os/mutex.h"
+#include "core/variant/typed_array.h"
+#include "scene/resources/3d/convex_polygon_shape_3d.h"
+#include "scene/resources/mesh.h"
+#include "sliced_mesh.h"
+#include "utils/mesh_cache.h"
+
+struct Dicer;
+class SliceJob;
+class SliceTask;
+
+/**
+ * Everything Slicer can do, without needing a node to do it from. Every slice works out of
+ * its own scratch state and a copy of the engine's settings taken when it starts, the only
+ * thing shared between slices being the mesh cache, which is guarded by its own mutex. A
+ * single engine can so be sliced with from any number of threads at once, and its
+ * settings changed meanwhile, without any locking on the caller's part
+ */
+class SliceEngine : public RefCounted {
+	GDCLASS(SliceEngine, RefCounted);
+
+	friend class SliceJob;
+
+public:
+	enum Halves {
+		HALVES_BOTH,
+		HALVES_UPPER,
+		HALVES_LOWER,
+	};
+
+	/**
+	 * The engine's settings as a single slice sees them, copied out when it starts so that
+	 * a slice on one thread doesn't see them change under it
+	 */
+	struct Settings {
+		Halves halves = HALVES_BOTH;
+		bool preserve_indices = false;
+		bool use_mesh_cache = false;
+		bool use_bvh = false;
+		bool keep_sliced_faces = false;
+		// Owned by the engine, which outlives every slice holding on to it
+		MeshCache *mesh_cache = nullptr;
+	};
+
+private:
+	// Guards the settings, never held while slicing
+	Mutex mutex;
+	Settings settings;
+	MeshCache *mesh_cache = nullptr;
+
+	static TypedArray<Mesh> dice_mesh(const Settings &settings, const Ref<Mesh> &mesh, Dicer &dicer, const Ref<Material> &cross_section_material);
+	static Ref<SlicedMesh> slice_by_volume(const Settings &settings, const Ref<Mesh> &mesh, const Vector<Plane> &planes, const Ref<Material> &cross_section_material);
+	/**
+	 * Sets up the result of splitting one of the parsed surfaces by the plane. Surfaces
+	 * entirely on one side of it are handed to that half as they are, returns whether
+	 * the surface's faces still need splitting
+	 */
+	static bool prepare_split(const Settings &settings, const Ref<Mesh> &mesh, const ParsedMesh::Surface &surface, int surface_idx, const Plane &plane, Intersector::SplitResult &results);
+	static Ref<SlicedMesh> create_sliced_mesh(const Settings &settings, const Vector<Intersector::SplitResult> &split_results, const FaceBuffer &cross_section_faces, const Ref<Material> &cross_section_material);
+
+protected:
+	static void _bind_methods();
+
+public:
+	/**
+	 * See Slicer for what each of the settings does
+	 */
+	void set_halves(Halves p_halves);
+	Halves get_halves() const;
+
+	void set_preserve_indices(bool p_preserve_indices);
+	bool get_preserve_indices() const;
+
+	void set_use_mesh_cache(bool p_use_mesh_cache);
+	bool get_use_mesh_cache() const;
+
+	void set_use_bvh(bool p_use_bvh);
+	bool get_use_bvh() const;
+
+	void set_keep_sliced_faces(bool p_keep_sliced_faces);
+	bool get_keep_sliced_faces() const;
+
+	void set_mesh_cache_memory_limit(int64_t p_memory_limit);
+	int64_t get_mesh_cache_memory_limit() const;
+
+	void clear_mesh_cache();
+
+	MeshCache *get_mesh_cache() const {
+		return mesh_cache;
+	}
+
+	Settings get_settings() const;
+
+	/**
+	 * Everything a slice by a plane reads out of the mesh: its parsed surfaces, plus the
+	 * split results already set up for each of them, with the raw arrays of any surface
+	 * that goes to one half untouched
+	 */
+	struct PlaneSliceInput {
+		Ref<ParsedMesh> parsed;
+		Vector<Intersector::SplitResult> split_results;
+	};
+
+	/**
+	 * Does the work of slice_by_plane with the passed in settings instead of the engine's
+	 */
+	static Ref<SlicedMesh> slice_by_plane_with(const Settings &settings, const Ref<Mesh> &mesh, const Plane &plane, const Ref<Material> &cross_section_material);
+
+	/**
+	 * The first half of slice_by_plane_with, the only part of it that touches the mesh.
+	 * Returns false when the plane misses the mesh and there's nothing to slice
+	 */
+	static bool read_for_plane(const Settings &settings, const Ref<Mesh> &mesh, const Plane &plane, PlaneSliceInput &r_input);
+
+	/**
+	 * The rest of slice_by_plane_with, which works off the input alone. Splits into the
+	 * input's results, so it can only be used once
+	 */
+	static Ref<SlicedMesh> slice_input_by_plane(const Settings &settings, PlaneSliceInput &input, const Plane &plane, const Ref<Material> &cross_section_material);
+
+	Ref<SlicedMesh> slice_by_plane(const Ref<Mesh> &mesh, const Plane &plane, const Ref<Material> &cross_section_material) const;
+	TypedArray<Mesh> slice_by_planes(const Ref<Mesh> &mesh, const TypedArray<Plane> &planes, const Ref<Material> &cross_section_material) const;
+	TypedArray<Mesh> slice_by_grid(const Ref<Mesh> &mesh, const PackedFloat32Array &x_offsets, const PackedFloat32Array &y_offsets, const PackedFloat32Array &z_offsets, const Ref<Material> &cross_section_material) const;
+	Ref<SlicedMesh> slice_by_convex(const Ref<Mesh> &mesh, const TypedArray<Plane> &planes, const Ref<Material> &cross_section_material) const;
+	Ref<SlicedMesh> slice_by_convex_shape(const Ref<Mesh> &mesh, const Ref<ConvexPolygonShape3D> &shape, const Transform3D &shape_transform, const Ref<Material> &cross_section_material) const;
+	TypedArray<Mesh> fracture(const Ref<Mesh> &mesh, const PackedVector3Array &seeds, const Ref<Material> &cross_section_material) const;
+	TypedArray<Mesh> fracture_random(const Ref<Mesh> &mesh, int seed_count, int64_t random_seed, const Ref<Material> &cross_section_material) const;
+	Ref<SlicedMesh> slice_mesh(const Ref<Mesh> &mesh, const Vector3 &position, const Vector3 &normal, const Ref<Material> &cross_section_material) const;
+	Ref<SlicedMesh> slice(const Ref<Mesh> &mesh, const Transform3D &mesh_transform, const Vector3 &position, const Vector3 &normal, const Ref<Material> &cross_section_material) const;
+
+	/**
+	 * Same as slice_by_plane on the WorkerThreadPool, see Slicer. The task keeps the
+	 * engine alive until it's done
+	 */
+	Ref<SliceTask> slice_by_plane_async(const Ref<Mesh> &mesh, const Plane &plane, const Ref<Material> &cross_section_material);
+	Ref<SliceTask> slice_mesh_async(const Ref<Mesh> &mesh, const Vector3 &position, const Vector3 &normal, const Ref<Material> &cross_section_material);
+	Ref<SliceTask> slice_async(const Ref<Mesh> &mesh, const Transform3D &mesh_transform, const Vector3 &position, const Vector3 &normal, const Ref<Material> &cross_section_material);
+
+	/**
+	 * Same as slice_by_plane, but spread out over as many calls to the job's step as it
+	 * takes, see SliceJob. The job keeps the engine alive until it's done
+	 */
+	Ref<SliceJob> create_slice_job(const Ref<Mesh> &mesh, const Plane &plane, const Ref<Material> &cross_section_material);
+
+	SliceEngine();
+	~SliceEngine();
+};
+
+VARIANT_ENUM_CAST(SliceEngine::Halves);
+
+#endif // SLICE_ENGINE_H
@@ -0,0 +1,266 @@
+/**************************************************************************/
+/*  slice_job.cpp                                                         */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "slice_job.h"
+
+#include "core/os/os.h"
+#include "utils/triangulator.h"
+
+void SliceJob::start(const Ref<SliceEngine> &p_engine, const Ref<Mesh> &p_mesh, const Plane &p_plane, const Ref<Material> &p_cross_section_material) {
+	engine = p_engine;
+	settings = p_engine->get_settings();
+	mesh = p_mesh;
+	plane = p_plane;
+	cross_section_material = p_cross_section_material;
+}
+
+void SliceJob::_parse() {
+	if (parsed.is_null()) {
+		// A plane that misses the mesh's bounds can't produce any intersection points, so
+		// bail before paying for reading in a single face
+		if (Intersector::get_side_of_aabb(plane, mesh->get_aabb()) != Intersector::SideOfPlane::ON) {
+			_finish(PHASE_DONE);
+			return;
+		}
+
+		if (settings.use_mesh_cache) {
+			parsed = settings.mesh_cache->get_parsed_mesh(mesh, settings.preserve_indices, settings.use_bvh);
+			if (parsed.is_null()) {
+				_finish(PHASE_DONE);
+				ERR_FAIL_MSG("Couldn't parse the mesh being sliced.");
+			}
+			surface = parsed->surfaces.size();
+		} else {
+			parsed.instantiate();
+			parsed->preserve_indices = settings.preserve_indices;
+			parsed->surfaces.resize(mesh->get_surface_count());
+		}
+	}
+
+	if (surface < (int)parsed->surfaces.size()) {
+		ParsedMesh::parse_surface_for_plane(mesh, surface, settings.preserve_indices, plane, parsed->surfaces[surface]);
+		surface++;
+	}
+
+	if (surface < (int)parsed->surfaces.size()) {
+		return;
+	}
+
+	// Counting the faces to split up front is what lets the split report its progress
+	phase = PHASE_SPLIT;
+	surface = 0;
+	split_results.resize(parsed->surfaces.size());
+	for (uint32_t i = 0; i < parsed->surfaces.size(); i++) {
+		const ParsedMesh::Surface &parsed_surface = parsed->surfaces[i];
+		if (Intersector::get_side_of_aabb(plane, parsed_surface.aabb) == Intersector::SideOfPlane::ON) {
+			split_face_count += parsed_surface.faces.size();
+		}
+	}
+}
+
+void SliceJob::_split() {
+	if (surface == (int)parsed->surfaces.size()) {
+		// Same as slice_by_plane, no cut segments means nothing was sliced
+		if (cut_segments.is_empty()) {
+			_finish(PHASE_DONE);
+			return;
+		}
+
+		phase = PHASE_TRIANGULATE;
+		return;
+	}
+
+	// Split straight into the stored result, copying a SplitResult means copying whole
+	// face buffers
+	Intersector::SplitResult &results = split_results.write[surface];
+	if (splitter == nullptr) {
+		const ParsedMesh::Surface &parsed_surface = parsed->surfaces[surface];
+		if (!SliceEngine::prepare_split(settings, mesh, parsed_surface, surface, plane, results)) {
+			surface++;
+			return;
+		}
+		// Same as slice_by_plane, the cut segments are handed from surface to surface
+		results.cut_segments = cut_segments;
+		cut_segments = Vector<Vector3>();
+		splitter = memnew(Intersector::SurfaceSplitter(plane, parsed_surface.faces, results));
+	}
+
+	int split_before = splitter->get_split_face_count();
+	splitter->split(batch_size);
+	split_faces_done += splitter->get_split_face_count() - split_before;
+	if (!splitter->is_done()) {
+		return;
+	}
+
+	memdelete(splitter);
+	splitter = nullptr;
+	cut_segments = results.cut_segments;
+	results.cut_segments = Vector<Vector3>();
+	surface++;
+}
+
+void SliceJob::_triangulate() {
+	cross_section_faces = Triangulator::triangulate_segments(cut_segments, plane.normal, settings.preserve_indices);
+	cut_segments = Vector<Vector3>();
+	phase = PHASE_BUILD;
+}
+
+void SliceJob::_build() {
+	if (sliced_mesh.is_null()) {
+		// The halves are left to be built one at a time below, unless they're going into
+		// the mesh cache, in which case this builds both
+		sliced_mesh = SliceEngine::create_sliced_mesh(settings, split_results, cross_section_faces, cross_section_material);
+		half_count = sliced_mesh->has_upper_mesh() + sliced_mesh->has_lower_mesh();
+		halves_built = sliced_mesh->is_upper_mesh_built() + sliced_mesh->is_lower_mesh_built();
+		split_results = Vector<Intersector::SplitResult>();
+		cross_section_faces = FaceBuffer();
+		return;
+	}
+
+	if (sliced_mesh->has_upper_mesh() && !sliced_mesh->is_upper_mesh_built()) {
+		sliced_mesh->get_upper_mesh();
+		halves_built++;
+		return;
+	}
+
+	if (sliced_mesh->has_lower_mesh() && !sliced_mesh->is_lower_mesh_built()) {
+		sliced_mesh->get_lower_mesh();
+		halves_built++;
+		return;
+	}
+
+	_finish(PHASE_DONE);
+}
+
+void SliceJob::_finish(Phase p_phase) {
+	phase = p_phase;
+	if (phase == PHASE_CANCELED) {
+		sliced_mesh.unref();
+	}
+
+	if (splitter) {
+		memdelete(splitter);
+		splitter = nullptr;
+	}
+	parsed.unref();
+	split_results = Vector<Intersector::SplitResult>();
+	cut_segments = Vector<Vector3>();
+	cross_section_faces = FaceBuffer();
+	mesh.unref();
+	cross_section_material.unref();
+	engine.unref();
+}
+
+void SliceJob::set_batch_size(int p_batch_size) {
+	ERR_FAIL_COND(p_batch_size < 1);
+	batch_size = p_batch_size;
+}
+
+int SliceJob::get_batch_size() const {
+	return batch_size;
+}
+
+bool SliceJob::step(int64_t p_budget_usec) {
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	do {
+		switch (phase) {
+			case PHASE_PARSE:
+				_parse();
+				break;
+			case PHASE_SPLIT:
+				_split();
+				break;
+			case PHASE_TRIANGULATE:
+				_triangulate();
+				break;
+			case PHASE_BUILD:
+				_build();
+				break;
+			case PHASE_DONE:
+			case PHASE_CANCELED:
+				return false;
+		}
+	} while (!is_done() && (int64_t)(OS::get_singleton()->get_ticks_usec() - begin) < p_budget_usec);
+
+	return !is_done();
+}
+
+void SliceJob::cancel() {
+	if (!is_done()) {
+		_finish(PHASE_CANCELED);
+	}
+}
+
+float SliceJob::get_progress() const {
+	float phase_progress = 0;
+	switch (phase) {
+		case PHASE_PARSE:
+			phase_progress = parsed.is_valid() && !parsed->surfaces.is_empty() ? (float)surface / parsed->surfaces.size() : 0;
+			break;
+		case PHASE_SPLIT:
+			phase_progress = split_face_count > 0 ? (float)split_faces_done / split_face_count : 0;
+			break;
+		case PHASE_TRIANGULATE:
+			break;
+		case PHASE_BUILD:
+			phase_progress = half_count > 0 ? (float)halves_built / half_count : 0;
+			break;
+		case PHASE_DONE:
+		case PHASE_CANCELED:
+			return 1;
+	}
+	return (phase + phase_progress) / 4;
+}
+
+void SliceJob::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_batch_size", "batch_size"), &SliceJob::set_batch_size);
+	ClassDB::bind_method(D_METHOD("get_batch_size"), &SliceJob::get_batch_size);
+	ClassDB::bind_method(D_METHOD("step", "budget_usec"), &SliceJob::step, DEFVAL(0));
+	ClassDB::bind_method(D_METHOD("cancel"), &SliceJob::cancel);
+	ClassDB::bind_method(D_METHOD("get_phase"), &SliceJob::get_phase);
+	ClassDB::bind_method(D_METHOD("is_done"), &SliceJob::is_done);
+	ClassDB::bind_method(D_METHOD("get_progress"), &SliceJob::get_progress);
+	ClassDB::bind_method(D_METHOD("get_sliced_mesh"), &SliceJob::get_sliced_mesh);
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "batch_size", PROPERTY_HINT_RANGE, "1,65536,1,or_greater"), "set_batch_size", "get_batch_size");
+
+	BIND_ENUM_CONSTANT(PHASE_PARSE);
+	BIND_ENUM_CONSTANT(PHASE_SPLIT);
+	BIND_ENUM_CONSTANT(PHASE_TRIANGULATE);
+	BIND_ENUM_CONSTANT(PHASE_BUILD);
+	BIND_ENUM_CONSTANT(PHASE_DONE);
+	BIND_ENUM_CONSTANT(PHASE_CANCELED);
+}
+
+SliceJob::~SliceJob() {
+	if (splitter) {
+		memdelete(splitter);
+	}
+}
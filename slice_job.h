@@ -0,0 +1,167 @@
+/**************************************************************************/
+/*  slice_job.h                                                           */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef SLICE_JOB_H
+#define SLICE_JOB_H
+
+#include "core/object/ref_counted.h"
+#include "slice_engine.h"
+#include "sliced_mesh.h"
+#include "utils/intersector.h"
+#include "utils/parsed_mesh.h"
+
+/**
+ * A slice done a little at a time, as started by SliceEngine's (or Slicer's)
+ * create_slice_job. Each call to step picks up where the last one left off and goes on
+ * until it runs out of time, so a big slice can be spread out over several frames from
+ * _process without ever stalling one of them. Everything happens on the thread calling
+ * step, and the result is exactly what slice_by_plane would have come up with.
+ *
+ * The slice goes through the same stages slice_by_plane does, each a phase of the job:
+ * - PHASE_PARSE reads the mesh's surfaces in, one surface at a time. Going through the
+ *   mesh cache it's all done at once, and is free when the mesh is already cached.
+ * - PHASE_SPLIT splits the surfaces crossing the plane, batch_size faces at a time.
+ * - PHASE_TRIANGULATE caps the cross section, all in one go.
+ * - PHASE_BUILD builds the halves wanted, one half at a time, or both at once when
+ *   they're being kept in the mesh cache.
+ *
+ * The mesh shouldn't be changed until the job is done with it.
+ */
+class SliceJob : public RefCounted {
+	GDCLASS(SliceJob, RefCounted);
+
+	friend class SliceEngine;
+
+public:
+	enum Phase {
+		PHASE_PARSE,
+		PHASE_SPLIT,
+		PHASE_TRIANGULATE,
+		PHASE_BUILD,
+		PHASE_DONE,
+		PHASE_CANCELED,
+	};
+
+private:
+	// What the slice works on, copied when it's started. Holding on to the engine keeps
+	// the mesh cache in the settings alive
+	Ref<SliceEngine> engine;
+	SliceEngine::Settings settings;
+	Ref<Mesh> mesh;
+	Plane plane;
+	Ref<Material> cross_section_material;
+
+	int batch_size = 4096;
+	Phase phase = PHASE_PARSE;
+
+	// The surface being parsed or split
+	int surface = 0;
+	Ref<ParsedMesh> parsed;
+
+	Vector<Intersector::SplitResult> split_results;
+	Vector<Vector3> cut_segments;
+	Intersector::SurfaceSplitter *splitter = nullptr;
+	int64_t split_face_count = 0;
+	int64_t split_faces_done = 0;
+
+	FaceBuffer cross_section_faces;
+	Ref<SlicedMesh> sliced_mesh;
+	int half_count = 0;
+	int halves_built = 0;
+
+	void start(const Ref<SliceEngine> &p_engine, const Ref<Mesh> &p_mesh, const Plane &p_plane, const Ref<Material> &p_cross_section_material);
+
+	/**
+	 * Each of these does a single bounded piece of its phase's work, moving on to the
+	 * next phase once there's none left
+	 */
+	void _parse();
+	void _split();
+	void _triangulate();
+	void _build();
+
+	/**
+	 * Ends the job with whatever sliced_mesh holds, letting go of everything the slice
+	 * was built from
+	 */
+	void _finish(Phase p_phase);
+
+protected:
+	static void _bind_methods();
+
+public:
+	/**
+	 * How many faces get split at a time. step always splits at least one batch, so this
+	 * is also the most a step can do when its budget is zero
+	 */
+	void set_batch_size(int p_batch_size);
+	int get_batch_size() const;
+
+	/**
+	 * Carries on with the slice for up to p_budget_usec microseconds, always doing at
+	 * least one piece of work. A piece started before the budget runs out is finished
+	 * regardless, so a step can run over by as much as one piece takes. Returns whether
+	 * there's anything left to do
+	 */
+	bool step(int64_t p_budget_usec = 0);
+
+	/**
+	 * Stops the slice where it is, letting go of everything built up so far
+	 */
+	void cancel();
+
+	Phase get_phase() const {
+		return phase;
+	}
+
+	bool is_done() const {
+		return phase == PHASE_DONE || phase == PHASE_CANCELED;
+	}
+
+	/**
+	 * How far along the slice is, from 0 to 1. Each of the four phases counts for a
+	 * quarter of it
+	 */
+	float get_progress() const;
+
+	/**
+	 * The result of the slice, null until it's done and when the plane missed the mesh
+	 * or the slice was canceled
+	 */
+	Ref<SlicedMesh> get_sliced_mesh() const {
+		return phase == PHASE_DONE ? sliced_mesh : Ref<SlicedMesh>();
+	}
+
+	~SliceJob();
+};
+
+VARIANT_ENUM_CAST(SliceJob::Phase);
+
+#endif // SLICE_JOB_H
@@ -0,0 +1,95 @@
+/**************************************************************************/
+/*  slice_task.cpp                                                        */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "slice_task.h"
+
+void SliceTask::start(const Ref<SliceEngine> &p_engine, const Ref<Mesh> &p_mesh, const Plane &p_plane, const Ref<Material> &p_cross_section_material) {
+	engine = p_engine;
+	settings = p_engine->get_settings();
+	plane = p_plane;
+	if (!SliceEngine::read_for_plane(settings, p_mesh, plane, input)) {
+		input = SliceEngine::PlaneSliceInput();
+	}
+	cross_section_material = p_cross_section_material;
+	self = Ref<SliceTask>(this);
+	// The slice runs low priority, so any groups it splits its own work into are posted high
+	// priority. Waiting on low priority groups could take up every low priority thread with
+	// slices waiting on work that has nowhere left to run
+	task_id = WorkerThreadPool::get_singleton()->add_template_task(this, &SliceTask::_run, (void *)nullptr, false, "Slicer slice");
+}
+
+void SliceTask::_run(void *p_userdata) {
+	if (input.parsed.is_valid()) {
+		sliced_mesh = SliceEngine::slice_input_by_plane(settings, input, plane, cross_section_material);
+		input = SliceEngine::PlaneSliceInput();
+	}
+	if (sliced_mesh.is_valid()) {
+		// Building the halves here keeps all of the work off the main thread
+		sliced_mesh->build_pending();
+	}
+
+	completed.set();
+	callable_mp(this, &SliceTask::_emit_completed).call_deferred();
+}
+
+void SliceTask::_emit_completed() {
+	// The task is done by now, waiting on it just hands it back to the pool
+	wait();
+
+	// Letting go of self last, as that may well free the task
+	Ref<SliceTask> keep_alive = self;
+	self.unref();
+	emit_signal(SNAME("completed"), sliced_mesh);
+}
+
+Ref<SlicedMesh> SliceTask::get_sliced_mesh() const {
+	return completed.is_set() ? sliced_mesh : Ref<SlicedMesh>();
+}
+
+Ref<SlicedMesh> SliceTask::wait() {
+	MutexLock lock(mutex);
+	if (task_id != WorkerThreadPool::INVALID_TASK_ID) {
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(task_id);
+		task_id = WorkerThreadPool::INVALID_TASK_ID;
+	}
+	return sliced_mesh;
+}
+
+void SliceTask::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("is_completed"), &SliceTask::is_completed);
+	ClassDB::bind_method(D_METHOD("get_sliced_mesh"), &SliceTask::get_sliced_mesh);
+	ClassDB::bind_method(D_METHOD("wait"), &SliceTask::wait);
+
+	ADD_SIGNAL(MethodInfo("completed", PropertyInfo(Variant::OBJECT, "sliced_mesh", PROPERTY_HINT_RESOURCE_TYPE, "SlicedMesh")));
+}
+
+SliceTask::~SliceTask() {
+	wait();
+}
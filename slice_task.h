@@ -0,0 +1,110 @@
+/**************************************************************************/
+/*  slice_task.h                                                          */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef SLICE_TASK_H
+#define SLICE_TASK_H
+
+#include "core/object/ref_counted.h"
+#include "core/object/worker_thread_pool.h"
+#include "core/os/mutex.h"
+#include "slice_engine.h"
+#include "sliced_mesh.h"
+
+/**
+ * A slice running on the WorkerThreadPool, as started by SliceEngine's (or Slicer's)
+ * slice_by_plane_async.
+ *
+ * Which thread touches what:
+ * - The thread starting the slice copies the engine's settings and reads everything the
+ *   slice needs out of the mesh: its bounds, and its surfaces' arrays and materials
+ *   (through the RenderingServer, unless the mesh is already in the mesh cache). Meshes
+ *   aren't safe to read from other threads, a PrimitiveMesh for one rebuilds its arrays
+ *   the first time they're asked for, so the mesh is never handed to the worker.
+ * - The worker splits and caps that snapshot and builds both halves, which creates their
+ *   meshes and surfaces on the RenderingServer. It never touches the scene tree.
+ * - `completed` is emitted from the message queue, so on the main thread, once the worker
+ *   is done.
+ */
+class SliceTask : public RefCounted {
+	GDCLASS(SliceTask, RefCounted);
+
+	friend class SliceEngine;
+
+	// What the slice works on, copied when it's started. Holding on to the engine keeps
+	// the mesh cache in the settings alive. The input's left empty when the plane
+	// misses the mesh
+	Ref<SliceEngine> engine;
+	SliceEngine::Settings settings;
+	SliceEngine::PlaneSliceInput input;
+	Plane plane;
+	Ref<Material> cross_section_material;
+
+	// Only written by the worker, and only read once completed is set
+	Ref<SlicedMesh> sliced_mesh;
+	SafeFlag completed;
+
+	// Guards waiting on the task, which the pool only allows once
+	Mutex mutex;
+	WorkerThreadPool::TaskID task_id = WorkerThreadPool::INVALID_TASK_ID;
+
+	// Keeps the task around until completed has been emitted, even once nothing else
+	// holds on to it
+	Ref<SliceTask> self;
+
+	void start(const Ref<SliceEngine> &p_engine, const Ref<Mesh> &p_mesh, const Plane &p_plane, const Ref<Material> &p_cross_section_material);
+	void _run(void *p_userdata);
+	void _emit_completed();
+
+protected:
+	static void _bind_methods();
+
+public:
+	/**
+	 * Whether the slice has finished, without waiting for it
+	 */
+	bool is_completed() const {
+		return completed.is_set();
+	}
+
+	/**
+	 * The result of the slice, null until it has completed and when the plane missed
+	 * the mesh
+	 */
+	Ref<SlicedMesh> get_sliced_mesh() const;
+
+	/**
+	 * Blocks until the slice has finished and returns its result
+	 */
+	Ref<SlicedMesh> wait();
+
+	~SliceTask();
+};
+
+#endif // SLICE_TASK_H
@@ -30,6 +30,7 @@
 
 #include "sliced_mesh.h"
 #include "core/error/error_macros.h"
+#include "core/object/worker_thread_pool.h"
 #include "scene/resources/material.h"
 #include "utils/surface_filler.h"
 
@@ -37,79 +38,315 @@
  * Creates a new surface composed of the uncut faces that were above the plane and the new faces generated
  * from the cut faces that fell on the plane
  */
-void create_surface(const Vector<SlicerFace> &faces, const Ref<Material> material, Ref<ArrayMesh> mesh) {
+void create_surface(const FaceBuffer &faces, const Ref<Material> material, Ref<ArrayMesh> mesh) {
 	ERR_FAIL_COND(mesh.is_null());
 	if (faces.size() == 0) {
 		return;
 	}
 
 	SurfaceFiller filler(faces);
+	filler.fill_vertices();
 
-	for (int i = 0; i < faces.size() * 3; i++) {
-		filler.fill(i, i);
+	if (faces.is_indexed()) {
+		filler.fill_indices();
 	}
 
 	filler.add_to_mesh(mesh, material);
 }
 
+/**
+ * Adds a surface that never reached the plane to the mesh exactly as it was in the source
+ * mesh, which skips going through faces altogether
+ */
+void create_unsplit_surface(const Intersector::SplitResult &split, Ref<ArrayMesh> mesh) {
+	ERR_FAIL_COND(mesh.is_null());
+	// Carry over whatever flags describe how the arrays are laid out (custom channel
+	// formats, 8 bone weights and compression) but not the bits add_surface_from_arrays
+	// works out from the arrays themselves
+	uint64_t custom_formats = ((1ULL << (Mesh::ARRAY_FORMAT_CUSTOM_BITS * 4)) - 1) << Mesh::ARRAY_FORMAT_CUSTOM_BASE;
+	uint64_t flags = split.unsplit_format & (custom_formats | Mesh::ARRAY_FLAG_USE_8_BONE_WEIGHTS | Mesh::ARRAY_FLAG_COMPRESS_ATTRIBUTES);
+
+	mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, split.unsplit_arrays, Array(), Dictionary(), flags);
+	mesh->surface_set_material(mesh->get_surface_count() - 1, split.material);
+}
+
 /**
  * Create a new surface of the cross section faces. This should be called twice: once for the upper_mesh
  * and again for the lower_mesh
  */
-void create_cross_section_surface(const Vector<SlicerFace> &faces, const Ref<Material> material, Ref<ArrayMesh> mesh, bool is_upper) {
+void create_cross_section_surface(const FaceBuffer &faces, const Ref<Material> material, Ref<ArrayMesh> mesh, bool is_upper) {
 	ERR_FAIL_COND(mesh.is_null());
 	if (faces.size() == 0) {
 		return;
 	}
 
+	// The cross section faces have the same normal as the plane that cut
+	// them. That means that, for the upper half of the cut, we want to add
+	// the vertices counterclockwise so that the normal is facing outwards
 	SurfaceFiller filler(faces);
+	filler.fill_vertices(is_upper);
 
-	for (int i = 0; i < faces.size(); i++) {
-		// The cross section faces have the same normal as the plane that cut
-		// them. That means that, for the upper half of the cut, we want to add
-		// the vertices counterclockwise so that the normal is facing outwards
-		if (is_upper) {
-			filler.fill(i * 3, i * 3);
-			filler.fill(i * 3 + 1, i * 3 + 2);
-			filler.fill(i * 3 + 2, i * 3 + 1);
-		} else {
-			filler.fill(i * 3, i * 3);
-			filler.fill(i * 3 + 1, i * 3 + 1);
-			filler.fill(i * 3 + 2, i * 3 + 2);
-		}
+	if (faces.is_indexed()) {
+		filler.fill_indices(is_upper);
 	}
 
 	filler.add_to_mesh(mesh, material);
 }
 
 /**
- * Creates either an upper or lower half of the sliced mesh
+ * The material to give the cross section of a mesh, falling back on the material of the
+ * mesh's first surface when none was passed in. p_first_surface_material is null for a
+ * mesh without any surfaces
  */
-Ref<Mesh> create_mesh_half(
+Ref<Material> get_cross_section_material(const Ref<Material> *p_first_surface_material, Ref<Material> cross_section_material) {
+	if (cross_section_material.is_null() && p_first_surface_material) {
+		// I believe Ezy-Slice has a way of specifying the existing material to use,
+		// we may want to add that as a TODO
+		cross_section_material = *p_first_surface_material;
+	} else if (cross_section_material.is_null()) {
+		cross_section_material = Ref<Material>(memnew(StandardMaterial3D));
+	}
+	return cross_section_material;
+}
+
+/**
+ * Mirrors a surface that was just added to a mesh in its parsed form, so that the two line
+ * up surface for surface
+ */
+static void add_parsed_surface(ParsedMesh *r_parsed, const FaceBuffer &faces, const Ref<Material> &material) {
+	if (!r_parsed || faces.size() == 0) {
+		return;
+	}
+
+	ParsedMesh::Surface surface;
+	surface.material = material;
+	surface.faces = faces;
+	surface.aabb = faces.get_aabb();
+	r_parsed->surfaces.push_back(surface);
+}
+
+/**
+ * Builds one or more halves of a slice at once. Every surface that needs encoding gets
+ * encoded on its own WorkerThreadPool task, across all of the halves, while adding the
+ * encoded surfaces to their meshes stays on the calling thread and goes in order. The
+ * meshes come out the same no matter how the surfaces got spread across threads
+ */
+struct HalfBuilder {
+	// Below this many vertices, across every surface being built, handing the surfaces
+	// out to other threads costs more than it saves
+	static constexpr uint32_t PARALLEL_MIN_VERTICES = 16384;
+
+	struct Surface {
+		// Set for surfaces passed through as they were in the source mesh, which don't
+		// need encoding at all
+		const Intersector::SplitResult *unsplit = nullptr;
+		const FaceBuffer *faces = nullptr;
+		bool flip_winding = false;
+		Ref<Material> material;
+		RS::SurfaceData data;
+	};
+
+	struct Half {
+		uint32_t first_surface = 0;
+		uint32_t surface_count = 0;
+		bool is_upper = false;
+		ParsedMesh *parsed = nullptr;
+		Ref<ArrayMesh> mesh;
+	};
+
+	LocalVector<Surface> surfaces;
+	LocalVector<Half> halves;
+
+	void add_half(const Vector<Intersector::SplitResult> &surface_splits, const FaceBuffer &cross_section_faces, Ref<Material> cross_section_material, bool is_upper, ParsedMesh *r_parsed) {
+		Half half;
+		half.first_surface = surfaces.size();
+		half.is_upper = is_upper;
+		half.parsed = r_parsed;
+
+		for (int i = 0; i < surface_splits.size(); i++) {
+			const Intersector::SplitResult &split = surface_splits[i];
+			Surface surface;
+			surface.material = split.material;
+			if (split.unsplit_side != Intersector::SideOfPlane::ON) {
+				if ((split.unsplit_side == Intersector::SideOfPlane::OVER) == is_upper) {
+					surface.unsplit = &split;
+					surfaces.push_back(surface);
+				}
+				continue;
+			}
+
+			surface.faces = is_upper ? &split.upper_faces : &split.lower_faces;
+			if (surface.faces->size() > 0) {
+				surfaces.push_back(surface);
+			}
+		}
+
+		if (cross_section_faces.size() > 0) {
+			// The half's first surface is the first surface of the mesh it gets built into
+			Surface surface;
+			surface.faces = &cross_section_faces;
+			surface.material = get_cross_section_material(surfaces.size() > half.first_surface ? &surfaces[half.first_surface].material : nullptr, cross_section_material);
+
+			// The cross section faces have the same normal as the plane that cut them, so
+			// the upper half needs them wound the other way round to face outwards
+			surface.flip_winding = is_upper;
+			surfaces.push_back(surface);
+		}
+
+		half.surface_count = surfaces.size() - half.first_surface;
+		halves.push_back(half);
+	}
+
+	void encode_surface(uint32_t p_index, void *p_userdata) {
+		Surface &surface = surfaces[p_index];
+		if (surface.unsplit) {
+			return;
+		}
+
+		SurfaceFiller filler(*surface.faces);
+		filler.fill_vertices(surface.flip_winding);
+		if (surface.faces->is_indexed()) {
+			filler.fill_indices(surface.flip_winding);
+		}
+		filler.get_surface_data(surface.data);
+	}
+
+	void build() {
+		uint32_t vertex_count = 0;
+		for (uint32_t i = 0; i < surfaces.size(); i++) {
+			vertex_count += surfaces[i].faces ? surfaces[i].faces->vertices.size() : 0;
+		}
+
+		if (vertex_count >= PARALLEL_MIN_VERTICES && surfaces.size() > 1) {
+			WorkerThreadPool::GroupID group_id = WorkerThreadPool::get_singleton()->add_template_group_task(this, &HalfBuilder::encode_surface, (void *)nullptr, surfaces.size(), -1, true, "Slicer sliced mesh");
+			WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_id);
+		} else {
+			for (uint32_t i = 0; i < surfaces.size(); i++) {
+				encode_surface(i, nullptr);
+			}
+		}
+
+		for (uint32_t i = 0; i < halves.size(); i++) {
+			Half &half = halves[i];
+			half.mesh = Ref<ArrayMesh>(memnew(ArrayMesh));
+			for (uint32_t j = half.first_surface; j < half.first_surface + half.surface_count; j++) {
+				Surface &surface = surfaces[j];
+				if (surface.unsplit) {
+					create_unsplit_surface(*surface.unsplit, half.mesh);
+				} else {
+					SurfaceFiller::add_surface_data(half.mesh, surface.data, surface.material);
+					surface.data = RS::SurfaceData();
+				}
+				add_parsed_surface(half, surface);
+			}
+		}
+	}
+
+	static void add_parsed_surface(const Half &half, const Surface &surface) {
+		if (!half.parsed) {
+			return;
+		}
+
+		if (surface.unsplit) {
+			::add_parsed_surface(half.parsed, FaceBuffer::faces_from_arrays(surface.unsplit->unsplit_arrays, half.parsed->preserve_indices), surface.material);
+		} else if (surface.flip_winding) {
+			FaceBuffer flipped = *surface.faces;
+			flipped.flip_winding();
+			::add_parsed_surface(half.parsed, flipped, surface.material);
+		} else {
+			::add_parsed_surface(half.parsed, *surface.faces, surface.material);
+		}
+	}
+};
+
+Ref<Mesh> SlicedMesh::create_mesh_half(
 		const Vector<Intersector::SplitResult> &surface_splits,
-		const Vector<SlicerFace> &cross_section_faces,
+		const FaceBuffer &cross_section_faces,
 		Ref<Material> cross_section_material,
-		bool is_upper) {
-	Ref<ArrayMesh> mesh = memnew(ArrayMesh);
+		bool is_upper,
+		ParsedMesh *r_parsed) {
+	HalfBuilder builder;
+	builder.add_half(surface_splits, cross_section_faces, cross_section_material, is_upper, r_parsed);
+	builder.build();
+	return builder.halves[0].mesh;
+}
+
+AABB SlicedMesh::get_half_aabb(const Vector<Intersector::SplitResult> &surface_splits, const FaceBuffer &cross_section_faces, bool is_upper) {
+	AABB aabb;
+	bool empty = true;
+	auto merge = [&](const AABB &p_aabb) {
+		aabb = empty ? p_aabb : aabb.merge(p_aabb);
+		empty = false;
+	};
 
 	for (int i = 0; i < surface_splits.size(); i++) {
-		if (is_upper) {
-			create_surface(surface_splits[i].upper_faces, surface_splits[i].material, mesh);
-		} else {
-			create_surface(surface_splits[i].lower_faces, surface_splits[i].material, mesh);
+		const Intersector::SplitResult &split = surface_splits[i];
+		if (split.unsplit_side != Intersector::SideOfPlane::ON) {
+			if ((split.unsplit_side == Intersector::SideOfPlane::OVER) != is_upper) {
+				continue;
+			}
+
+			Vector<Vector3> vertices = split.unsplit_arrays[Mesh::ARRAY_VERTEX];
+			if (vertices.size() > 0) {
+				AABB surface_aabb(vertices[0], Vector3());
+				for (int j = 1; j < vertices.size(); j++) {
+					surface_aabb.expand_to(vertices[j]);
+				}
+				merge(surface_aabb);
+			}
+			continue;
+		}
+
+		const FaceBuffer &faces = is_upper ? split.upper_faces : split.lower_faces;
+		if (faces.size() > 0) {
+			merge(faces.get_aabb());
 		}
 	}
 
-	if (cross_section_material.is_null() && mesh->get_surface_count() > 0) {
-		// I believe Ezy-Slice has a way of specifying the existing material to use,
-		// we may want to add that as a TODO
-		cross_section_material = mesh->surface_get_material(0);
-	} else if (cross_section_material.is_null()) {
-		cross_section_material = Ref<Material>(memnew(StandardMaterial3D));
+	if (cross_section_faces.size() > 0) {
+		merge(cross_section_faces.get_aabb());
 	}
+	return aabb;
+}
 
-	create_cross_section_surface(cross_section_faces, cross_section_material, mesh, is_upper);
-	return mesh;
+void SlicedMesh::release_pending() {
+	if (!upper_pending && !lower_pending) {
+		pending_splits.clear();
+		pending_cross_section.clear();
+		pending_material.unref();
+	}
+}
+
+Ref<Mesh> SlicedMesh::get_upper_mesh() {
+	if (upper_pending) {
+		upper_mesh = create_mesh_half(pending_splits, pending_cross_section, pending_material, true);
+		upper_pending = false;
+		release_pending();
+	}
+	return upper_mesh;
+}
+
+Ref<Mesh> SlicedMesh::get_lower_mesh() {
+	if (lower_pending) {
+		lower_mesh = create_mesh_half(pending_splits, pending_cross_section, pending_material, false);
+		lower_pending = false;
+		release_pending();
+	}
+	return lower_mesh;
+}
+
+AABB SlicedMesh::get_upper_aabb() const {
+	if (upper_pending) {
+		return get_half_aabb(pending_splits, pending_cross_section, true);
+	}
+	return upper_mesh.is_valid() ? upper_mesh->get_aabb() : AABB();
+}
+
+AABB SlicedMesh::get_lower_aabb() const {
+	if (lower_pending) {
+		return get_half_aabb(pending_splits, pending_cross_section, false);
+	}
+	return lower_mesh.is_valid() ? lower_mesh->get_aabb() : AABB();
 }
 
 void SlicedMesh::_bind_methods() {
@@ -118,11 +355,96 @@ void SlicedMesh::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_lower_mesh", "mesh"), &SlicedMesh::set_lower_mesh);
 	ClassDB::bind_method(D_METHOD("get_lower_mesh"), &SlicedMesh::get_lower_mesh);
 
+	ClassDB::bind_method(D_METHOD("get_upper_aabb"), &SlicedMesh::get_upper_aabb);
+	ClassDB::bind_method(D_METHOD("get_lower_aabb"), &SlicedMesh::get_lower_aabb);
+	ClassDB::bind_method(D_METHOD("has_upper_mesh"), &SlicedMesh::has_upper_mesh);
+	ClassDB::bind_method(D_METHOD("has_lower_mesh"), &SlicedMesh::has_lower_mesh);
+
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "upper_mesh", PROPERTY_HINT_RESOURCE_TYPE, "Mesh"), "set_upper_mesh", "get_upper_mesh");
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "lower_mesh", PROPERTY_HINT_RESOURCE_TYPE, "Mesh"), "set_lower_mesh", "get_lower_mesh");
 }
 
-void SlicedMesh::create_mesh(const Vector<Intersector::SplitResult> &surface_splits, const Vector<SlicerFace> &cross_section_faces, const Ref<Material> cross_section_material) {
-	upper_mesh = create_mesh_half(surface_splits, cross_section_faces, cross_section_material, true);
-	lower_mesh = create_mesh_half(surface_splits, cross_section_faces, cross_section_material, false);
+void SlicedMesh::create_mesh(const Vector<Intersector::SplitResult> &surface_splits, const FaceBuffer &cross_section_faces, const Ref<Material> cross_section_material, bool p_keep_faces, bool p_upper, bool p_lower) {
+	upper_pending = false;
+	lower_pending = false;
+	release_pending();
+	upper_parsed.unref();
+	lower_parsed.unref();
+	if (p_keep_faces && p_upper) {
+		upper_parsed.instantiate();
+		upper_parsed->preserve_indices = cross_section_faces.is_indexed();
+	}
+	if (p_keep_faces && p_lower) {
+		lower_parsed.instantiate();
+		lower_parsed->preserve_indices = cross_section_faces.is_indexed();
+	}
+
+	// Both halves get built together, so their surfaces can all be encoded at once
+	HalfBuilder builder;
+	if (p_upper) {
+		builder.add_half(surface_splits, cross_section_faces, cross_section_material, true, upper_parsed.ptr());
+	}
+	if (p_lower) {
+		builder.add_half(surface_splits, cross_section_faces, cross_section_material, false, lower_parsed.ptr());
+	}
+	builder.build();
+
+	upper_mesh = p_upper ? builder.halves[0].mesh : Ref<ArrayMesh>();
+	lower_mesh = p_lower ? builder.halves[p_upper ? 1 : 0].mesh : Ref<ArrayMesh>();
+}
+
+void SlicedMesh::defer_mesh(const Vector<Intersector::SplitResult> &surface_splits, const FaceBuffer &cross_section_faces, const Ref<Material> cross_section_material, bool p_upper, bool p_lower) {
+	upper_mesh.unref();
+	lower_mesh.unref();
+	upper_parsed.unref();
+	lower_parsed.unref();
+
+	// The split results are held in a copy on write Vector, so holding on to them doesn't
+	// copy their faces. Only the cross section, which is a lot smaller, gets copied
+	pending_splits = surface_splits;
+	pending_cross_section = cross_section_faces;
+	pending_material = cross_section_material;
+	upper_pending = p_upper;
+	lower_pending = p_lower;
+	release_pending();
+}
+
+void SlicedMesh::build_pending() {
+	if (!upper_pending && !lower_pending) {
+		return;
+	}
+
+	// create_mesh drops the pending results before building, so they're copied out first.
+	// That only copies the cross section's faces, the split results are copy on write
+	Vector<Intersector::SplitResult> surface_splits = pending_splits;
+	FaceBuffer cross_section_faces = pending_cross_section;
+	Ref<Material> cross_section_material = pending_material;
+	bool upper = upper_pending;
+	bool lower = lower_pending;
+	Ref<Mesh> built_upper = upper_mesh;
+	Ref<Mesh> built_lower = lower_mesh;
+
+	create_mesh(surface_splits, cross_section_faces, cross_section_material, false, upper, lower);
+
+	// A half that was already built stays as it was
+	if (!upper) {
+		upper_mesh = built_upper;
+	}
+	if (!lower) {
+		lower_mesh = built_lower;
+	}
+}
+
+Ref<Mesh> SlicedMesh::create_piece(const LocalVector<FaceBuffer> &surface_faces, const Vector<Ref<Material>> &materials, const FaceBuffer &cross_section_faces, const Ref<Material> cross_section_material) {
+	ERR_FAIL_COND_V((int)surface_faces.size() != materials.size(), Ref<Mesh>());
+	Ref<ArrayMesh> mesh = memnew(ArrayMesh);
+
+	for (uint32_t i = 0; i < surface_faces.size(); i++) {
+		create_surface(surface_faces[i], materials[i], mesh);
+	}
+
+	// The caps come in already wound to face out of the piece
+	Ref<Material> first_surface_material = mesh->get_surface_count() > 0 ? mesh->surface_get_material(0) : Ref<Material>();
+	create_cross_section_surface(cross_section_faces, get_cross_section_material(mesh->get_surface_count() > 0 ? &first_surface_material : nullptr, cross_section_material), mesh, false);
+	return mesh;
 }
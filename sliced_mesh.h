@@ -34,42 +34,120 @@
 #include "core/io/resource.h"
 
 #include "utils/intersector.h"
+#include "utils/parsed_mesh.h"
 
 /**
  * A simple container for the results of a mesh slice.
  * upper_mesh contains the part of the mesh that was above
  * the plane normal and lower_mesh contains the part that was
- * below
+ * below. Slices handed over with defer_mesh only build each
+ * half the first time it's asked for
  */
 class SlicedMesh : public Resource {
 	GDCLASS(SlicedMesh, Resource);
 
+	Ref<Mesh> upper_mesh;
+	Ref<Mesh> lower_mesh;
+
+	// What the halves still waiting to be built get built from, see defer_mesh
+	Vector<Intersector::SplitResult> pending_splits;
+	FaceBuffer pending_cross_section;
+	Ref<Material> pending_material;
+	bool upper_pending = false;
+	bool lower_pending = false;
+
+	void release_pending();
+
 protected:
 	static void _bind_methods();
 
 public:
-	Ref<Mesh> upper_mesh;
-	Ref<Mesh> lower_mesh;
+	// The faces each half was built from, only kept when asked for in create_mesh. Lets
+	// a half be sliced again without reading it back out of its mesh
+	Ref<ParsedMesh> upper_parsed;
+	Ref<ParsedMesh> lower_parsed;
 
 	void set_upper_mesh(const Ref<Mesh> &p_upper_mesh) {
 		upper_mesh = p_upper_mesh;
+		upper_parsed.unref();
+		upper_pending = false;
+		release_pending();
 	}
-	Ref<Mesh> get_upper_mesh() const {
-		return upper_mesh;
-	};
+	Ref<Mesh> get_upper_mesh();
 
 	void set_lower_mesh(const Ref<Mesh> &p_lower_mesh) {
 		lower_mesh = p_lower_mesh;
+		lower_parsed.unref();
+		lower_pending = false;
+		release_pending();
+	}
+	Ref<Mesh> get_lower_mesh();
+
+	/**
+	 * The bounds of either half. For a half that hasn't been built yet they're worked out
+	 * from the faces it would be built from, without building it
+	 */
+	AABB get_upper_aabb() const;
+	AABB get_lower_aabb() const;
+
+	/**
+	 * Whether the half has been built, or is waiting to be. False for a half that was
+	 * left out of the slice altogether
+	 */
+	bool has_upper_mesh() const {
+		return upper_mesh.is_valid() || upper_pending;
+	}
+	bool has_lower_mesh() const {
+		return lower_mesh.is_valid() || lower_pending;
+	}
+
+	/**
+	 * Whether the half has been built already, without building it
+	 */
+	bool is_upper_mesh_built() const {
+		return upper_mesh.is_valid();
+	}
+	bool is_lower_mesh_built() const {
+		return lower_mesh.is_valid();
 	}
-	Ref<Mesh> get_lower_mesh() const {
-		return lower_mesh;
-	};
 
 	/**
 	 * Transforms a vector of split results and a vector of faces representing
-	 * the cross section of a slice and creates an upper and lower mesh from them
+	 * the cross section of a slice and creates an upper and lower mesh from them.
+	 * With p_keep_faces the halves' faces are also kept in upper_parsed and lower_parsed.
+	 * Halves not named in p_upper and p_lower are left out
+	 */
+	void create_mesh(const Vector<Intersector::SplitResult> &surface_splits, const FaceBuffer &cross_section_faces, const Ref<Material> cross_section_material, bool p_keep_faces = false, bool p_upper = true, bool p_lower = true);
+
+	/**
+	 * Same as create_mesh, except the halves are only built the first time
+	 * get_upper_mesh or get_lower_mesh asks for them, so a half that's never looked at
+	 * never gets built at all. Halves not named in p_upper and p_lower are left out as well
+	 */
+	void defer_mesh(const Vector<Intersector::SplitResult> &surface_splits, const FaceBuffer &cross_section_faces, const Ref<Material> cross_section_material, bool p_upper = true, bool p_lower = true);
+
+	/**
+	 * Builds whichever halves are still waiting to be built from defer_mesh, both at once
+	 */
+	void build_pending();
+
+	/**
+	 * Creates either the upper or the lower half out of the results of a slice, for when
+	 * only one of them is needed. When r_parsed is passed in, every surface added to the
+	 * mesh is appended to it as well, using its preserve_indices for the unsplit surfaces
+	 */
+	static Ref<Mesh> create_mesh_half(const Vector<Intersector::SplitResult> &surface_splits, const FaceBuffer &cross_section_faces, Ref<Material> cross_section_material, bool is_upper, ParsedMesh *r_parsed = nullptr);
+
+	/**
+	 * The bounds of the half create_mesh_half would build out of the same results
+	 */
+	static AABB get_half_aabb(const Vector<Intersector::SplitResult> &surface_splits, const FaceBuffer &cross_section_faces, bool is_upper);
+
+	/**
+	 * Builds a standalone mesh out of one piece of a diced mesh, see Dicer. Each surface's
+	 * faces get the matching material and the cross section faces are added as they are
 	 */
-	void create_mesh(const Vector<Intersector::SplitResult> &surface_splits, const Vector<SlicerFace> &cross_section_faces, const Ref<Material> cross_section_material);
+	static Ref<Mesh> create_piece(const LocalVector<FaceBuffer> &surface_faces, const Vector<Ref<Material>> &materials, const FaceBuffer &cross_section_faces, const Ref<Material> cross_section_material);
 };
 
 #endif // SLICED_MESH_H
@@ -30,73 +30,104 @@
 
 #include "slicer.h"
 
-#include "core/error/error_macros.h"
-#include "modules/slicer/sliced_mesh.h"
-#include "utils/intersector.h"
-#include "utils/slicer_face.h"
-#include "utils/triangulator.h"
+#include "slice_job.h"
+#include "slice_task.h"
 
 Ref<SlicedMesh> Slicer::slice_by_plane(const Ref<Mesh> mesh, const Plane plane, const Ref<Material> cross_section_material) {
-	// TODO - This function is a little heavy. Maybe we should break it up
-	ERR_FAIL_COND_V(mesh.is_null(), Ref<SlicedMesh>());
-
-	Vector<Intersector::SplitResult> split_results;
-	split_results.resize(mesh->get_surface_count());
+	return engine->slice_by_plane(mesh, plane, cross_section_material);
+}
 
-	// The upper and lower meshes will share the same intersection points
-	Vector<Vector3> intersection_points;
+TypedArray<Mesh> Slicer::slice_by_planes(const Ref<Mesh> mesh, const TypedArray<Plane> &planes, const Ref<Material> cross_section_material) {
+	return engine->slice_by_planes(mesh, planes, cross_section_material);
+}
 
-	for (int i = 0; i < mesh->get_surface_count(); i++) {
-		Intersector::SplitResult results = split_results[i];
+TypedArray<Mesh> Slicer::slice_by_grid(const Ref<Mesh> mesh, const PackedFloat32Array &x_offsets, const PackedFloat32Array &y_offsets, const PackedFloat32Array &z_offsets, const Ref<Material> cross_section_material) {
+	return engine->slice_by_grid(mesh, x_offsets, y_offsets, z_offsets, cross_section_material);
+}
 
-		results.material = mesh->surface_get_material(i);
-		Vector<SlicerFace> faces = SlicerFace::faces_from_surface(mesh, i);
+Ref<SlicedMesh> Slicer::slice_by_convex(const Ref<Mesh> mesh, const TypedArray<Plane> &planes, const Ref<Material> cross_section_material) {
+	return engine->slice_by_convex(mesh, planes, cross_section_material);
+}
 
-		for (int j = 0; j < faces.size(); j++) {
-			Intersector::split_face_by_plane(plane, faces[j], results);
-		}
+Ref<SlicedMesh> Slicer::slice_by_convex_shape(const Ref<Mesh> mesh, const Ref<ConvexPolygonShape3D> shape, const Transform3D shape_transform, const Ref<Material> cross_section_material) {
+	return engine->slice_by_convex_shape(mesh, shape, shape_transform, cross_section_material);
+}
 
-		int ip_size = intersection_points.size();
-		intersection_points.resize(ip_size + results.intersection_points.size());
-		for (int j = 0; j < results.intersection_points.size(); j++) {
-			intersection_points.write[ip_size + j] = results.intersection_points[j];
-		}
-		results.intersection_points.resize(0);
+TypedArray<Mesh> Slicer::fracture(const Ref<Mesh> mesh, const PackedVector3Array &seeds, const Ref<Material> cross_section_material) {
+	return engine->fracture(mesh, seeds, cross_section_material);
+}
 
-		split_results.write[i] = results;
-	}
+TypedArray<Mesh> Slicer::fracture_random(const Ref<Mesh> mesh, int seed_count, int64_t random_seed, const Ref<Material> cross_section_material) {
+	return engine->fracture_random(mesh, seed_count, random_seed, cross_section_material);
+}
 
-	// If no intersection has occurred then there's really nothing for us to do
-	// but still, is this the expected behavior? Would it be better to return an
-	// actual SliceMesh with either the upper_mesh or lower_mesh null?
-	if (intersection_points.size() == 0) {
-		return Ref<SlicedMesh>();
-	}
+Ref<SlicedMesh> Slicer::slice_mesh(const Ref<Mesh> mesh, const Vector3 position, const Vector3 normal, const Ref<Material> cross_section_material) {
+	return engine->slice_mesh(mesh, position, normal, cross_section_material);
+}
 
-	Vector<SlicerFace> cross_section_faces = Triangulator::monotone_chain(intersection_points, plane.normal);
+Ref<SlicedMesh> Slicer::slice(const Ref<Mesh> mesh, const Transform3D mesh_transform, const Vector3 position, const Vector3 normal, const Ref<Material> cross_section_material) {
+	return engine->slice(mesh, mesh_transform, position, normal, cross_section_material);
+}
 
-	Ref<SlicedMesh> sliced_mesh;
-	sliced_mesh.instantiate();
-	sliced_mesh->create_mesh(split_results, cross_section_faces, cross_section_material);
-	return sliced_mesh;
+Ref<SliceTask> Slicer::slice_by_plane_async(const Ref<Mesh> mesh, const Plane plane, const Ref<Material> cross_section_material) {
+	return engine->slice_by_plane_async(mesh, plane, cross_section_material);
 }
 
-Ref<SlicedMesh> Slicer::slice_mesh(const Ref<Mesh> mesh, const Vector3 position, const Vector3 normal, const Ref<Material> cross_section_material) {
-	Plane plane(normal, normal.dot(position));
-	return slice_by_plane(mesh, plane, cross_section_material);
+Ref<SliceTask> Slicer::slice_mesh_async(const Ref<Mesh> mesh, const Vector3 position, const Vector3 normal, const Ref<Material> cross_section_material) {
+	return engine->slice_mesh_async(mesh, position, normal, cross_section_material);
 }
 
-Ref<SlicedMesh> Slicer::slice(const Ref<Mesh> mesh, const Transform3D mesh_transform, const Vector3 position, const Vector3 normal, const Ref<Material> cross_section_material) {
-	// We need to reorient the plane so that it will correctly slice the mesh whose vertices are based on the origin
-	Vector3 origin = position - mesh_transform.origin;
-	real_t dist = normal.dot(origin);
-	Vector3 adjusted_normal = mesh_transform.basis.xform_inv(normal);
+Ref<SliceTask> Slicer::slice_async(const Ref<Mesh> mesh, const Transform3D mesh_transform, const Vector3 position, const Vector3 normal, const Ref<Material> cross_section_material) {
+	return engine->slice_async(mesh, mesh_transform, position, normal, cross_section_material);
+}
 
-	return slice_by_plane(mesh, Plane(adjusted_normal, dist), cross_section_material);
+Ref<SliceJob> Slicer::create_slice_job(const Ref<Mesh> mesh, const Plane plane, const Ref<Material> cross_section_material) {
+	return engine->create_slice_job(mesh, plane, cross_section_material);
 }
 
 void Slicer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("slice_by_plane", "mesh", "plane", "cross_section_material"), &Slicer::slice_by_plane);
+	ClassDB::bind_method(D_METHOD("slice_by_planes", "mesh", "planes", "cross_section_material"), &Slicer::slice_by_planes);
+	ClassDB::bind_method(D_METHOD("slice_by_grid", "mesh", "x_offsets", "y_offsets", "z_offsets", "cross_section_material"), &Slicer::slice_by_grid);
+	ClassDB::bind_method(D_METHOD("slice_by_convex", "mesh", "planes", "cross_section_material"), &Slicer::slice_by_convex);
+	ClassDB::bind_method(D_METHOD("slice_by_convex_shape", "mesh", "shape", "shape_transform", "cross_section_material"), &Slicer::slice_by_convex_shape);
+	ClassDB::bind_method(D_METHOD("fracture", "mesh", "seeds", "cross_section_material"), &Slicer::fracture);
+	ClassDB::bind_method(D_METHOD("fracture_random", "mesh", "seed_count", "random_seed", "cross_section_material"), &Slicer::fracture_random);
 	ClassDB::bind_method(D_METHOD("slice_mesh", "mesh", "position", "normal", "cross_section_material"), &Slicer::slice_mesh);
 	ClassDB::bind_method(D_METHOD("slice", "mesh_instance", "mesh_transform", "position", "normal", "cross_section_material"), &Slicer::slice);
+	ClassDB::bind_method(D_METHOD("slice_by_plane_async", "mesh", "plane", "cross_section_material"), &Slicer::slice_by_plane_async);
+	ClassDB::bind_method(D_METHOD("slice_mesh_async", "mesh", "position", "normal", "cross_section_material"), &Slicer::slice_mesh_async);
+	ClassDB::bind_method(D_METHOD("slice_async", "mesh", "mesh_transform", "position", "normal", "cross_section_material"), &Slicer::slice_async);
+	ClassDB::bind_method(D_METHOD("create_slice_job", "mesh", "plane", "cross_section_material"), &Slicer::create_slice_job);
+
+	ClassDB::bind_method(D_METHOD("set_halves", "halves"), &Slicer::set_halves);
+	ClassDB::bind_method(D_METHOD("get_halves"), &Slicer::get_halves);
+	ClassDB::bind_method(D_METHOD("set_preserve_indices", "preserve_indices"), &Slicer::set_preserve_indices);
+	ClassDB::bind_method(D_METHOD("get_preserve_indices"), &Slicer::get_preserve_indices);
+
+	ClassDB::bind_method(D_METHOD("set_use_mesh_cache", "use_mesh_cache"), &Slicer::set_use_mesh_cache);
+	ClassDB::bind_method(D_METHOD("get_use_mesh_cache"), &Slicer::get_use_mesh_cache);
+	ClassDB::bind_method(D_METHOD("set_use_bvh", "use_bvh"), &Slicer::set_use_bvh);
+	ClassDB::bind_method(D_METHOD("get_use_bvh"), &Slicer::get_use_bvh);
+	ClassDB::bind_method(D_METHOD("set_keep_sliced_faces", "keep_sliced_faces"), &Slicer::set_keep_sliced_faces);
+	ClassDB::bind_method(D_METHOD("get_keep_sliced_faces"), &Slicer::get_keep_sliced_faces);
+	ClassDB::bind_method(D_METHOD("set_mesh_cache_memory_limit", "memory_limit"), &Slicer::set_mesh_cache_memory_limit);
+	ClassDB::bind_method(D_METHOD("get_mesh_cache_memory_limit"), &Slicer::get_mesh_cache_memory_limit);
+	ClassDB::bind_method(D_METHOD("clear_mesh_cache"), &Slicer::clear_mesh_cache);
+	ClassDB::bind_method(D_METHOD("get_slice_engine"), &Slicer::get_slice_engine);
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "halves", PROPERTY_HINT_ENUM, "Both,Upper,Lower"), "set_halves", "get_halves");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "preserve_indices"), "set_preserve_indices", "get_preserve_indices");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "use_mesh_cache"), "set_use_mesh_cache", "get_use_mesh_cache");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "use_bvh"), "set_use_bvh", "get_use_bvh");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "keep_sliced_faces"), "set_keep_sliced_faces", "get_keep_sliced_faces");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "mesh_cache_memory_limit", PROPERTY_HINT_RANGE, "0,1073741824,1,or_greater,suffix:B"), "set_mesh_cache_memory_limit", "get_mesh_cache_memory_limit");
+
+	BIND_ENUM_CONSTANT(HALVES_BOTH);
+	BIND_ENUM_CONSTANT(HALVES_UPPER);
+	BIND_ENUM_CONSTANT(HALVES_LOWER);
+}
+
+Slicer::Slicer() {
+	engine.instantiate();
 }
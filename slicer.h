@@ -31,26 +31,176 @@
 #ifndef SLICER_H
 #define SLICER_H
 
+#include "core/variant/typed_array.h"
 #include "scene/3d/node_3d.h"
+#include "scene/resources/3d/convex_polygon_shape_3d.h"
 #include "scene/resources/mesh.h"
+#include "slice_engine.h"
 #include "sliced_mesh.h"
+#include "utils/mesh_cache.h"
+
+class SliceJob;
+class SliceTask;
 
 /**
- * Helper for cutting a convex mesh along a plane and returning
- * two new meshes representing both sides of the cut
+ * Helper for cutting a mesh along a plane and returning
+ * two new meshes representing both sides of the cut.
+ * All of the work is done by its SliceEngine, which can be
+ * handed out to slice with from other threads
  */
 class Slicer : public Node3D {
 	GDCLASS(Slicer, Node3D);
 
+public:
+	enum Halves {
+		HALVES_BOTH,
+		HALVES_UPPER,
+		HALVES_LOWER,
+	};
+
+private:
+	Ref<SliceEngine> engine;
+
 protected:
 	static void _bind_methods();
 
 public:
+	/**
+	 * Which halves slice_by_plane and slice_by_convex produce. When only one of them is
+	 * wanted no faces get collected for the other one at all, leaving its mesh null
+	 */
+	void set_halves(Halves p_halves) {
+		engine->set_halves(SliceEngine::Halves(p_halves));
+	}
+	Halves get_halves() const {
+		return Halves(engine->get_halves());
+	}
+
+	/**
+	 * When enabled, indexed surfaces are sliced without being expanded into loose faces
+	 * and the resulting meshes are indexed as well, with the faces along the cut sharing
+	 * their new vertices
+	 */
+	void set_preserve_indices(bool p_preserve_indices) {
+		engine->set_preserve_indices(p_preserve_indices);
+	}
+	bool get_preserve_indices() const {
+		return engine->get_preserve_indices();
+	}
+
+	/**
+	 * When enabled, the parsed form of each sliced mesh is kept around so that slicing
+	 * the same mesh again skips reading its surfaces back in. Cached meshes are dropped as
+	 * soon as they emit `changed`
+	 */
+	void set_use_mesh_cache(bool p_use_mesh_cache) {
+		engine->set_use_mesh_cache(p_use_mesh_cache);
+	}
+	bool get_use_mesh_cache() const {
+		return engine->get_use_mesh_cache();
+	}
+
+	/**
+	 * When enabled, cached meshes also get a bounding volume hierarchy built over the faces
+	 * of each surface, letting a slice skip straight past everything not near the plane.
+	 * Building the tree costs more than a single slice, so it's only used alongside
+	 * use_mesh_cache
+	 */
+	void set_use_bvh(bool p_use_bvh) {
+		engine->set_use_bvh(p_use_bvh);
+	}
+	bool get_use_bvh() const {
+		return engine->get_use_bvh();
+	}
+
+	/**
+	 * When enabled, the faces each half of a slice was built from are kept on the
+	 * SlicedMesh and cached for its upper_mesh and lower_mesh, so slicing one of the
+	 * halves again starts straight from those faces instead of reading the new mesh back
+	 * in. Like use_bvh, it's only used alongside use_mesh_cache
+	 */
+	void set_keep_sliced_faces(bool p_keep_sliced_faces) {
+		engine->set_keep_sliced_faces(p_keep_sliced_faces);
+	}
+	bool get_keep_sliced_faces() const {
+		return engine->get_keep_sliced_faces();
+	}
+
+	void set_mesh_cache_memory_limit(int64_t p_memory_limit) {
+		engine->set_mesh_cache_memory_limit(p_memory_limit);
+	}
+	int64_t get_mesh_cache_memory_limit() const {
+		return engine->get_mesh_cache_memory_limit();
+	}
+
+	/**
+	 * Drops every cached mesh
+	 */
+	void clear_mesh_cache() {
+		engine->clear_mesh_cache();
+	}
+
+	MeshCache *get_mesh_cache() const {
+		return engine->get_mesh_cache();
+	}
+
+	/**
+	 * The engine doing the Slicer's slices, sharing its settings and mesh cache. Unlike the
+	 * Slicer itself it's safe to slice with from any thread
+	 */
+	Ref<SliceEngine> get_slice_engine() const {
+		return engine;
+	}
+
 	/**
 	 * Slice the passed in mesh along the passed in plane, setting the interrior cut surface to the passed in material
 	 */
 	Ref<SlicedMesh> slice_by_plane(const Ref<Mesh> mesh, const Plane plane, const Ref<Material> cross_section_material);
 
+	/**
+	 * Cuts the mesh into the slabs between a list of parallel planes in a single pass,
+	 * returning one mesh per slab that ended up with any faces, ordered from furthest
+	 * against the planes' normal to furthest along it. The pieces are always made of loose
+	 * faces, whatever preserve_indices is set to
+	 */
+	TypedArray<Mesh> slice_by_planes(const Ref<Mesh> mesh, const TypedArray<Plane> &planes, const Ref<Material> cross_section_material);
+
+	/**
+	 * Same as slice_by_planes for a grid of axis aligned planes, given as their offsets
+	 * along the mesh's x, y and z axes. Any of the lists can be left empty. Pieces are
+	 * ordered by cell, with x varying fastest and z slowest
+	 */
+	TypedArray<Mesh> slice_by_grid(const Ref<Mesh> mesh, const PackedFloat32Array &x_offsets, const PackedFloat32Array &y_offsets, const PackedFloat32Array &z_offsets, const Ref<Material> cross_section_material);
+
+	/**
+	 * Cuts the mesh by a convex volume, given as the planes bounding it with their normals
+	 * facing outwards, in a single pass. The part of the mesh inside the volume becomes the
+	 * lower mesh and everything else the upper mesh, with both capped where the volume
+	 * cut through them
+	 */
+	Ref<SlicedMesh> slice_by_convex(const Ref<Mesh> mesh, const TypedArray<Plane> &planes, const Ref<Material> cross_section_material);
+
+	/**
+	 * Same as slice_by_convex, with the volume being the convex hull of the shape's points
+	 * placed in the mesh's space by shape_transform
+	 */
+	Ref<SlicedMesh> slice_by_convex_shape(const Ref<Mesh> mesh, const Ref<ConvexPolygonShape3D> shape, const Transform3D shape_transform, const Ref<Material> cross_section_material);
+
+	/**
+	 * Breaks the mesh up into the cells of the Voronoi diagram of the passed in seeds,
+	 * returning one mesh per seed with each capped where it was cut. Every cell is cut out
+	 * on the WorkerThreadPool from a single parsed copy of the mesh and the results don't
+	 * depend on how the cells got spread across threads. Cells that miss the mesh
+	 * entirely are left null
+	 */
+	TypedArray<Mesh> fracture(const Ref<Mesh> mesh, const PackedVector3Array &seeds, const Ref<Material> cross_section_material);
+
+	/**
+	 * Same as fracture, with seed_count seeds scattered across the mesh's bounds. The same
+	 * random_seed always gives the same seeds
+	 */
+	TypedArray<Mesh> fracture_random(const Ref<Mesh> mesh, int seed_count, int64_t random_seed, const Ref<Material> cross_section_material);
+
 	/**
 	 * Generates a plane based on the given position and normal and perform a cut along that plane
 	 */
@@ -60,8 +210,36 @@ public:
 	 * Generates a plane based on the given position and normal and offsets it by the given Transform3D before applying the slice
 	 */
 	Ref<SlicedMesh> slice(const Ref<Mesh> mesh, const Transform3D mesh_transform, const Vector3 position, const Vector3 normal, const Ref<Material> cross_section_material);
-	~Slicer() {}
-	Slicer() {}
+
+	/**
+	 * Same as slice_by_plane, except that the whole slice runs on the WorkerThreadPool and
+	 * this returns straight away with a SliceTask to poll or wait on. The Slicer's
+	 * properties are copied when the slice starts, and both halves get built on the
+	 * worker as well, so the SlicedMesh is ready to use once the task completes. Slicing
+	 * the mesh needs it to be left alone until then, though the Slicer can be freed meanwhile
+	 */
+	Ref<SliceTask> slice_by_plane_async(const Ref<Mesh> mesh, const Plane plane, const Ref<Material> cross_section_material);
+
+	/**
+	 * slice_mesh on the WorkerThreadPool, see slice_by_plane_async
+	 */
+	Ref<SliceTask> slice_mesh_async(const Ref<Mesh> mesh, const Vector3 position, const Vector3 normal, const Ref<Material> cross_section_material);
+
+	/**
+	 * slice on the WorkerThreadPool, see slice_by_plane_async
+	 */
+	Ref<SliceTask> slice_async(const Ref<Mesh> mesh, const Transform3D mesh_transform, const Vector3 position, const Vector3 normal, const Ref<Material> cross_section_material);
+
+	/**
+	 * Same as slice_by_plane, except that nothing is done until the returned SliceJob is
+	 * stepped, a little at a time, e.g. from _process under a per frame budget. The
+	 * Slicer's properties are copied when the job is created
+	 */
+	Ref<SliceJob> create_slice_job(const Ref<Mesh> mesh, const Plane plane, const Ref<Material> cross_section_material);
+
+	Slicer();
 };
 
+VARIANT_ENUM_CAST(Slicer::Halves);
+
 #endif // SLICER_H
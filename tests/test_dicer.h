@@ -0,0 +1,145 @@
+/**************************************************************************/
+/*  test_dicer.h                                                          */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef TEST_DICER_H
+#define TEST_DICER_H
+
+#include "tests/test_macros.h"
+
+#include "../utils/dicer.h"
+#include "../utils/intersector.h"
+#include "scene/resources/3d/primitive_meshes.h"
+
+namespace TestDicer {
+
+// Summed up in double precision so the order the faces come in doesn't matter
+double get_area(const FaceBuffer &faces) {
+	double area = 0;
+	for (int i = 0; i < faces.size(); i++) {
+		Vector3 a = faces.vertices[faces.get_vertex_index(i, 0)];
+		Vector3 b = faces.vertices[faces.get_vertex_index(i, 1)];
+		Vector3 c = faces.vertices[faces.get_vertex_index(i, 2)];
+		area += (b - a).cross(c - a).length() * 0.5;
+	}
+	return area;
+}
+
+// Whether every vertex lies within the cell's bounds along each axis
+bool is_inside_cell(const Dicer &dicer, const FaceBuffer &faces, int cell) {
+	for (uint32_t a = 0; a < dicer.axes.size(); a++) {
+		const Dicer::Axis &axis = dicer.axes[a];
+		int idx = (cell / axis.stride) % (axis.offsets.size() + 1);
+		real_t lo = idx == 0 ? -1e20 : axis.offsets[idx - 1];
+		real_t hi = idx == (int)axis.offsets.size() ? 1e20 : axis.offsets[idx];
+		for (uint32_t i = 0; i < faces.vertices.size(); i++) {
+			real_t dist = axis.normal.dot(faces.vertices[i]);
+			if (dist < lo - CMP_EPSILON || dist > hi + CMP_EPSILON) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+TEST_SUITE("[Dicer]") {
+	TEST_CASE("[Modules][Slicer][SceneTree] Every face ends up in the cell it lies in") {
+		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
+		FaceBuffer faces = FaceBuffer::faces_from_surface(sphere_mesh, 0);
+
+		Dicer dicer;
+		Vector<real_t> offsets;
+		offsets.push_back(0.25);
+		offsets.push_back(-0.3);
+		offsets.push_back(0.1);
+		offsets.push_back(0.1);
+		dicer.add_axis(Vector3(0, 1, 0), offsets);
+		dicer.add_axis(Vector3(1, 0, 0), Vector<real_t>({ 0.05 }));
+		REQUIRE(dicer.axes[0].offsets.size() == 3);
+		REQUIRE(dicer.axes[0].offsets[0] == (real_t)-0.3);
+
+		dicer.begin(1);
+		dicer.dice_surface(0, faces);
+		REQUIRE(dicer.get_cell_count() == 8);
+
+		double area = 0;
+		for (int i = 0; i < dicer.get_cell_count(); i++) {
+			const FaceBuffer &cell_faces = dicer.cells[i].surfaces[0];
+			REQUIRE_FALSE(dicer.cells[i].is_empty());
+			REQUIRE(is_inside_cell(dicer, cell_faces, i));
+			area += get_area(cell_faces);
+		}
+		REQUIRE(Math::abs(area - get_area(faces)) < 0.0001);
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] A single plane splits the same as the intersector") {
+		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
+		FaceBuffer faces = FaceBuffer::faces_from_surface(sphere_mesh, 0);
+		Plane plane(Vector3(1, 1, 0).normalized(), 0.2);
+
+		Intersector::SplitResult control;
+		control.set_format(faces.format);
+		Intersector::split_surface_by_plane(plane, faces, control);
+
+		Dicer dicer;
+		dicer.add_axis(plane.normal, Vector<real_t>({ plane.d }));
+		dicer.begin(1);
+		dicer.dice_surface(0, faces);
+		REQUIRE(dicer.cells[0].surfaces[0].size() == control.lower_faces.size());
+		REQUIRE(dicer.cells[1].surfaces[0].size() == control.upper_faces.size());
+		REQUIRE(dicer.axes[0].segments[0].size() == control.cut_segments.size());
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Caps are cut up along the rest of the grid") {
+		Ref<BoxMesh> box_mesh = memnew(BoxMesh);
+		FaceBuffer faces = FaceBuffer::faces_from_surface(box_mesh, 0);
+
+		Dicer dicer;
+		for (int a = 0; a < 3; a++) {
+			Vector3 normal;
+			normal[a] = 1;
+			dicer.add_axis(normal, Vector<real_t>({ 0 }));
+		}
+		dicer.begin(1);
+		dicer.dice_surface(0, faces);
+		dicer.build_cross_sections();
+
+		// Each corner of the box gets a quarter of each of the three faces it touches on
+		// the outside and a quarter of each of the three cuts on the inside
+		for (int i = 0; i < 8; i++) {
+			REQUIRE(Math::is_equal_approx((real_t)get_area(dicer.cells[i].surfaces[0]), (real_t)0.75));
+			REQUIRE(Math::is_equal_approx((real_t)get_area(dicer.cells[i].cross_section), (real_t)0.75));
+			REQUIRE(is_inside_cell(dicer, dicer.cells[i].surfaces[0], i));
+			REQUIRE(is_inside_cell(dicer, dicer.cells[i].cross_section, i));
+		}
+	}
+}
+} //namespace TestDicer
+
+#endif // TEST_DICER_H
@@ -0,0 +1,152 @@
+/**************************************************************************/
+/*  test_face_buffer.h                                                    */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef TEST_FACE_BUFFER_H
+#define TEST_FACE_BUFFER_H
+
+#include "scene/resources/mesh.h"
+#include "tests/test_macros.h"
+
+#include "../utils/face_buffer.h"
+#include "../utils/format_dispatch.h"
+#include "scene/resources/3d/primitive_meshes.h"
+
+namespace TestFaceBuffer {
+
+struct RecordFormat {
+	template <uint32_t FORMAT>
+	static void run(uint32_t &r_format) {
+		r_format = FORMAT;
+	}
+};
+
+TEST_SUITE("[FaceBuffer]") {
+	TEST_CASE("[Modules][Slicer][SceneTree] Parses faces similar to built in method") {
+		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
+		auto control_faces = sphere_mesh->get_faces();
+		FaceBuffer faces = FaceBuffer::faces_from_surface(sphere_mesh, 0);
+		REQUIRE(faces.size() == control_faces.size());
+		for (int i = 0; i < faces.size(); i++) {
+			REQUIRE(faces.get_face(i) == control_faces[i]);
+		}
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Preserves indices") {
+		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
+		FaceBuffer faces = FaceBuffer::faces_from_surface(sphere_mesh, 0);
+		FaceBuffer indexed_faces = FaceBuffer::faces_from_surface(sphere_mesh, 0, true);
+		REQUIRE(indexed_faces.is_indexed());
+		REQUIRE(indexed_faces.format == (faces.format | FaceBuffer::ATTRIBUTE_INDEX));
+		REQUIRE((int)indexed_faces.vertices.size() == sphere_mesh->surface_get_array_len(0));
+		REQUIRE(indexed_faces.size() == faces.size());
+		for (int i = 0; i < faces.size(); i++) {
+			REQUIRE(indexed_faces.get_face(i) == faces.get_face(i));
+		}
+	}
+
+	TEST_CASE("[Modules][Slicer] Dispatches common formats to their own specialization") {
+		uint32_t format = 0;
+		FormatDispatch::dispatch<RecordFormat>(FormatDispatch::FORMAT_NORMAL_UV, format);
+		REQUIRE(format == FormatDispatch::FORMAT_NORMAL_UV);
+
+		// The index flag doesn't change which streams there are
+		FormatDispatch::dispatch<RecordFormat>(FormatDispatch::FORMAT_SKINNED | FaceBuffer::ATTRIBUTE_INDEX, format);
+		REQUIRE(format == FormatDispatch::FORMAT_SKINNED);
+
+		FormatDispatch::dispatch<RecordFormat>(FaceBuffer::ATTRIBUTE_COLOR | FaceBuffer::ATTRIBUTE_UV2, format);
+		REQUIRE(format == FaceBuffer::FORMAT_DYNAMIC);
+	}
+
+	TEST_CASE("[Modules][Slicer] Specialized appends match the dynamic ones") {
+		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
+		FaceBuffer src = FaceBuffer::faces_from_surface(sphere_mesh, 0);
+		REQUIRE((src.format == FormatDispatch::FORMAT_NORMAL_TANGENT_UV));
+
+		FaceBuffer dynamic_faces;
+		dynamic_faces.set_format(src.format);
+		FaceBuffer specialized_faces;
+		specialized_faces.set_format(src.format);
+
+		for (int i = 0; i < src.size(); i++) {
+			dynamic_faces.append_vertex(src, i * 3);
+			dynamic_faces.append_edge_vertex(src, i * 3, i * 3 + 1, 0.5);
+			dynamic_faces.append_vertex(src, i * 3 + 2);
+			specialized_faces.append_vertex<FormatDispatch::FORMAT_NORMAL_TANGENT_UV>(src, i * 3);
+			specialized_faces.append_edge_vertex<FormatDispatch::FORMAT_NORMAL_TANGENT_UV>(src, i * 3, i * 3 + 1, 0.5);
+			specialized_faces.append_vertex<FormatDispatch::FORMAT_NORMAL_TANGENT_UV>(src, i * 3 + 2);
+		}
+
+		REQUIRE(specialized_faces.size() == dynamic_faces.size());
+		for (int i = 0; i < dynamic_faces.size(); i++) {
+			REQUIRE(specialized_faces.get_face(i) == dynamic_faces.get_face(i));
+		}
+	}
+
+	TEST_CASE("[Modules][Slicer] flip_winding") {
+		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
+		for (int indexed = 0; indexed < 2; indexed++) {
+			FaceBuffer src = FaceBuffer::faces_from_surface(sphere_mesh, 0, indexed);
+			FaceBuffer faces = src;
+			faces.flip_winding();
+
+			REQUIRE(faces.size() == src.size());
+			for (int i = 0; i < src.size(); i++) {
+				SlicerFace face = faces.get_face(i);
+				SlicerFace src_face = src.get_face(i);
+				REQUIRE(face.vertex[0] == src_face.vertex[0]);
+				REQUIRE(face.vertex[1] == src_face.vertex[2]);
+				REQUIRE(face.vertex[2] == src_face.vertex[1]);
+				REQUIRE(face.uv[1] == src_face.uv[2]);
+			}
+		}
+	}
+
+	TEST_CASE("[Modules][Slicer] append_faces and clear") {
+		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
+		FaceBuffer src = FaceBuffer::faces_from_surface(sphere_mesh, 0);
+
+		FaceBuffer faces;
+		faces.set_format(src.format);
+		faces.append_face(src, 3);
+		faces.append_faces(src);
+
+		REQUIRE(faces.size() == src.size() + 1);
+		REQUIRE(faces.get_face(0) == src.get_face(3));
+		REQUIRE(faces.get_face(src.size()) == src.get_face(src.size() - 1));
+
+		faces.clear();
+		REQUIRE(faces.size() == 0);
+		REQUIRE(faces.uvs.size() == 0);
+		REQUIRE(faces.format == src.format);
+	}
+}
+} //namespace TestFaceBuffer
+
+#endif // TEST_FACE_BUFFER_H
@@ -0,0 +1,145 @@
+/**************************************************************************/
+/*  test_face_bvh.h                                                       */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef TEST_FACE_BVH_H
+#define TEST_FACE_BVH_H
+
+#include "tests/test_macros.h"
+
+#include "../slicer.h"
+#include "../utils/face_bvh.h"
+#include "../utils/intersector.h"
+#include "scene/resources/3d/primitive_meshes.h"
+
+namespace TestFaceBVH {
+
+// Summed up in double precision so the order the faces come in doesn't matter
+Vector3 sum_vertices(const FaceBuffer &faces) {
+	double sum[3] = { 0, 0, 0 };
+	for (int i = 0; i < faces.size(); i++) {
+		for (int j = 0; j < 3; j++) {
+			const Vector3 &vertex = faces.vertices[faces.get_vertex_index(i, j)];
+			for (int k = 0; k < 3; k++) {
+				sum[k] += vertex[k];
+			}
+		}
+	}
+	return Vector3(sum[0], sum[1], sum[2]);
+}
+
+void check_split_matches(const FaceBuffer &faces, const Plane &plane) {
+	FaceBuffer tree_faces = faces;
+	FaceBVH bvh;
+	bvh.build(tree_faces);
+
+	Intersector::SplitResult control;
+	control.set_format(faces.format);
+	Intersector::split_surface_by_plane(plane, faces, control);
+
+	Intersector::SplitResult result;
+	result.set_format(faces.format);
+	Intersector::split_surface_by_plane(plane, tree_faces, result, &bvh);
+
+	// The faces come out in a different order, but the same ones should come out
+	REQUIRE(result.upper_faces.size() == control.upper_faces.size());
+	REQUIRE(result.lower_faces.size() == control.lower_faces.size());
+	REQUIRE(result.upper_faces.vertices.size() == control.upper_faces.vertices.size());
+	REQUIRE(result.lower_faces.vertices.size() == control.lower_faces.vertices.size());
+	REQUIRE(result.cut_segments.size() == control.cut_segments.size());
+	REQUIRE(sum_vertices(result.upper_faces).distance_to(sum_vertices(control.upper_faces)) < 0.001);
+	REQUIRE(sum_vertices(result.lower_faces).distance_to(sum_vertices(control.lower_faces)) < 0.001);
+}
+
+TEST_SUITE("[FaceBVH]") {
+	TEST_CASE("[Modules][Slicer][SceneTree] Every node covers its faces") {
+		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
+		FaceBuffer faces = FaceBuffer::faces_from_surface(sphere_mesh, 0);
+		Vector3 control_sum = sum_vertices(faces);
+		int face_count = faces.size();
+
+		FaceBVH bvh;
+		bvh.build(faces);
+		REQUIRE_FALSE(bvh.is_empty());
+		REQUIRE(faces.size() == face_count);
+		REQUIRE(sum_vertices(faces).distance_to(control_sum) < 0.001);
+		REQUIRE(bvh.nodes[0].begin == 0);
+		REQUIRE(bvh.nodes[0].count == face_count);
+
+		for (uint32_t i = 0; i < bvh.nodes.size(); i++) {
+			const FaceBVH::Node &node = bvh.nodes[i];
+			if (node.is_leaf()) {
+				REQUIRE(node.count <= FaceBVH::LEAF_SIZE);
+			} else {
+				const FaceBVH::Node &left = bvh.nodes[node.left];
+				const FaceBVH::Node &right = bvh.nodes[node.left + 1];
+				REQUIRE(left.begin == node.begin);
+				REQUIRE(right.begin == left.begin + left.count);
+				REQUIRE(left.count + right.count == node.count);
+			}
+
+			AABB grown = node.aabb.grow(CMP_EPSILON);
+			for (int j = node.begin; j < node.begin + node.count; j++) {
+				for (int k = 0; k < 3; k++) {
+					REQUIRE(grown.has_point(faces.vertices[faces.get_vertex_index(j, k)]));
+				}
+			}
+		}
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Splits the same as going face by face") {
+		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
+		for (int preserve_indices = 0; preserve_indices < 2; preserve_indices++) {
+			FaceBuffer faces = FaceBuffer::faces_from_surface(sphere_mesh, 0, preserve_indices);
+			check_split_matches(faces, Plane(Vector3(0, 1, 0), 0.1));
+			check_split_matches(faces, Plane(Vector3(1, 1, 0).normalized(), 0.45));
+			check_split_matches(faces, Plane(Vector3(0, 0, 1), -0.49));
+		}
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Slicer uses the tree alongside the cache") {
+		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
+		Plane plane(Vector3(1, 0, 0), 0.4);
+		Slicer slicer;
+		Ref<SlicedMesh> control = slicer.slice_by_plane(sphere_mesh, plane, NULL);
+
+		slicer.set_use_mesh_cache(true);
+		slicer.set_use_bvh(true);
+		Ref<SlicedMesh> sliced_mesh = slicer.slice_by_plane(sphere_mesh, plane, NULL);
+		REQUIRE(slicer.get_mesh_cache()->get_parsed_mesh(sphere_mesh)->has_bvh);
+		REQUIRE_FALSE(sliced_mesh.is_null());
+		for (int i = 0; i < 2; i++) {
+			REQUIRE(sliced_mesh->get_upper_mesh()->surface_get_array_len(i) == control->get_upper_mesh()->surface_get_array_len(i));
+			REQUIRE(sliced_mesh->get_lower_mesh()->surface_get_array_len(i) == control->get_lower_mesh()->surface_get_array_len(i));
+		}
+	}
+}
+} //namespace TestFaceBVH
+
+#endif // TEST_FACE_BVH_H
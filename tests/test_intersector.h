@@ -34,10 +34,32 @@
 #include "tests/test_macros.h"
 
 #include "../utils/intersector.h"
+#include "../utils/vertex_classifier.h"
+#include "core/math/random_pcg.h"
 #include "scene/resources/3d/primitive_meshes.h"
+#include "test_mesh_utils.h"
 
 namespace TestIntersector {
 
+void split_face(const Plane &plane, const SlicerFace &face, Intersector::SplitResult &result) {
+	FaceBuffer faces;
+	TestMeshUtils::push_face(faces, face);
+	Intersector::split_face_by_plane(plane, faces, 0, result);
+}
+
+template <typename T>
+bool same_elements(const LocalVector<T> &p_a, const LocalVector<T> &p_b) {
+	if (p_a.size() != p_b.size()) {
+		return false;
+	}
+	for (uint32_t i = 0; i < p_a.size(); i++) {
+		if (p_a[i] != p_b[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
 TEST_SUITE("[Modules][Slicer][get_side_of]") {
 	// A plane with a normal pointing directly up, 5 units off of the origin
 	Plane plane(Vector3(0, 1, 0), 5);
@@ -55,138 +77,589 @@ TEST_SUITE("[Modules][Slicer][get_side_of]") {
 	}
 }
 
+TEST_SUITE("[Modules][Slicer][get_side_of_aabb]") {
+	AABB box(Vector3(-1, -1, -1), Vector3(2, 2, 2));
+
+	TEST_CASE("Finds boxes under and over the plane") {
+		REQUIRE(Intersector::get_side_of_aabb(Plane(Vector3(0, 1, 0), 2), box) == Intersector::SideOfPlane::UNDER);
+		REQUIRE(Intersector::get_side_of_aabb(Plane(Vector3(0, 1, 0), -2), box) == Intersector::SideOfPlane::OVER);
+		REQUIRE(Intersector::get_side_of_aabb(Plane(Vector3(0, -1, 0), 2), box) == Intersector::SideOfPlane::UNDER);
+	}
+
+	TEST_CASE("Finds boxes reaching the plane") {
+		REQUIRE(Intersector::get_side_of_aabb(Plane(Vector3(0, 1, 0), 0), box) == Intersector::SideOfPlane::ON);
+		// Only the corner at (1, 1, 1) gets near this one
+		Vector3 normal = Vector3(1, 1, 1).normalized();
+		REQUIRE(Intersector::get_side_of_aabb(Plane(normal, normal.dot(Vector3(0.99, 0.99, 0.99))), box) == Intersector::SideOfPlane::ON);
+		REQUIRE(Intersector::get_side_of_aabb(Plane(normal, normal.dot(Vector3(1.01, 1.01, 1.01))), box) == Intersector::SideOfPlane::UNDER);
+		// Touching counts as reaching it
+		REQUIRE(Intersector::get_side_of_aabb(Plane(Vector3(0, 1, 0), 1), box) == Intersector::SideOfPlane::ON);
+	}
+}
+
+TEST_SUITE("[Modules][Slicer][VertexClassifier]") {
+	Plane plane(Vector3(1, 2, -0.5).normalized(), 0.75);
+
+	void check_matches_scalar(const LocalVector<Vector3> &points) {
+		int count = points.size();
+		LocalVector<real_t> distances;
+		LocalVector<Intersector::SideOfPlane> sides;
+		LocalVector<real_t> expected_distances;
+		LocalVector<Intersector::SideOfPlane> expected_sides;
+		distances.resize(count);
+		sides.resize(count);
+		expected_distances.resize(count);
+		expected_sides.resize(count);
+
+		VertexClassifier::classify(plane, points.ptr(), count, distances.ptr(), sides.ptr());
+		VertexClassifier::classify_scalar(plane, points.ptr(), count, expected_distances.ptr(), expected_sides.ptr());
+
+		for (int i = 0; i < count; i++) {
+			CHECK(Math::is_equal_approx(distances[i], expected_distances[i]));
+			CHECK(sides[i] == expected_sides[i]);
+			CHECK(expected_sides[i] == Intersector::get_side_of(plane, points[i]));
+		}
+	}
+
+	TEST_CASE("Matches the scalar path for scattered points") {
+		RandomPCG rng(1234);
+
+		// Deliberately not a multiple of four so the tail gets exercised too
+		LocalVector<Vector3> points;
+		for (int i = 0; i < 1023; i++) {
+			points.push_back(Vector3(rng.random(-10.0f, 10.0f), rng.random(-10.0f, 10.0f), rng.random(-10.0f, 10.0f)));
+		}
+		check_matches_scalar(points);
+	}
+
+	TEST_CASE("Matches the scalar path around the plane") {
+		// Points sitting on the plane and just either side of the epsilon band
+		Vector3 tangent = plane.normal.cross(Vector3(0, 0, 1)).normalized();
+		LocalVector<Vector3> points;
+		real_t offsets[7] = { 0, CMP_EPSILON * 0.5f, -CMP_EPSILON * 0.5f, CMP_EPSILON * 4, -CMP_EPSILON * 4, 1, -1 };
+		for (int i = 0; i < 7; i++) {
+			for (int j = 0; j < 3; j++) {
+				points.push_back(plane.get_center() + tangent * j + plane.normal * offsets[i]);
+			}
+		}
+		check_matches_scalar(points);
+
+		LocalVector<real_t> distances;
+		LocalVector<Intersector::SideOfPlane> sides;
+		distances.resize(points.size());
+		sides.resize(points.size());
+		VertexClassifier::classify(plane, points.ptr(), points.size(), distances.ptr(), sides.ptr());
+		for (int j = 0; j < 3; j++) {
+			CHECK(sides[j] == Intersector::SideOfPlane::ON);
+			CHECK(sides[9 + j] == Intersector::SideOfPlane::OVER);
+			CHECK(sides[12 + j] == Intersector::SideOfPlane::UNDER);
+		}
+	}
+
+	TEST_CASE("Handles fewer points than a single batch") {
+		LocalVector<Vector3> points;
+		points.push_back(Vector3(0, 5, 0));
+		points.push_back(Vector3(0, -5, 0));
+		check_matches_scalar(points);
+	}
+}
+
 TEST_SUITE("[split_face_by_plane]") {
 	Plane plane(Vector3(0, 1, 0), 0);
 
 	TEST_CASE("[Modules][Slicer][SceneTree] Smoke test") {
 		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
-		Vector<SlicerFace> faces = SlicerFace::faces_from_surface(sphere_mesh, 0);
+		FaceBuffer faces = FaceBuffer::faces_from_surface(sphere_mesh, 0);
 		REQUIRE(faces.size() == 4224);
 		Intersector::SplitResult result;
+		result.set_format(faces.format);
 		for (int i = 0; i < faces.size(); i++) {
-			Intersector::split_face_by_plane(plane, faces[i], result);
+			Intersector::split_face_by_plane(plane, faces, i, result);
 		}
 		REQUIRE(result.lower_faces.size() == 2240);
 		REQUIRE(result.upper_faces.size() == 2240);
-		REQUIRE(result.intersection_points.size() == 256);
+		REQUIRE(result.cut_segments.size() == 256);
 	}
 
 	TEST_CASE("[Modules][Slicer] points_all_on_same_side") {
 		Intersector::SplitResult result;
-		Intersector::split_face_by_plane(plane, SlicerFace(Vector3(0, 1, 0), Vector3(1, 2, 0), Vector3(2, 1, 0)), result);
+		split_face(plane, SlicerFace(Vector3(0, 1, 0), Vector3(1, 2, 0), Vector3(2, 1, 0)), result);
 		REQUIRE(result.upper_faces.size() == 1);
 		REQUIRE(result.lower_faces.size() == 0);
-		REQUIRE(result.intersection_points.size() == 0);
+		REQUIRE(result.cut_segments.size() == 0);
 		result.reset();
 
-		Intersector::split_face_by_plane(plane, SlicerFace(Vector3(0, -1, 0), Vector3(1, -2, 0), Vector3(2, -1, 0)), result);
+		split_face(plane, SlicerFace(Vector3(0, -1, 0), Vector3(1, -2, 0), Vector3(2, -1, 0)), result);
 		REQUIRE(result.upper_faces.size() == 0);
 		REQUIRE(result.lower_faces.size() == 1);
-		REQUIRE(result.intersection_points.size() == 0);
+		REQUIRE(result.cut_segments.size() == 0);
 	}
 
 	TEST_CASE("[Modules][Slicer] one_side_is_parallel") {
 		Intersector::SplitResult result;
-		Intersector::split_face_by_plane(plane, SlicerFace(Vector3(0, 0, 0), Vector3(1, 1, 0), Vector3(2, 0, 0)), result);
+		split_face(plane, SlicerFace(Vector3(0, 0, 0), Vector3(1, 1, 0), Vector3(2, 0, 0)), result);
 		REQUIRE(result.upper_faces.size() == 1);
 		REQUIRE(result.lower_faces.size() == 0);
-		REQUIRE(result.intersection_points.size() == 0);
+		REQUIRE(result.cut_segments.size() == 0);
 		result.reset();
 
-		Intersector::split_face_by_plane(plane, SlicerFace(Vector3(0, 0, 0), Vector3(1, -2, 0), Vector3(2, 0, 0)), result);
+		// The face below an edge lying on the plane is the one to add it to the outline,
+		// against its winding
+		split_face(plane, SlicerFace(Vector3(0, 0, 0), Vector3(1, -2, 0), Vector3(2, 0, 0)), result);
 		REQUIRE(result.upper_faces.size() == 0);
 		REQUIRE(result.lower_faces.size() == 1);
-		REQUIRE(result.intersection_points.size() == 0);
+		REQUIRE(result.cut_segments.size() == 2);
+		REQUIRE(result.cut_segments[0] == Vector3(0, 0, 0));
+		REQUIRE(result.cut_segments[1] == Vector3(2, 0, 0));
 	}
 
 	TEST_CASE("[Modules][Slicer] pointed_away") {
 		Intersector::SplitResult result;
-		Intersector::split_face_by_plane(plane, SlicerFace(Vector3(0, 1, 0), Vector3(1, 0, 0), Vector3(2, 1, 0)), result);
+		split_face(plane, SlicerFace(Vector3(0, 1, 0), Vector3(1, 0, 0), Vector3(2, 1, 0)), result);
 		REQUIRE(result.upper_faces.size() == 1);
 		REQUIRE(result.lower_faces.size() == 0);
-		REQUIRE(result.intersection_points.size() == 0);
+		REQUIRE(result.cut_segments.size() == 0);
 		result.reset();
 
-		Intersector::split_face_by_plane(plane, SlicerFace(Vector3(0, -1, 0), Vector3(1, 0, 0), Vector3(2, -1, 0)), result);
+		split_face(plane, SlicerFace(Vector3(0, -1, 0), Vector3(1, 0, 0), Vector3(2, -1, 0)), result);
 		REQUIRE(result.upper_faces.size() == 0);
 		REQUIRE(result.lower_faces.size() == 1);
-		REQUIRE(result.intersection_points.size() == 0);
+		REQUIRE(result.cut_segments.size() == 0);
 	}
 
 	TEST_SUITE("[Modules][Slicer][face_split_in_half]") {
 		TEST_CASE("point a is on plane") {
 			Intersector::SplitResult result;
-			Intersector::split_face_by_plane(plane, SlicerFace(Vector3(0, 0, 0), Vector3(1, 1, 0), Vector3(1, -1, 0)), result);
+			split_face(plane, SlicerFace(Vector3(0, 0, 0), Vector3(1, 1, 0), Vector3(1, -1, 0)), result);
 			REQUIRE(result.upper_faces.size() == 1);
 			REQUIRE(result.lower_faces.size() == 1);
-			REQUIRE(result.intersection_points.size() == 2);
-			REQUIRE(result.intersection_points[0] == Vector3(0, 0, 0));
-			REQUIRE(result.intersection_points[1] == Vector3(1, 0, 0));
-			REQUIRE(result.upper_faces[0] == SlicerFace(Vector3(0, 0, 0), Vector3(1, 1, 0), Vector3(1, 0, 0)));
-			REQUIRE(result.lower_faces[0] == SlicerFace(Vector3(0, 0, 0), Vector3(1, 0, 0), Vector3(1, -1, 0)));
+			REQUIRE(result.cut_segments.size() == 2);
+			REQUIRE(result.cut_segments[0] == Vector3(0, 0, 0));
+			REQUIRE(result.cut_segments[1] == Vector3(1, 0, 0));
+			REQUIRE(result.upper_faces.get_face(0) == SlicerFace(Vector3(0, 0, 0), Vector3(1, 1, 0), Vector3(1, 0, 0)));
+			REQUIRE(result.lower_faces.get_face(0) == SlicerFace(Vector3(0, 0, 0), Vector3(1, 0, 0), Vector3(1, -1, 0)));
 		}
 
 		TEST_CASE("[Modules][Slicer] point b is on plane") {
 			Intersector::SplitResult result;
-			Intersector::split_face_by_plane(plane, SlicerFace(Vector3(0, -1, 0), Vector3(1, 0, 0), Vector3(0, 1, 0)), result);
+			split_face(plane, SlicerFace(Vector3(0, -1, 0), Vector3(1, 0, 0), Vector3(0, 1, 0)), result);
 			REQUIRE(result.upper_faces.size() == 1);
 			REQUIRE(result.lower_faces.size() == 1);
-			REQUIRE(result.intersection_points.size() == 2);
-			REQUIRE(result.intersection_points[0] == Vector3(1, 0, 0));
-			REQUIRE(result.intersection_points[1] == Vector3(0, 0, 0));
-			REQUIRE(result.upper_faces[0] == SlicerFace(Vector3(1, 0, 0), Vector3(0, 1, 0), Vector3(0, 0, 0)));
-			REQUIRE(result.lower_faces[0] == SlicerFace(Vector3(1, 0, 0), Vector3(0, 0, 0), Vector3(0, -1, 0)));
+			REQUIRE(result.cut_segments.size() == 2);
+			REQUIRE(result.cut_segments[0] == Vector3(1, 0, 0));
+			REQUIRE(result.cut_segments[1] == Vector3(0, 0, 0));
+			REQUIRE(result.upper_faces.get_face(0) == SlicerFace(Vector3(1, 0, 0), Vector3(0, 1, 0), Vector3(0, 0, 0)));
+			REQUIRE(result.lower_faces.get_face(0) == SlicerFace(Vector3(1, 0, 0), Vector3(0, 0, 0), Vector3(0, -1, 0)));
 		}
 
 		TEST_CASE("[Modules][Slicer] point c is on plane") {
 			Intersector::SplitResult result;
-			Intersector::split_face_by_plane(plane, SlicerFace(Vector3(0, 1, 0), Vector3(0, -1, 0), Vector3(1, 0, 0)), result);
+			split_face(plane, SlicerFace(Vector3(0, 1, 0), Vector3(0, -1, 0), Vector3(1, 0, 0)), result);
 			REQUIRE(result.upper_faces.size() == 1);
 			REQUIRE(result.lower_faces.size() == 1);
-			REQUIRE(result.intersection_points.size() == 2);
-			REQUIRE(result.intersection_points[0] == Vector3(1, 0, 0));
-			REQUIRE(result.intersection_points[1] == Vector3(0, 0, 0));
-			REQUIRE(result.upper_faces[0] == SlicerFace(Vector3(1, 0, 0), Vector3(0, 1, 0), Vector3(0, 0, 0)));
-			REQUIRE(result.lower_faces[0] == SlicerFace(Vector3(1, 0, 0), Vector3(0, 0, 0), Vector3(0, -1, 0)));
+			REQUIRE(result.cut_segments.size() == 2);
+			REQUIRE(result.cut_segments[0] == Vector3(1, 0, 0));
+			REQUIRE(result.cut_segments[1] == Vector3(0, 0, 0));
+			REQUIRE(result.upper_faces.get_face(0) == SlicerFace(Vector3(1, 0, 0), Vector3(0, 1, 0), Vector3(0, 0, 0)));
+			REQUIRE(result.lower_faces.get_face(0) == SlicerFace(Vector3(1, 0, 0), Vector3(0, 0, 0), Vector3(0, -1, 0)));
+		}
+	}
+
+	TEST_CASE("[Modules][Slicer] point on plane with the other corners swapped") {
+		Intersector::SplitResult result;
+		split_face(plane, SlicerFace(Vector3(0, 0, 0), Vector3(1, -1, 0), Vector3(1, 1, 0)), result);
+		REQUIRE(result.upper_faces.size() == 1);
+		REQUIRE(result.lower_faces.size() == 1);
+		REQUIRE(result.upper_faces.get_face(0) == SlicerFace(Vector3(0, 0, 0), Vector3(1, 0, 0), Vector3(1, 1, 0)));
+		REQUIRE(result.lower_faces.get_face(0) == SlicerFace(Vector3(0, 0, 0), Vector3(1, -1, 0), Vector3(1, 0, 0)));
+	}
+
+	TEST_CASE("[Modules][Slicer] Cut points lerp the attributes of their edge") {
+		FaceBuffer faces;
+		faces.set_format(FaceBuffer::ATTRIBUTE_UV | FaceBuffer::ATTRIBUTE_COLOR);
+		TestMeshUtils::push_face(faces, SlicerFace(Vector3(1, 3, 0), Vector3(2, -1, 0), Vector3(0, -1, 0)));
+		faces.uvs[0] = Vector2(0.5, 1);
+		faces.uvs[1] = Vector2(1, 0);
+		faces.uvs[2] = Vector2(0, 0);
+		faces.colors[0] = Color(1, 0, 0);
+		faces.colors[1] = Color(0, 1, 0);
+		faces.colors[2] = Color(0, 0, 1);
+
+		Intersector::SplitResult result;
+		result.set_format(faces.format);
+		Intersector::split_face_by_plane(plane, faces, 0, result);
+		REQUIRE(result.upper_faces.size() == 1);
+
+		// A quarter of the way down from the top corner towards either bottom corner
+		SlicerFace face = result.upper_faces.get_face(0);
+		REQUIRE(face.vertex[0] == Vector3(1, 3, 0));
+		REQUIRE(face.uv[0] == Vector2(0.5, 1));
+		REQUIRE(face.color[0] == Color(1, 0, 0));
+		REQUIRE(face.vertex[1] == Vector3(1.75, 0, 0));
+		REQUIRE(face.uv[1].is_equal_approx(Vector2(0.875, 0.25)));
+		REQUIRE(face.color[1].is_equal_approx(Color(0.25, 0.75, 0)));
+		REQUIRE(face.vertex[2] == Vector3(0.25, 0, 0));
+		REQUIRE(face.uv[2].is_equal_approx(Vector2(0.125, 0.25)));
+		REQUIRE(face.color[2].is_equal_approx(Color(0.25, 0, 0.75)));
+	}
+
+	TEST_CASE("[Modules][Slicer] Every combination of sides keeps the area and winding") {
+		real_t heights[3] = { 1, -1, 0 };
+		Vector3 corners[3] = { Vector3(0, 0, 0), Vector3(2, 0, 1), Vector3(1, 0, 3) };
+		for (int i = 0; i < 27; i++) {
+			Vector3 a = corners[0] + Vector3(0, heights[i % 3], 0);
+			Vector3 b = corners[1] + Vector3(0, heights[(i / 3) % 3], 0);
+			Vector3 c = corners[2] + Vector3(0, heights[i / 9], 0);
+			Vector3 source_normal = (b - a).cross(c - a);
+
+			Intersector::SplitResult result;
+			split_face(plane, SlicerFace(a, b, c), result);
+
+			Vector3 area_sum;
+			FaceBuffer *halves[2] = { &result.upper_faces, &result.lower_faces };
+			for (int j = 0; j < 2; j++) {
+				for (int k = 0; k < halves[j]->size(); k++) {
+					SlicerFace face = halves[j]->get_face(k);
+					Vector3 normal = (face.vertex[1] - face.vertex[0]).cross(face.vertex[2] - face.vertex[0]);
+					REQUIRE(normal.dot(source_normal) > 0);
+					for (int v = 0; v < 3; v++) {
+						REQUIRE(plane.distance_to(face.vertex[v]) * (j == 0 ? 1 : -1) >= -CMP_EPSILON);
+					}
+					area_sum += normal;
+				}
+			}
+
+			if (i == 26) {
+				// Flat on the plane, it goes to neither half and traces its own edges in
+				// winding order
+				REQUIRE(area_sum == Vector3());
+				REQUIRE(result.cut_segments.size() == 6);
+				for (int e = 0; e < 3; e++) {
+					REQUIRE(result.cut_segments[e * 2] == Vector3(corners[e]));
+					REQUIRE(result.cut_segments[e * 2 + 1] == Vector3(corners[(e + 1) % 3]));
+				}
+			} else {
+				REQUIRE(area_sum.is_equal_approx(source_normal));
+			}
 		}
 	}
 
 	TEST_SUITE("[full_split]") {
 		TEST_CASE("[Modules][Slicer] point a is lone") {
 			Intersector::SplitResult result;
-			Intersector::split_face_by_plane(plane, SlicerFace(Vector3(1, 1, 0), Vector3(2, -1, 0), Vector3(0, -1, 0)), result);
+			split_face(plane, SlicerFace(Vector3(1, 1, 0), Vector3(2, -1, 0), Vector3(0, -1, 0)), result);
 			REQUIRE(result.upper_faces.size() == 1);
 			REQUIRE(result.lower_faces.size() == 2);
-			REQUIRE(result.intersection_points.size() == 2);
-			REQUIRE(result.intersection_points[0] == Vector3(1.5, 0, 0));
-			REQUIRE(result.intersection_points[1] == Vector3(0.5, 0, 0));
-			REQUIRE(result.upper_faces[0] == SlicerFace(Vector3(1, 1, 0), Vector3(1.5, 0, 0), Vector3(0.5, 0, 0)));
-			REQUIRE(result.lower_faces[0] == SlicerFace(Vector3(2, -1, 0), Vector3(0.5, 0, 0), Vector3(1.5, 0, 0)));
-			REQUIRE(result.lower_faces[1] == SlicerFace(Vector3(0, -1, 0), Vector3(0.5, 0, 0), Vector3(2, -1, 0)));
+			REQUIRE(result.cut_segments.size() == 2);
+			REQUIRE(result.cut_segments[0] == Vector3(1.5, 0, 0));
+			REQUIRE(result.cut_segments[1] == Vector3(0.5, 0, 0));
+			REQUIRE(result.upper_faces.get_face(0) == SlicerFace(Vector3(1, 1, 0), Vector3(1.5, 0, 0), Vector3(0.5, 0, 0)));
+			REQUIRE(result.lower_faces.get_face(0) == SlicerFace(Vector3(2, -1, 0), Vector3(0.5, 0, 0), Vector3(1.5, 0, 0)));
+			REQUIRE(result.lower_faces.get_face(1) == SlicerFace(Vector3(0, -1, 0), Vector3(0.5, 0, 0), Vector3(2, -1, 0)));
 		}
 		TEST_CASE("[Modules][Slicer] point b is lone") {
 			Intersector::SplitResult result;
-			Intersector::split_face_by_plane(plane, SlicerFace(Vector3(0, -1, 0), Vector3(1, 1, 0), Vector3(2, -1, 0)), result);
+			split_face(plane, SlicerFace(Vector3(0, -1, 0), Vector3(1, 1, 0), Vector3(2, -1, 0)), result);
 			REQUIRE(result.upper_faces.size() == 1);
 			REQUIRE(result.lower_faces.size() == 2);
-			REQUIRE(result.intersection_points.size() == 2);
-			REQUIRE(result.intersection_points[0] == Vector3(0.5, 0, 0));
-			REQUIRE(result.intersection_points[1] == Vector3(1.5, 0, 0));
-			REQUIRE(result.upper_faces[0] == SlicerFace(Vector3(1, 1, 0), Vector3(1.5, 0, 0), Vector3(0.5, 0, 0)));
-			REQUIRE(result.lower_faces[0] == SlicerFace(Vector3(2, -1, 0), Vector3(0.5, 0, 0), Vector3(1.5, 0, 0)));
-			REQUIRE(result.lower_faces[1] == SlicerFace(Vector3(0, -1, 0), Vector3(0.5, 0, 0), Vector3(2, -1, 0)));
+			REQUIRE(result.cut_segments.size() == 2);
+			REQUIRE(result.cut_segments[0] == Vector3(0.5, 0, 0));
+			REQUIRE(result.cut_segments[1] == Vector3(1.5, 0, 0));
+			REQUIRE(result.upper_faces.get_face(0) == SlicerFace(Vector3(1, 1, 0), Vector3(1.5, 0, 0), Vector3(0.5, 0, 0)));
+			REQUIRE(result.lower_faces.get_face(0) == SlicerFace(Vector3(2, -1, 0), Vector3(0.5, 0, 0), Vector3(1.5, 0, 0)));
+			REQUIRE(result.lower_faces.get_face(1) == SlicerFace(Vector3(0, -1, 0), Vector3(0.5, 0, 0), Vector3(2, -1, 0)));
 		}
 		TEST_CASE("[Modules][Slicer] point c is lone") {
 			Intersector::SplitResult result;
-			Intersector::split_face_by_plane(plane, SlicerFace(Vector3(2, -1, 0), Vector3(0, -1, 0), Vector3(1, 1, 0)), result);
+			split_face(plane, SlicerFace(Vector3(2, -1, 0), Vector3(0, -1, 0), Vector3(1, 1, 0)), result);
 			REQUIRE(result.upper_faces.size() == 1);
 			REQUIRE(result.lower_faces.size() == 2);
-			REQUIRE(result.intersection_points.size() == 2);
-			REQUIRE(result.intersection_points[0] == Vector3(1.5, 0, 0));
-			REQUIRE(result.intersection_points[1] == Vector3(0.5, 0, 0));
-			REQUIRE(result.upper_faces[0] == SlicerFace(Vector3(1, 1, 0), Vector3(1.5, 0, 0), Vector3(0.5, 0, 0)));
-			REQUIRE(result.lower_faces[0] == SlicerFace(Vector3(2, -1, 0), Vector3(0.5, 0, 0), Vector3(1.5, 0, 0)));
-			REQUIRE(result.lower_faces[1] == SlicerFace(Vector3(0, -1, 0), Vector3(0.5, 0, 0), Vector3(2, -1, 0)));
+			REQUIRE(result.cut_segments.size() == 2);
+			REQUIRE(result.cut_segments[0] == Vector3(1.5, 0, 0));
+			REQUIRE(result.cut_segments[1] == Vector3(0.5, 0, 0));
+			REQUIRE(result.upper_faces.get_face(0) == SlicerFace(Vector3(1, 1, 0), Vector3(1.5, 0, 0), Vector3(0.5, 0, 0)));
+			REQUIRE(result.lower_faces.get_face(0) == SlicerFace(Vector3(2, -1, 0), Vector3(0.5, 0, 0), Vector3(1.5, 0, 0)));
+			REQUIRE(result.lower_faces.get_face(1) == SlicerFace(Vector3(0, -1, 0), Vector3(0.5, 0, 0), Vector3(2, -1, 0)));
+		}
+	}
+}
+
+TEST_SUITE("[split_surface_by_plane]") {
+	Plane plane(Vector3(0, 1, 0), 0.1);
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Indexed surfaces split into the same faces") {
+		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
+		FaceBuffer faces = FaceBuffer::faces_from_surface(sphere_mesh, 0);
+		FaceBuffer indexed_faces = FaceBuffer::faces_from_surface(sphere_mesh, 0, true);
+		REQUIRE(indexed_faces.is_indexed());
+		REQUIRE(indexed_faces.size() == faces.size());
+
+		Intersector::SplitResult result;
+		result.set_format(faces.format);
+		Intersector::split_surface_by_plane(plane, faces, result);
+
+		Intersector::SplitResult indexed_result;
+		indexed_result.set_format(indexed_faces.format);
+		Intersector::split_surface_by_plane(plane, indexed_faces, indexed_result);
+
+		REQUIRE(indexed_result.upper_faces.is_indexed());
+		REQUIRE(indexed_result.lower_faces.is_indexed());
+		REQUIRE(indexed_result.upper_faces.size() == result.upper_faces.size());
+		REQUIRE(indexed_result.lower_faces.size() == result.lower_faces.size());
+
+		// Either way every face crossing the plane adds one segment to the outline
+		REQUIRE(indexed_result.cut_segments.size() == result.cut_segments.size());
+		REQUIRE(indexed_result.upper_faces.vertices.size() * 3 < result.upper_faces.vertices.size());
+		REQUIRE(indexed_result.lower_faces.vertices.size() * 3 < result.lower_faces.vertices.size());
+
+		for (int i = 0; i < indexed_result.upper_faces.size(); i++) {
+			for (int j = 0; j < 3; j++) {
+				REQUIRE(indexed_result.upper_faces.vertices[indexed_result.upper_faces.get_vertex_index(i, j)].y >= plane.d - CMP_EPSILON);
+			}
+		}
+
+		for (int i = 0; i < indexed_result.lower_faces.size(); i++) {
+			for (int j = 0; j < 3; j++) {
+				REQUIRE(indexed_result.lower_faces.vertices[indexed_result.lower_faces.get_vertex_index(i, j)].y <= plane.d + CMP_EPSILON);
+			}
+		}
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Large surfaces split the same in parallel") {
+		// Enough faces to be split in chunks on the WorkerThreadPool
+		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
+		sphere_mesh->set_radial_segments(256);
+		sphere_mesh->set_rings(64);
+		FaceBuffer faces = FaceBuffer::faces_from_surface(sphere_mesh, 0);
+		REQUIRE(faces.size() > 32768);
+
+		for (int keep = 0; keep < 3; keep++) {
+			Intersector::SplitResult result;
+			result.set_format(faces.format);
+			result.keep_upper = keep != 1;
+			result.keep_lower = keep != 2;
+			Intersector::split_surface_by_plane(plane, faces, result);
+
+			Intersector::SplitResult control;
+			control.set_format(faces.format);
+			control.keep_upper = result.keep_upper;
+			control.keep_lower = result.keep_lower;
+			for (int i = 0; i < faces.size(); i++) {
+				Intersector::split_face_by_plane(plane, faces, i, control);
+			}
+
+			REQUIRE(result.upper_faces.size() == control.upper_faces.size());
+			REQUIRE(result.lower_faces.size() == control.lower_faces.size());
+			REQUIRE(same_elements(result.upper_faces.vertices, control.upper_faces.vertices));
+			REQUIRE(same_elements(result.lower_faces.vertices, control.lower_faces.vertices));
+			REQUIRE(same_elements(result.upper_faces.uvs, control.upper_faces.uvs));
+			REQUIRE(same_elements(result.lower_faces.normals, control.lower_faces.normals));
+			REQUIRE(result.cut_segments == control.cut_segments);
+		}
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Split scratch is reused but never shared") {
+		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
+		FaceBuffer faces = FaceBuffer::faces_from_surface(sphere_mesh, 0);
+
+		Intersector::SplitScratch *outer = nullptr;
+		{
+			Intersector::SplitScratch::Borrow scratch;
+			outer = scratch.operator->();
+			scratch->distances.resize(1);
+
+			// A split made while the thread's scratch is lent out gets a spare of its own
+			Intersector::SplitResult result;
+			result.set_format(faces.format);
+			Intersector::split_surface_by_plane(plane, faces, result);
+			REQUIRE(scratch->distances.size() == 1);
+		}
+
+		// Once handed back it's lent out again along with everything it grew to hold
+		Intersector::SplitResult warm_result;
+		warm_result.set_format(faces.format);
+		Intersector::split_surface_by_plane(plane, faces, warm_result);
+		Intersector::SplitScratch::Borrow scratch;
+		REQUIRE(scratch.operator->() == outer);
+		{
+			Intersector::SplitScratch::Borrow inner;
+			REQUIRE(inner.operator->() != outer);
+			REQUIRE(inner->distances.size() == faces.vertices.size());
+		}
+
+		Intersector::SplitResult control;
+		control.set_format(faces.format);
+		for (int i = 0; i < faces.size(); i++) {
+			Intersector::split_face_by_plane(plane, faces, i, control);
+		}
+		REQUIRE(same_elements(warm_result.upper_faces.vertices, control.upper_faces.vertices));
+		REQUIRE(same_elements(warm_result.lower_faces.vertices, control.lower_faces.vertices));
+		REQUIRE(warm_result.cut_segments == control.cut_segments);
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] SurfaceSplitter splits the same a batch at a time") {
+		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
+		for (int indexed = 0; indexed < 2; indexed++) {
+			FaceBuffer faces = FaceBuffer::faces_from_surface(sphere_mesh, 0, indexed);
+
+			Intersector::SplitResult control;
+			control.set_format(faces.format);
+			Intersector::split_surface_by_plane(plane, faces, control);
+
+			// Batches that don't divide the surface evenly, rounded up to a multiple of four
+			Intersector::SplitResult result;
+			result.set_format(faces.format);
+			Intersector::SurfaceSplitter splitter(plane, faces, result);
+			int steps = 0;
+			while (splitter.split(37)) {
+				REQUIRE(splitter.get_split_face_count() <= splitter.get_face_count());
+				steps++;
+			}
+			REQUIRE(splitter.is_done());
+			REQUIRE(splitter.get_split_face_count() == faces.size());
+			REQUIRE(steps >= faces.size() / 40);
+
+			REQUIRE(result.upper_faces.size() == control.upper_faces.size());
+			REQUIRE(result.lower_faces.size() == control.lower_faces.size());
+			REQUIRE(same_elements(result.upper_faces.vertices, control.upper_faces.vertices));
+			REQUIRE(same_elements(result.lower_faces.vertices, control.lower_faces.vertices));
+			REQUIRE(same_elements(result.upper_faces.indices, control.upper_faces.indices));
+			REQUIRE(same_elements(result.lower_faces.uvs, control.lower_faces.uvs));
+			REQUIRE(result.cut_segments == control.cut_segments);
+		}
+	}
+
+	TEST_CASE("[Modules][Slicer] Faces sharing a cut edge share its vertex") {
+		// Two faces making up a quad with the diagonal from (0, -1, 0) to (1, 1, 0) crossing the plane
+		FaceBuffer faces;
+		faces.set_format(FaceBuffer::ATTRIBUTE_UV | FaceBuffer::ATTRIBUTE_INDEX);
+		faces.vertices.push_back(Vector3(0, -1, 0));
+		faces.vertices.push_back(Vector3(0, 1, 0));
+		faces.vertices.push_back(Vector3(1, 1, 0));
+		faces.vertices.push_back(Vector3(1, -1, 0));
+		faces.uvs.push_back(Vector2(0, 0));
+		faces.uvs.push_back(Vector2(0, 1));
+		faces.uvs.push_back(Vector2(1, 1));
+		faces.uvs.push_back(Vector2(1, 0));
+		int indices[6] = { 0, 1, 2, 0, 2, 3 };
+		for (int i = 0; i < 6; i++) {
+			faces.indices.push_back(indices[i]);
+		}
+
+		Intersector::SplitResult result;
+		result.set_format(faces.format);
+		Intersector::split_surface_by_plane(Plane(Vector3(0, 1, 0), 0), faces, result);
+
+		REQUIRE(result.upper_faces.size() == 3);
+		REQUIRE(result.lower_faces.size() == 3);
+
+		// One segment per face, meeting at the cut through the shared diagonal
+		REQUIRE(result.cut_segments.size() == 4);
+		REQUIRE(result.cut_segments[0] == Vector3(0, 0, 0));
+		REQUIRE(result.cut_segments[1] == Vector3(0.5, 0, 0));
+		REQUIRE(result.cut_segments[2] == Vector3(0.5, 0, 0));
+		REQUIRE(result.cut_segments[3] == Vector3(1, 0, 0));
+
+		// The two upper corners plus the three cut points
+		REQUIRE(result.upper_faces.vertices.size() == 5);
+		REQUIRE(result.lower_faces.vertices.size() == 5);
+
+		SlicerFace face = result.upper_faces.get_face(0);
+		REQUIRE(face.vertex[0] == Vector3(0, 0, 0));
+		REQUIRE(face.vertex[1] == Vector3(0, 1, 0));
+		REQUIRE(face.vertex[2] == Vector3(1, 1, 0));
+		REQUIRE(face.uv[0] == Vector2(0, 0.5));
+
+		face = result.lower_faces.get_face(0);
+		REQUIRE(face.vertex[0] == Vector3(0, -1, 0));
+		REQUIRE(face.vertex[1] == Vector3(0, 0, 0));
+		REQUIRE(face.vertex[2] == Vector3(0.5, 0, 0));
+		REQUIRE(face.uv[2] == Vector2(0.5, 0.5));
+	}
+}
+
+TEST_SUITE("[split_surface_by_convex]") {
+	// A box of half size 0.2 poking out of the side of the unit sphere
+	Vector<Plane> get_box_planes(const Vector3 &center) {
+		Vector<Plane> planes;
+		for (int axis = 0; axis < 3; axis++) {
+			Vector3 normal;
+			normal[axis] = 1;
+			planes.push_back(Plane(normal, normal.dot(center) + 0.2));
+			planes.push_back(Plane(-normal, -normal.dot(center) + 0.2));
+		}
+		return planes;
+	}
+
+	Vector3 get_area_vector(const FaceBuffer &faces) {
+		Vector3 area;
+		for (int i = 0; i < faces.size(); i++) {
+			SlicerFace face = faces.get_face(i);
+			area += (face.vertex[1] - face.vertex[0]).cross(face.vertex[2] - face.vertex[0]);
+		}
+		return area;
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Keeps inside and outside apart") {
+		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
+		FaceBuffer faces = FaceBuffer::faces_from_surface(sphere_mesh, 0);
+		Vector<Plane> planes = get_box_planes(Vector3(0.4, 0, 0));
+
+		Intersector::SplitResult result;
+		result.set_format(faces.format);
+		LocalVector<Vector<Vector3>> plane_segments;
+		Intersector::split_surface_by_convex(planes, faces, result, plane_segments);
+		REQUIRE(result.lower_faces.size() > 0);
+		REQUIRE(result.upper_faces.size() > 0);
+		REQUIRE(plane_segments.size() == 6);
+
+		// Every plane but the one past the far side of the sphere crosses it
+		REQUIRE(plane_segments[0].size() == 0);
+		for (int i = 1; i < 6; i++) {
+			REQUIRE(plane_segments[i].size() > 0);
+		}
+
+		for (uint32_t i = 0; i < result.lower_faces.vertices.size(); i++) {
+			for (int j = 0; j < planes.size(); j++) {
+				REQUIRE(planes[j].distance_to(result.lower_faces.vertices[i]) <= CMP_EPSILON);
+			}
+		}
+
+		for (int i = 0; i < result.upper_faces.size(); i++) {
+			SlicerFace face = result.upper_faces.get_face(i);
+			Vector3 center = (face.vertex[0] + face.vertex[1] + face.vertex[2]) / 3;
+			bool outside = false;
+			for (int j = 0; j < planes.size(); j++) {
+				outside |= planes[j].distance_to(center) >= -CMP_EPSILON;
+			}
+			REQUIRE(outside);
+		}
+
+		Vector3 area = get_area_vector(result.upper_faces) + get_area_vector(result.lower_faces);
+		REQUIRE(area.distance_to(get_area_vector(faces)) < 0.0001);
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] A single plane splits like split_surface_by_plane") {
+		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
+		FaceBuffer faces = FaceBuffer::faces_from_surface(sphere_mesh, 0);
+		Plane plane(Vector3(1, 1, 0).normalized(), 0.1);
+
+		Intersector::SplitResult control;
+		control.set_format(faces.format);
+		Intersector::split_surface_by_plane(plane, faces, control);
+
+		Intersector::SplitResult result;
+		result.set_format(faces.format);
+		LocalVector<Vector<Vector3>> plane_segments;
+		Vector<Plane> planes;
+		planes.push_back(plane);
+		Intersector::split_surface_by_convex(planes, faces, result, plane_segments);
+
+		REQUIRE(result.upper_faces.size() == control.upper_faces.size());
+		REQUIRE(result.lower_faces.size() == control.lower_faces.size());
+		REQUIRE(plane_segments[0].size() == control.cut_segments.size());
+		for (int i = 0; i < control.cut_segments.size(); i++) {
+			REQUIRE(plane_segments[0][i] == control.cut_segments[i]);
 		}
 	}
 }
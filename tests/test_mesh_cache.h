@@ -0,0 +1,213 @@
+/**************************************************************************/
+/*  test_mesh_cache.h                                                     */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef TEST_MESH_CACHE_H
+#define TEST_MESH_CACHE_H
+
+#include "tests/test_macros.h"
+
+#include "../slicer.h"
+#include "../utils/mesh_cache.h"
+#include "scene/resources/3d/primitive_meshes.h"
+
+namespace TestMeshCache {
+
+TEST_SUITE("[MeshCache]") {
+	TEST_CASE("[Modules][Slicer][SceneTree] Reuses parsed meshes") {
+		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
+		MeshCache *cache = memnew(MeshCache);
+
+		Ref<ParsedMesh> parsed = cache->get_parsed_mesh(sphere_mesh);
+		REQUIRE(parsed.is_valid());
+		REQUIRE(cache->has_mesh(sphere_mesh));
+		REQUIRE(cache->get_entry_count() == 1);
+		REQUIRE(cache->get_memory_usage() == parsed->get_memory_usage());
+		REQUIRE(cache->get_parsed_mesh(sphere_mesh) == parsed);
+
+		// A different parse of the same mesh replaces the old one
+		Ref<ParsedMesh> indexed = cache->get_parsed_mesh(sphere_mesh, true);
+		REQUIRE(indexed != parsed);
+		REQUIRE(indexed->surfaces[0].faces.is_indexed());
+		REQUIRE(cache->get_entry_count() == 1);
+
+		memdelete(cache);
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Drops meshes when they change") {
+		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
+		MeshCache *cache = memnew(MeshCache);
+
+		Ref<ParsedMesh> parsed = cache->get_parsed_mesh(sphere_mesh);
+		sphere_mesh->set_height(4);
+		REQUIRE_FALSE(cache->has_mesh(sphere_mesh));
+		REQUIRE(cache->get_memory_usage() == 0);
+
+		Ref<ParsedMesh> reparsed = cache->get_parsed_mesh(sphere_mesh);
+		REQUIRE(reparsed != parsed);
+		REQUIRE(reparsed->surfaces[0].faces.vertices[0] != parsed->surfaces[0].faces.vertices[0]);
+
+		memdelete(cache);
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Evicts the least recently used meshes") {
+		Ref<SphereMesh> mesh_a = memnew(SphereMesh);
+		Ref<SphereMesh> mesh_b = memnew(SphereMesh);
+		Ref<SphereMesh> mesh_c = memnew(SphereMesh);
+		MeshCache *cache = memnew(MeshCache);
+
+		uint64_t mesh_size = ParsedMesh::parse(mesh_a)->get_memory_usage();
+		cache->set_memory_limit(mesh_size * 2);
+
+		cache->get_parsed_mesh(mesh_a);
+		cache->get_parsed_mesh(mesh_b);
+		cache->get_parsed_mesh(mesh_a);
+		cache->get_parsed_mesh(mesh_c);
+
+		REQUIRE(cache->get_entry_count() == 2);
+		REQUIRE(cache->has_mesh(mesh_a));
+		REQUIRE_FALSE(cache->has_mesh(mesh_b));
+		REQUIRE(cache->has_mesh(mesh_c));
+		REQUIRE(cache->get_memory_usage() == mesh_size * 2);
+
+		// Meshes which could never fit aren't cached at all
+		cache->set_memory_limit(mesh_size - 1);
+		REQUIRE(cache->get_entry_count() == 0);
+		REQUIRE(cache->get_parsed_mesh(mesh_b).is_valid());
+		REQUIRE(cache->get_entry_count() == 0);
+		cache->add_parsed_mesh(mesh_b, ParsedMesh::parse(mesh_b));
+		REQUIRE(cache->get_entry_count() == 0);
+		REQUIRE(cache->get_memory_usage() == 0);
+
+		memdelete(cache);
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Builds a missing tree over the cached faces") {
+		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
+		MeshCache *cache = memnew(MeshCache);
+
+		Ref<ParsedMesh> parsed = cache->get_parsed_mesh(sphere_mesh);
+		Ref<ParsedMesh> with_bvh = cache->get_parsed_mesh(sphere_mesh, false, true);
+		REQUIRE(with_bvh != parsed);
+		REQUIRE(with_bvh->has_bvh);
+		REQUIRE(with_bvh->surfaces[0].faces.size() == parsed->surfaces[0].faces.size());
+		REQUIRE(cache->get_entry_count() == 1);
+
+		// The entry it replaced is left alone, someone else may still be slicing with it
+		REQUIRE_FALSE(parsed->has_bvh);
+		REQUIRE(cache->get_parsed_mesh(sphere_mesh) == with_bvh);
+
+		memdelete(cache);
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Caches meshes parsed elsewhere") {
+		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
+		MeshCache *cache = memnew(MeshCache);
+
+		Ref<ParsedMesh> parsed = ParsedMesh::parse(sphere_mesh);
+		cache->add_parsed_mesh(sphere_mesh, parsed);
+		REQUIRE(cache->has_mesh(sphere_mesh));
+		REQUIRE(cache->get_memory_usage() == parsed->get_memory_usage());
+		REQUIRE(cache->get_parsed_mesh(sphere_mesh) == parsed);
+
+		sphere_mesh->set_height(4);
+		REQUIRE_FALSE(cache->has_mesh(sphere_mesh));
+
+		memdelete(cache);
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Slicing a half again reuses its faces") {
+		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
+		Plane plane(Vector3(1, 0, 0), 0);
+		Plane second_plane(Vector3(0, 1, 0), 0.1);
+
+		Slicer slicer;
+		slicer.set_use_mesh_cache(true);
+		Ref<SlicedMesh> sliced = slicer.slice_by_plane(sphere_mesh, plane, NULL);
+		REQUIRE(sliced->upper_parsed.is_null());
+		REQUIRE_FALSE(slicer.get_mesh_cache()->has_mesh(sliced->get_upper_mesh()));
+
+		slicer.set_keep_sliced_faces(true);
+		sliced = slicer.slice_by_plane(sphere_mesh, plane, NULL);
+		REQUIRE(sliced->upper_parsed.is_valid());
+		REQUIRE(sliced->upper_parsed->surfaces.size() == (uint32_t)sliced->get_upper_mesh()->get_surface_count());
+		REQUIRE(sliced->lower_parsed->surfaces.size() == (uint32_t)sliced->get_lower_mesh()->get_surface_count());
+		REQUIRE(slicer.get_mesh_cache()->get_parsed_mesh(sliced->get_upper_mesh()) == sliced->upper_parsed);
+		REQUIRE(slicer.get_mesh_cache()->get_parsed_mesh(sliced->get_lower_mesh()) == sliced->lower_parsed);
+
+		// Each kept surface matches what reading the half back in would give
+		Ref<ParsedMesh> reparsed = ParsedMesh::parse(sliced->get_upper_mesh());
+		for (uint32_t i = 0; i < reparsed->surfaces.size(); i++) {
+			const FaceBuffer &kept = sliced->upper_parsed->surfaces[i].faces;
+			const FaceBuffer &faces = reparsed->surfaces[i].faces;
+			REQUIRE(kept.size() == faces.size());
+			for (int j = 0; j < faces.size(); j++) {
+				REQUIRE(kept.get_face(j).vertex[0].is_equal_approx(faces.get_face(j).vertex[0]));
+				REQUIRE(kept.get_face(j).vertex[1].is_equal_approx(faces.get_face(j).vertex[1]));
+			}
+		}
+
+		Ref<SlicedMesh> resliced = slicer.slice_by_plane(sliced->get_upper_mesh(), second_plane, NULL);
+		Slicer control_slicer;
+		Ref<SlicedMesh> control = control_slicer.slice_by_plane(sliced->get_upper_mesh(), second_plane, NULL);
+		REQUIRE(resliced.is_valid());
+		REQUIRE(resliced->get_upper_mesh()->get_surface_count() == control->get_upper_mesh()->get_surface_count());
+		for (int i = 0; i < control->get_upper_mesh()->get_surface_count(); i++) {
+			REQUIRE(resliced->get_upper_mesh()->surface_get_array_len(i) == control->get_upper_mesh()->surface_get_array_len(i));
+			REQUIRE(resliced->get_lower_mesh()->surface_get_array_len(i) == control->get_lower_mesh()->surface_get_array_len(i));
+		}
+
+		// Replacing a half drops the faces kept for it
+		sliced->set_upper_mesh(sphere_mesh);
+		REQUIRE(sliced->upper_parsed.is_null());
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Slicer uses the cache when enabled") {
+		Ref<SphereMesh> sphere_mesh = memnew(SphereMesh);
+		Plane plane(Vector3(1, 0, 0), 0);
+		Slicer slicer;
+
+		Ref<SlicedMesh> uncached = slicer.slice_by_plane(sphere_mesh, plane, NULL);
+		REQUIRE_FALSE(slicer.get_mesh_cache()->has_mesh(sphere_mesh));
+
+		slicer.set_use_mesh_cache(true);
+		Ref<SlicedMesh> first = slicer.slice_by_plane(sphere_mesh, plane, NULL);
+		REQUIRE(slicer.get_mesh_cache()->has_mesh(sphere_mesh));
+		Ref<SlicedMesh> second = slicer.slice_by_plane(sphere_mesh, plane, NULL);
+
+		REQUIRE(second->get_upper_mesh()->surface_get_array_len(0) == uncached->get_upper_mesh()->surface_get_array_len(0));
+		REQUIRE(second->get_lower_mesh()->surface_get_array_len(0) == first->get_lower_mesh()->surface_get_array_len(0));
+
+		slicer.set_use_mesh_cache(false);
+		REQUIRE_FALSE(slicer.get_mesh_cache()->has_mesh(sphere_mesh));
+	}
+}
+} //namespace TestMeshCache
+
+#endif // TEST_MESH_CACHE_H
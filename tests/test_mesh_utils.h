@@ -0,0 +1,95 @@
+/**************************************************************************/
+/*  test_mesh_utils.h                                                     */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef TEST_MESH_UTILS_H
+#define TEST_MESH_UTILS_H
+
+#include "../utils/face_buffer.h"
+#include "scene/resources/mesh.h"
+
+namespace TestMeshUtils {
+
+/**
+ * Whether both meshes have the exact same faces, in the same order
+ */
+static bool same_faces(const Ref<Mesh> &p_mesh, const Ref<Mesh> &p_control) {
+	Vector<Face3> faces = p_mesh->get_faces();
+	Vector<Face3> control_faces = p_control->get_faces();
+	if (faces.size() != control_faces.size()) {
+		return false;
+	}
+	for (int i = 0; i < faces.size(); i++) {
+		for (int j = 0; j < 3; j++) {
+			if (faces[i].vertex[j] != control_faces[i].vertex[j]) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * Appends a face given in its AoS form, only keeping the attributes the buffer's format
+ * carries
+ */
+static void push_face(FaceBuffer &r_faces, const SlicerFace &p_face) {
+	for (int i = 0; i < 3; i++) {
+		if (r_faces.is_indexed()) {
+			r_faces.indices.push_back(r_faces.vertices.size());
+		}
+
+		r_faces.vertices.push_back(p_face.vertex[i]);
+		if (r_faces.has(FaceBuffer::ATTRIBUTE_NORMAL)) {
+			r_faces.normals.push_back(p_face.normal[i]);
+		}
+		if (r_faces.has(FaceBuffer::ATTRIBUTE_TANGENT)) {
+			r_faces.tangents.push_back(p_face.tangent[i]);
+		}
+		if (r_faces.has(FaceBuffer::ATTRIBUTE_COLOR)) {
+			r_faces.colors.push_back(p_face.color[i]);
+		}
+		if (r_faces.has(FaceBuffer::ATTRIBUTE_BONES)) {
+			r_faces.bones.push_back(p_face.bones[i]);
+		}
+		if (r_faces.has(FaceBuffer::ATTRIBUTE_WEIGHTS)) {
+			r_faces.weights.push_back(p_face.weights[i]);
+		}
+		if (r_faces.has(FaceBuffer::ATTRIBUTE_UV)) {
+			r_faces.uvs.push_back(p_face.uv[i]);
+		}
+		if (r_faces.has(FaceBuffer::ATTRIBUTE_UV2)) {
+			r_faces.uv2s.push_back(p_face.uv2[i]);
+		}
+	}
+}
+
+} //namespace TestMeshUtils
+
+#endif // TEST_MESH_UTILS_H
@@ -0,0 +1,120 @@
+/**************************************************************************/
+/*  test_slice_engine.h                                                   */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef TEST_SLICE_ENGINE_H
+#define TEST_SLICE_ENGINE_H
+
+#include "tests/test_macros.h"
+
+#include "../slice_engine.h"
+#include "core/object/worker_thread_pool.h"
+#include "scene/resources/3d/primitive_meshes.h"
+#include "test_mesh_utils.h"
+
+namespace TestSliceEngine {
+
+/**
+ * Slices the same mesh with a single engine from every thread of the pool at once, each
+ * by its own plane
+ */
+struct ConcurrentSlices {
+	Ref<SliceEngine> engine;
+	Ref<Mesh> mesh;
+	LocalVector<Plane> planes;
+	LocalVector<Ref<SlicedMesh>> results;
+
+	void slice(uint32_t p_index, void *p_userdata) {
+		results[p_index] = engine->slice_by_plane(mesh, planes[p_index], Ref<Material>());
+		// Build the halves on the same thread as well
+		results[p_index]->get_upper_mesh();
+		results[p_index]->get_lower_mesh();
+	}
+};
+
+TEST_SUITE("[SliceEngine]") {
+	TEST_CASE("[Modules][Slicer][SceneTree] Slices concurrently from many threads") {
+		Ref<SphereMesh> sphere_mesh;
+		sphere_mesh.instantiate();
+
+		for (int cached = 0; cached < 2; cached++) {
+			ConcurrentSlices slices;
+			slices.engine.instantiate();
+			slices.engine->set_use_mesh_cache(cached);
+			slices.engine->set_use_bvh(cached);
+			slices.mesh = sphere_mesh;
+			for (int i = 0; i < 32; i++) {
+				real_t angle = Math_TAU * i / 32;
+				slices.planes.push_back(Plane(Vector3(Math::cos(angle), Math::sin(angle), 0), (i % 5) * 0.1));
+			}
+			slices.results.resize(slices.planes.size());
+
+			WorkerThreadPool::GroupID group_id = WorkerThreadPool::get_singleton()->add_template_group_task(&slices, &ConcurrentSlices::slice, (void *)nullptr, slices.planes.size(), -1, false, "Slicer concurrent slices");
+			WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_id);
+
+			// Every slice comes out the same as it would have on its own, on a fresh engine
+			Ref<SliceEngine> control_engine;
+			control_engine.instantiate();
+			control_engine->set_use_mesh_cache(cached);
+			control_engine->set_use_bvh(cached);
+			for (uint32_t i = 0; i < slices.planes.size(); i++) {
+				Ref<SlicedMesh> control = control_engine->slice_by_plane(sphere_mesh, slices.planes[i], Ref<Material>());
+				REQUIRE(slices.results[i].is_valid());
+				REQUIRE(TestMeshUtils::same_faces(slices.results[i]->get_upper_mesh(), control->get_upper_mesh()));
+				REQUIRE(TestMeshUtils::same_faces(slices.results[i]->get_lower_mesh(), control->get_lower_mesh()));
+			}
+			REQUIRE(slices.engine->get_mesh_cache()->get_entry_count() == cached);
+		}
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Each slice keeps the settings it started with") {
+		Ref<SphereMesh> sphere_mesh;
+		sphere_mesh.instantiate();
+		Ref<SliceEngine> engine;
+		engine.instantiate();
+		engine->set_halves(SliceEngine::HALVES_LOWER);
+
+		SliceEngine::Settings settings = engine->get_settings();
+		engine->set_halves(SliceEngine::HALVES_UPPER);
+		engine->set_preserve_indices(true);
+
+		Ref<SlicedMesh> sliced_mesh = SliceEngine::slice_by_plane_with(settings, sphere_mesh, Plane(Vector3(1, 0, 0), 0), Ref<Material>());
+		REQUIRE_FALSE(sliced_mesh->has_upper_mesh());
+		REQUIRE(sliced_mesh->has_lower_mesh());
+		REQUIRE_FALSE(sliced_mesh->get_lower_mesh()->surface_get_format(0) & Mesh::ARRAY_FORMAT_INDEX);
+
+		sliced_mesh = engine->slice_by_plane(sphere_mesh, Plane(Vector3(1, 0, 0), 0), Ref<Material>());
+		REQUIRE(sliced_mesh->has_upper_mesh());
+		REQUIRE_FALSE(sliced_mesh->has_lower_mesh());
+		REQUIRE(sliced_mesh->get_upper_mesh()->surface_get_format(0) & Mesh::ARRAY_FORMAT_INDEX);
+	}
+}
+} //namespace TestSliceEngine
+
+#endif // TEST_SLICE_ENGINE_H
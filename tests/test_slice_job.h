@@ -0,0 +1,133 @@
+/**************************************************************************/
+/*  test_slice_job.h                                                      */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef TEST_SLICE_JOB_H
+#define TEST_SLICE_JOB_H
+
+#include "tests/test_macros.h"
+
+#include "../slice_engine.h"
+#include "../slice_job.h"
+#include "scene/resources/3d/primitive_meshes.h"
+#include "test_mesh_utils.h"
+
+namespace TestSliceJob {
+
+TEST_SUITE("[SliceJob]") {
+	TEST_CASE("[Modules][Slicer][SceneTree] Stepping a job slices the same as slice_by_plane") {
+		Ref<SphereMesh> sphere_mesh;
+		sphere_mesh.instantiate();
+		Plane plane(Vector3(1, 1, 0).normalized(), 0.2);
+
+		for (int settings = 0; settings < 4; settings++) {
+			Ref<SliceEngine> engine;
+			engine.instantiate();
+			engine->set_preserve_indices(settings == 1);
+			engine->set_use_mesh_cache(settings == 2);
+			engine->set_keep_sliced_faces(settings == 2);
+			engine->set_halves(settings == 3 ? SliceEngine::HALVES_LOWER : SliceEngine::HALVES_BOTH);
+
+			Ref<SliceJob> job = engine->create_slice_job(sphere_mesh, plane, Ref<Material>());
+			job->set_batch_size(64);
+			REQUIRE(job->get_phase() == SliceJob::PHASE_PARSE);
+			REQUIRE(job->get_progress() == 0);
+			REQUIRE(job->get_sliced_mesh().is_null());
+
+			// Without a budget each step does a single piece of work, and neither the
+			// phase nor the progress ever go back
+			int steps = 0;
+			float progress = 0;
+			SliceJob::Phase phase = SliceJob::PHASE_PARSE;
+			while (job->step()) {
+				REQUIRE(job->get_progress() >= progress);
+				REQUIRE(job->get_phase() >= phase);
+				progress = job->get_progress();
+				phase = job->get_phase();
+				steps++;
+			}
+			REQUIRE(steps > sphere_mesh->get_faces().size() / 64 / 2);
+			REQUIRE(job->is_done());
+			REQUIRE(job->get_phase() == SliceJob::PHASE_DONE);
+			REQUIRE(job->get_progress() == 1);
+			REQUIRE_FALSE(job->step());
+
+			Ref<SlicedMesh> sliced_mesh = job->get_sliced_mesh();
+			Ref<SlicedMesh> control = engine->slice_by_plane(sphere_mesh, plane, Ref<Material>());
+			REQUIRE(sliced_mesh.is_valid());
+			REQUIRE(sliced_mesh->has_upper_mesh() == control->has_upper_mesh());
+			REQUIRE(sliced_mesh->has_lower_mesh() == control->has_lower_mesh());
+			if (control->has_upper_mesh()) {
+				REQUIRE(TestMeshUtils::same_faces(sliced_mesh->get_upper_mesh(), control->get_upper_mesh()));
+			}
+			REQUIRE(TestMeshUtils::same_faces(sliced_mesh->get_lower_mesh(), control->get_lower_mesh()));
+		}
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] A big enough budget finishes the job in one step") {
+		Ref<SphereMesh> sphere_mesh;
+		sphere_mesh.instantiate();
+		Ref<SliceEngine> engine;
+		engine.instantiate();
+
+		Ref<SliceJob> job = engine->create_slice_job(sphere_mesh, Plane(Vector3(0, 1, 0), 0), Ref<Material>());
+		job->set_batch_size(16);
+		REQUIRE_FALSE(job->step(60000000));
+		REQUIRE(job->get_sliced_mesh().is_valid());
+		REQUIRE(job->get_sliced_mesh()->get_upper_mesh().is_valid());
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Jobs that miss the mesh or get canceled have no result") {
+		Ref<SphereMesh> sphere_mesh;
+		sphere_mesh.instantiate();
+		Ref<SliceEngine> engine;
+		engine.instantiate();
+
+		Ref<SliceJob> missed = engine->create_slice_job(sphere_mesh, Plane(Vector3(0, 1, 0), 10), Ref<Material>());
+		REQUIRE_FALSE(missed->step());
+		REQUIRE(missed->get_phase() == SliceJob::PHASE_DONE);
+		REQUIRE(missed->get_progress() == 1);
+		REQUIRE(missed->get_sliced_mesh().is_null());
+
+		Ref<SliceJob> canceled = engine->create_slice_job(sphere_mesh, Plane(Vector3(0, 1, 0), 0), Ref<Material>());
+		canceled->set_batch_size(16);
+		while (canceled->get_phase() != SliceJob::PHASE_SPLIT) {
+			REQUIRE(canceled->step());
+		}
+		REQUIRE(canceled->step());
+		canceled->cancel();
+		REQUIRE(canceled->is_done());
+		REQUIRE(canceled->get_phase() == SliceJob::PHASE_CANCELED);
+		REQUIRE_FALSE(canceled->step());
+		REQUIRE(canceled->get_sliced_mesh().is_null());
+	}
+}
+} //namespace TestSliceJob
+
+#endif // TEST_SLICE_JOB_H
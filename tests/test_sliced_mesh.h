@@ -35,6 +35,7 @@
 
 #include "../sliced_mesh.h"
 #include "scene/resources/material.h"
+#include "test_mesh_utils.h"
 
 namespace TestSlicedMesh {
 
@@ -43,32 +44,79 @@ TEST_SUITE("[SlicedMesh]") {
 		Intersector::SplitResult result;
 		Vector<Intersector::SplitResult> results;
 		result.material = Ref<StandardMaterial3D>();
-		result.lower_faces.push_back(SlicerFace(Vector3(0, 0, 0), Vector3(0, 1, 0), Vector3(0, 1, 1)));
-		result.lower_faces.push_back(SlicerFace(Vector3(0, 1, 1), Vector3(0, 0, 1), Vector3(0, 0, 0)));
+		result.set_format(0);
+		TestMeshUtils::push_face(result.lower_faces, SlicerFace(Vector3(0, 0, 0), Vector3(0, 1, 0), Vector3(0, 1, 1)));
+		TestMeshUtils::push_face(result.lower_faces, SlicerFace(Vector3(0, 1, 1), Vector3(0, 0, 1), Vector3(0, 0, 0)));
 
-		result.upper_faces.push_back(SlicerFace(Vector3(0, 1, 0), Vector3(0, 2, 0), Vector3(0, 2, 1)));
-		result.upper_faces.push_back(SlicerFace(Vector3(0, 2, 1), Vector3(0, 1, 1), Vector3(0, 1, 0)));
+		TestMeshUtils::push_face(result.upper_faces, SlicerFace(Vector3(0, 1, 0), Vector3(0, 2, 0), Vector3(0, 2, 1)));
+		TestMeshUtils::push_face(result.upper_faces, SlicerFace(Vector3(0, 2, 1), Vector3(0, 1, 1), Vector3(0, 1, 0)));
 
 		results.push_back(result);
 
-		Vector<SlicerFace> cross_section_faces;
+		FaceBuffer cross_section_faces;
 		Ref<StandardMaterial3D> cross_section_material;
 		cross_section_material.instantiate();
-		cross_section_faces.push_back(SlicerFace(Vector3(0, 1, 0), Vector3(1, 1, 0), Vector3(0, 1, 1)));
+		TestMeshUtils::push_face(cross_section_faces, SlicerFace(Vector3(0, 1, 0), Vector3(1, 1, 0), Vector3(0, 1, 1)));
 
 		Ref<SlicedMesh> sliced = memnew(SlicedMesh);
 		sliced->create_mesh(results, cross_section_faces, cross_section_material);
-		REQUIRE_FALSE(sliced->lower_mesh.is_null());
-		REQUIRE_FALSE(sliced->upper_mesh.is_null());
+		REQUIRE_FALSE(sliced->get_lower_mesh().is_null());
+		REQUIRE_FALSE(sliced->get_upper_mesh().is_null());
 
-		REQUIRE(sliced->lower_mesh->get_surface_count() == 2);
-		REQUIRE(sliced->upper_mesh->get_surface_count() == 2);
+		REQUIRE(sliced->get_lower_mesh()->get_surface_count() == 2);
+		REQUIRE(sliced->get_upper_mesh()->get_surface_count() == 2);
 
-		REQUIRE(sliced->lower_mesh->surface_get_material(0) == result.material);
-		REQUIRE(sliced->lower_mesh->surface_get_material(1) == cross_section_material);
+		REQUIRE(sliced->get_lower_mesh()->surface_get_material(0) == result.material);
+		REQUIRE(sliced->get_lower_mesh()->surface_get_material(1) == cross_section_material);
 
-		REQUIRE(sliced->upper_mesh->surface_get_material(0) == result.material);
-		REQUIRE(sliced->upper_mesh->surface_get_material(1) == cross_section_material);
+		REQUIRE(sliced->get_upper_mesh()->surface_get_material(0) == result.material);
+		REQUIRE(sliced->get_upper_mesh()->surface_get_material(1) == cross_section_material);
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Builds large halves in order across threads") {
+		// Enough faces that the surfaces get encoded on the worker threads
+		Intersector::SplitResult first;
+		Intersector::SplitResult second;
+		first.set_format(0);
+		second.set_format(0);
+		for (int i = 0; i < 4000; i++) {
+			real_t x = i;
+			TestMeshUtils::push_face(first.lower_faces, SlicerFace(Vector3(x, 0, 0), Vector3(x, -1, 0), Vector3(x, -1, 1)));
+			TestMeshUtils::push_face(first.upper_faces, SlicerFace(Vector3(x, 0, 0), Vector3(x, 1, 0), Vector3(x, 1, 1)));
+			TestMeshUtils::push_face(second.lower_faces, SlicerFace(Vector3(x, 0, 2), Vector3(x, -2, 2), Vector3(x, -2, 3)));
+			TestMeshUtils::push_face(second.upper_faces, SlicerFace(Vector3(x, 0, 2), Vector3(x, 2, 2), Vector3(x, 2, 3)));
+		}
+
+		Vector<Intersector::SplitResult> results;
+		results.push_back(first);
+		results.push_back(second);
+
+		FaceBuffer cross_section_faces;
+		TestMeshUtils::push_face(cross_section_faces, SlicerFace(Vector3(0, 0, 0), Vector3(1, 0, 0), Vector3(0, 0, 1)));
+
+		Ref<SlicedMesh> sliced = memnew(SlicedMesh);
+		sliced->create_mesh(results, cross_section_faces, Ref<Material>());
+
+		Ref<Mesh> halves[2] = { sliced->get_upper_mesh(), sliced->get_lower_mesh() };
+		for (int i = 0; i < 2; i++) {
+			REQUIRE(halves[i]->get_surface_count() == 3);
+			for (int j = 0; j < 2; j++) {
+				const FaceBuffer &faces = i == 0 ? results[j].upper_faces : results[j].lower_faces;
+				Vector<Vector3> vertices = halves[i]->surface_get_arrays(j)[Mesh::ARRAY_VERTEX];
+				REQUIRE(vertices.size() == faces.vertices.size());
+				bool matches = true;
+				for (int k = 0; k < vertices.size(); k++) {
+					matches = matches && vertices[k].is_equal_approx(faces.vertices[k]);
+				}
+				REQUIRE(matches);
+			}
+		}
+
+		// Only the upper half's cross section is wound the other way round
+		Vector<Vector3> upper_cap = halves[0]->surface_get_arrays(2)[Mesh::ARRAY_VERTEX];
+		Vector<Vector3> lower_cap = halves[1]->surface_get_arrays(2)[Mesh::ARRAY_VERTEX];
+		REQUIRE(lower_cap[1].is_equal_approx(Vector3(1, 0, 0)));
+		REQUIRE(upper_cap[2].is_equal_approx(Vector3(1, 0, 0)));
 	}
 }
 } //namespace TestSlicedMesh
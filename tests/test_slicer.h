@@ -33,7 +33,9 @@
 
 #include "tests/test_macros.h"
 
+#include "../slice_task.h"
 #include "../slicer.h"
+#include "core/object/message_queue.h"
 #include "scene/resources/3d/primitive_meshes.h"
 
 namespace TestIntersector {
@@ -47,8 +49,556 @@ TEST_SUITE("[Slicer]") {
 		Slicer slicer;
 		Ref<SlicedMesh> sliced_mesh = slicer.slice_by_plane(sphere_mesh, plane, NULL);
 		REQUIRE_FALSE(sliced_mesh.is_null());
-		REQUIRE_FALSE(sliced_mesh->upper_mesh.is_null());
-		REQUIRE_FALSE(sliced_mesh->lower_mesh.is_null());
+		REQUIRE_FALSE(sliced_mesh->get_upper_mesh().is_null());
+		REQUIRE_FALSE(sliced_mesh->get_lower_mesh().is_null());
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Preserving indices") {
+		Ref<SphereMesh> sphere_mesh;
+		sphere_mesh.instantiate();
+		Slicer slicer;
+		Ref<SlicedMesh> sliced_mesh = slicer.slice_by_plane(sphere_mesh, plane, NULL);
+
+		slicer.set_preserve_indices(true);
+		Ref<SlicedMesh> indexed_mesh = slicer.slice_by_plane(sphere_mesh, plane, NULL);
+		REQUIRE_FALSE(indexed_mesh.is_null());
+
+		Ref<Mesh> halves[2] = { indexed_mesh->get_upper_mesh(), indexed_mesh->get_lower_mesh() };
+		Ref<Mesh> control_halves[2] = { sliced_mesh->get_upper_mesh(), sliced_mesh->get_lower_mesh() };
+		for (int i = 0; i < 2; i++) {
+			REQUIRE(halves[i]->get_surface_count() == 2);
+			for (int j = 0; j < 2; j++) {
+				REQUIRE(halves[i]->surface_get_format(j) & Mesh::ARRAY_FORMAT_INDEX);
+				REQUIRE(halves[i]->surface_get_array_index_len(j) == control_halves[i]->surface_get_array_len(j));
+				REQUIRE(halves[i]->surface_get_array_len(j) < control_halves[i]->surface_get_array_len(j));
+			}
+		}
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Builds each half the first time it's asked for") {
+		Ref<SphereMesh> sphere_mesh;
+		sphere_mesh.instantiate();
+		Slicer slicer;
+		Ref<SlicedMesh> sliced_mesh = slicer.slice_by_plane(sphere_mesh, plane, NULL);
+		REQUIRE(sliced_mesh->has_upper_mesh());
+		REQUIRE(sliced_mesh->has_lower_mesh());
+		REQUIRE_FALSE(sliced_mesh->is_upper_mesh_built());
+		REQUIRE_FALSE(sliced_mesh->is_lower_mesh_built());
+
+		// The bounds are there before either half is built, and match them once they are
+		AABB upper_aabb = sliced_mesh->get_upper_aabb();
+		REQUIRE_FALSE(sliced_mesh->is_upper_mesh_built());
+		REQUIRE(Math::is_zero_approx(upper_aabb.position.x));
+		Ref<Mesh> upper_mesh = sliced_mesh->get_upper_mesh();
+		REQUIRE(upper_mesh.is_valid());
+		REQUIRE(upper_mesh->get_aabb().is_equal_approx(upper_aabb));
+		REQUIRE_FALSE(sliced_mesh->is_lower_mesh_built());
+
+		REQUIRE(sliced_mesh->get_upper_mesh() == upper_mesh);
+		REQUIRE(sliced_mesh->get_lower_mesh()->get_aabb().is_equal_approx(sliced_mesh->get_lower_aabb()));
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Only builds the half asked for") {
+		Ref<SphereMesh> sphere_mesh;
+		sphere_mesh.instantiate();
+
+		for (int indexed = 0; indexed < 2; indexed++) {
+			Slicer slicer;
+			slicer.set_preserve_indices(indexed);
+			Ref<SlicedMesh> control = slicer.slice_by_plane(sphere_mesh, plane, NULL);
+
+			for (int i = 0; i < 2; i++) {
+				bool upper = i == 0;
+				slicer.set_halves(upper ? Slicer::HALVES_UPPER : Slicer::HALVES_LOWER);
+				Ref<SlicedMesh> sliced_mesh = slicer.slice_by_plane(sphere_mesh, plane, NULL);
+				REQUIRE(sliced_mesh->has_upper_mesh() == upper);
+				REQUIRE(sliced_mesh->has_lower_mesh() == !upper);
+				REQUIRE(sliced_mesh->get_upper_mesh().is_null() == !upper);
+				REQUIRE(sliced_mesh->get_lower_mesh().is_null() == upper);
+
+				// The half that was kept comes out exactly as it would alongside the other
+				Ref<Mesh> half = upper ? sliced_mesh->get_upper_mesh() : sliced_mesh->get_lower_mesh();
+				Ref<Mesh> control_half = upper ? control->get_upper_mesh() : control->get_lower_mesh();
+				REQUIRE(half->get_surface_count() == control_half->get_surface_count());
+				for (int j = 0; j < half->get_surface_count(); j++) {
+					REQUIRE(half->surface_get_array_len(j) == control_half->surface_get_array_len(j));
+					REQUIRE(half->surface_get_array_index_len(j) == control_half->surface_get_array_index_len(j));
+				}
+				Vector<Face3> faces = half->get_faces();
+				Vector<Face3> control_faces = control_half->get_faces();
+				REQUIRE(faces.size() == control_faces.size());
+				for (int j = 0; j < faces.size(); j++) {
+					for (int k = 0; k < 3; k++) {
+						REQUIRE(faces[j].vertex[k] == control_faces[j].vertex[k]);
+					}
+				}
+			}
+		}
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Slicing on the WorkerThreadPool") {
+		Ref<SphereMesh> sphere_mesh;
+		sphere_mesh.instantiate();
+		Slicer slicer;
+		Ref<SlicedMesh> control = slicer.slice_by_plane(sphere_mesh, plane, NULL);
+
+		Ref<SliceTask> task = slicer.slice_by_plane_async(sphere_mesh, plane, NULL);
+		REQUIRE(task.is_valid());
+		SIGNAL_WATCH(task.ptr(), "completed");
+
+		// Changing the Slicer or the mesh after the slice started doesn't change the slice,
+		// the mesh was read in before the task was handed to the pool
+		slicer.set_halves(Slicer::HALVES_UPPER);
+		sphere_mesh->set_radius(2);
+		sphere_mesh->set_height(4);
+
+		Ref<SlicedMesh> sliced_mesh = task->wait();
+		REQUIRE(task->is_completed());
+		REQUIRE(task->get_sliced_mesh() == sliced_mesh);
+
+		// Both halves were built on the worker
+		REQUIRE(sliced_mesh->is_upper_mesh_built());
+		REQUIRE(sliced_mesh->is_lower_mesh_built());
+
+		Ref<Mesh> halves[2] = { sliced_mesh->get_upper_mesh(), sliced_mesh->get_lower_mesh() };
+		Ref<Mesh> control_halves[2] = { control->get_upper_mesh(), control->get_lower_mesh() };
+		for (int i = 0; i < 2; i++) {
+			Vector<Face3> faces = halves[i]->get_faces();
+			Vector<Face3> control_faces = control_halves[i]->get_faces();
+			REQUIRE(faces.size() == control_faces.size());
+			for (int j = 0; j < faces.size(); j++) {
+				for (int k = 0; k < 3; k++) {
+					REQUIRE(faces[j].vertex[k] == control_faces[j].vertex[k]);
+				}
+			}
+		}
+
+		// The signal waits for the message queue, same as anything else deferred
+		SIGNAL_CHECK_FALSE("completed");
+		MessageQueue::get_singleton()->flush();
+		Array signal_args;
+		Array completed_args;
+		completed_args.push_back(sliced_mesh);
+		signal_args.push_back(completed_args);
+		SIGNAL_CHECK("completed", signal_args);
+		SIGNAL_UNWATCH(task.ptr(), "completed");
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Slicing on the WorkerThreadPool with the Slicer's settings") {
+		Ref<SphereMesh> sphere_mesh;
+		sphere_mesh.instantiate();
+		Ref<SliceTask> tasks[3];
+		{
+			Slicer slicer;
+			slicer.set_use_mesh_cache(true);
+			slicer.set_halves(Slicer::HALVES_LOWER);
+			tasks[0] = slicer.slice_async(sphere_mesh, Transform3D(), Vector3(), plane.normal, NULL);
+			tasks[1] = slicer.slice_mesh_async(sphere_mesh, Vector3(), plane.normal, NULL);
+			tasks[2] = slicer.slice_by_plane_async(sphere_mesh, Plane(Vector3(1, 0, 0), 10), NULL);
+			// The tasks hold on to the Slicer's engine, so it can go before they're done
+		}
+
+		for (int i = 0; i < 2; i++) {
+			Ref<SlicedMesh> sliced_mesh = tasks[i]->wait();
+			REQUIRE_FALSE(sliced_mesh->has_upper_mesh());
+			REQUIRE(sliced_mesh->is_lower_mesh_built());
+		}
+		REQUIRE(tasks[2]->wait().is_null());
+		MessageQueue::get_singleton()->flush();
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Slicing large meshes on the WorkerThreadPool at the same time") {
+		// Enough faces for each slice to split its surface in chunks on the pool as well
+		Ref<SphereMesh> sphere_mesh;
+		sphere_mesh.instantiate();
+		sphere_mesh->set_radial_segments(256);
+		sphere_mesh->set_rings(64);
+		Slicer slicer;
+		Ref<SlicedMesh> control = slicer.slice_by_plane(sphere_mesh, plane, NULL);
+
+		const int task_count = 8;
+		Ref<SliceTask> tasks[task_count];
+		for (int i = 0; i < task_count; i++) {
+			tasks[i] = slicer.slice_async(sphere_mesh, Transform3D(), Vector3(), plane.normal, NULL);
+		}
+
+		Vector<Face3> control_faces = control->get_lower_mesh()->get_faces();
+		for (int i = 0; i < task_count; i++) {
+			Ref<SlicedMesh> sliced_mesh = tasks[i]->wait();
+			REQUIRE(sliced_mesh.is_valid());
+			Vector<Face3> faces = sliced_mesh->get_lower_mesh()->get_faces();
+			REQUIRE(faces.size() == control_faces.size());
+			for (int j = 0; j < faces.size(); j++) {
+				for (int k = 0; k < 3; k++) {
+					REQUIRE(faces[j].vertex[k] == control_faces[j].vertex[k]);
+				}
+			}
+		}
+		MessageQueue::get_singleton()->flush();
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Planes missing the mesh bail out before parsing") {
+		Ref<SphereMesh> sphere_mesh;
+		sphere_mesh.instantiate();
+		Slicer slicer;
+		slicer.set_use_mesh_cache(true);
+
+		Ref<SlicedMesh> sliced_mesh = slicer.slice_by_plane(sphere_mesh, Plane(Vector3(1, 0, 0), 10), NULL);
+		REQUIRE(sliced_mesh.is_null());
+		sliced_mesh = slicer.slice_by_plane(sphere_mesh, Plane(Vector3(1, 0, 0), -10), NULL);
+		REQUIRE(sliced_mesh.is_null());
+		REQUIRE(slicer.get_mesh_cache()->get_entry_count() == 0);
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Passes surfaces on one side through unsplit") {
+		// One box straddling the plane and another floating well above it
+		Ref<BoxMesh> box_mesh;
+		box_mesh.instantiate();
+		Array arrays = box_mesh->get_mesh_arrays();
+		Array raised_arrays = arrays.duplicate();
+		Vector<Vector3> raised_positions = raised_arrays[Mesh::ARRAY_VERTEX];
+		for (int i = 0; i < raised_positions.size(); i++) {
+			raised_positions.write[i].y += 5;
+		}
+		raised_arrays[Mesh::ARRAY_VERTEX] = raised_positions;
+
+		Ref<ArrayMesh> mesh;
+		mesh.instantiate();
+		mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, arrays);
+		mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, raised_arrays);
+
+		Plane y_plane(Vector3(0, 1, 0), 0);
+		Slicer slicer;
+		for (int cached = 0; cached < 2; cached++) {
+			slicer.set_use_mesh_cache(cached);
+			Ref<SlicedMesh> sliced_mesh = slicer.slice_by_plane(mesh, y_plane, NULL);
+			REQUIRE_FALSE(sliced_mesh.is_null());
+
+			// The raised box keeps its original indexed layout in the upper half and
+			// never shows up in the lower one
+			Ref<Mesh> upper_mesh = sliced_mesh->get_upper_mesh();
+			REQUIRE(upper_mesh->get_surface_count() == 3);
+			REQUIRE(upper_mesh->surface_get_format(1) & Mesh::ARRAY_FORMAT_INDEX);
+			REQUIRE(upper_mesh->surface_get_array_len(1) == mesh->surface_get_array_len(1));
+			REQUIRE(upper_mesh->surface_get_array_index_len(1) == mesh->surface_get_array_index_len(1));
+			REQUIRE(sliced_mesh->get_lower_mesh()->get_surface_count() == 2);
+		}
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Caps each part of the mesh on its own") {
+		// Two boxes side by side in one surface, which a single convex cap would bridge
+		Ref<BoxMesh> box_mesh;
+		box_mesh.instantiate();
+		Array arrays = box_mesh->get_mesh_arrays();
+		Vector<Vector3> positions = arrays[Mesh::ARRAY_VERTEX];
+		Vector<int> indices = arrays[Mesh::ARRAY_INDEX];
+		int vertex_count = positions.size();
+		int index_count = indices.size();
+		for (int i = 0; i < vertex_count; i++) {
+			positions.push_back(positions[i] + Vector3(0, 0, 3));
+		}
+		for (int i = 0; i < index_count; i++) {
+			indices.push_back(indices[i] + vertex_count);
+		}
+
+		Array doubled;
+		doubled.resize(Mesh::ARRAY_MAX);
+		doubled[Mesh::ARRAY_VERTEX] = positions;
+		doubled[Mesh::ARRAY_INDEX] = indices;
+		Ref<ArrayMesh> mesh;
+		mesh.instantiate();
+		mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, doubled);
+
+		Slicer slicer;
+		for (int preserve = 0; preserve < 2; preserve++) {
+			slicer.set_preserve_indices(preserve);
+			Ref<SlicedMesh> sliced_mesh = slicer.slice_by_plane(mesh, Plane(Vector3(1, 0, 0), 0.1), NULL);
+			REQUIRE(sliced_mesh.is_valid());
+
+			FaceBuffer cap = FaceBuffer::faces_from_surface(sliced_mesh->get_lower_mesh(), 1);
+			double area = 0;
+			for (int i = 0; i < cap.size(); i++) {
+				SlicerFace face = cap.get_face(i);
+				area += (face.vertex[1] - face.vertex[0]).cross(face.vertex[2] - face.vertex[0]).length() * 0.5;
+				Vector3 center = (face.vertex[0] + face.vertex[1] + face.vertex[2]) / 3;
+				REQUIRE((center.z < 0.5 || center.z > 2.5));
+			}
+			REQUIRE(Math::abs(area - 2) < 0.0001);
+		}
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Caps a plane lying on a face of the mesh") {
+		Ref<BoxMesh> box_mesh;
+		box_mesh.instantiate();
+
+		// The area of every face of the mesh lying flat on the plane
+		auto flat_area = [](const Ref<Mesh> &p_mesh, const Plane &p_plane) {
+			double area = 0;
+			for (int s = 0; s < p_mesh->get_surface_count(); s++) {
+				FaceBuffer faces = FaceBuffer::faces_from_surface(p_mesh, s);
+				for (int i = 0; i < faces.size(); i++) {
+					SlicerFace face = faces.get_face(i);
+					bool flat = true;
+					for (int j = 0; j < 3; j++) {
+						flat = flat && Math::abs(p_plane.distance_to(face.vertex[j])) < CMP_EPSILON;
+					}
+					if (flat) {
+						area += (face.vertex[1] - face.vertex[0]).cross(face.vertex[2] - face.vertex[0]).length() * 0.5;
+					}
+				}
+			}
+			return area;
+		};
+
+		Slicer slicer;
+		for (int preserve = 0; preserve < 2; preserve++) {
+			slicer.set_preserve_indices(preserve);
+
+			// On the bottom face the faces around it are all above the plane, on the top
+			// face they're all below it. Either way the face itself is the cross section
+			Plane bottom(Vector3(0, 1, 0), -0.5);
+			Ref<SlicedMesh> sliced_mesh = slicer.slice_by_plane(box_mesh, bottom, NULL);
+			REQUIRE(sliced_mesh.is_valid());
+			REQUIRE(Math::abs(flat_area(sliced_mesh->get_upper_mesh(), bottom) - 1) < 0.0001);
+
+			Plane top(Vector3(0, 1, 0), 0.5);
+			sliced_mesh = slicer.slice_by_plane(box_mesh, top, NULL);
+			REQUIRE(sliced_mesh.is_valid());
+			REQUIRE(Math::abs(flat_area(sliced_mesh->get_lower_mesh(), top) - 1) < 0.0001);
+
+			// Cutting a half again along its own cap caps it the same way
+			Plane middle(Vector3(0, 1, 0), 0);
+			Ref<Mesh> lower_mesh = slicer.slice_by_plane(box_mesh, middle, NULL)->get_lower_mesh();
+			sliced_mesh = slicer.slice_by_plane(lower_mesh, middle, NULL);
+			REQUIRE(sliced_mesh.is_valid());
+			REQUIRE(Math::abs(flat_area(sliced_mesh->get_lower_mesh(), middle) - 1) < 0.0001);
+		}
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Dicing by parallel planes") {
+		Ref<SphereMesh> sphere_mesh;
+		sphere_mesh.instantiate();
+		Slicer slicer;
+
+		// Facing either way doesn't matter, and the plane missing the sphere leaves one
+		// empty slab behind which gets dropped
+		TypedArray<Plane> planes;
+		planes.push_back(Plane(Vector3(0, 1, 0), 0.2));
+		planes.push_back(Plane(Vector3(0, -1, 0), 0.1));
+		planes.push_back(Plane(Vector3(0, 1, 0), 3));
+		TypedArray<Mesh> pieces = slicer.slice_by_planes(sphere_mesh, planes, NULL);
+		REQUIRE(pieces.size() == 3);
+
+		// The top piece is the same as the upper half of slicing by its plane alone
+		Ref<SlicedMesh> control = slicer.slice_by_plane(sphere_mesh, planes[0], NULL);
+		Ref<Mesh> top = pieces[2];
+		REQUIRE(top->get_surface_count() == 2);
+		REQUIRE(top->surface_get_array_len(0) == control->get_upper_mesh()->surface_get_array_len(0));
+
+		TypedArray<Plane> crossed_planes;
+		crossed_planes.push_back(Plane(Vector3(0, 1, 0), 0.2));
+		crossed_planes.push_back(Plane(Vector3(1, 0, 0), 0.1));
+		ERR_PRINT_OFF;
+		REQUIRE(slicer.slice_by_planes(sphere_mesh, crossed_planes, NULL).is_empty());
+		ERR_PRINT_ON;
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Dicing by a grid") {
+		Ref<BoxMesh> box_mesh;
+		box_mesh.instantiate();
+		Slicer slicer;
+
+		PackedFloat32Array offsets;
+		offsets.push_back(0);
+		TypedArray<Mesh> pieces = slicer.slice_by_grid(box_mesh, offsets, offsets, PackedFloat32Array(), NULL);
+		REQUIRE(pieces.size() == 4);
+		for (int i = 0; i < pieces.size(); i++) {
+			Ref<Mesh> piece = pieces[i];
+			REQUIRE(piece->get_surface_count() == 2);
+
+			// Pieces go along x first, then y
+			AABB aabb = piece->get_aabb();
+			REQUIRE(Math::is_equal_approx(aabb.get_center().x, (real_t)((i % 2) ? 0.25 : -0.25)));
+			REQUIRE(Math::is_equal_approx(aabb.get_center().y, (real_t)((i / 2) ? 0.25 : -0.25)));
+			REQUIRE(Math::is_equal_approx(aabb.size.z, (real_t)1));
+		}
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Carving out a convex volume") {
+		Ref<BoxMesh> box_mesh;
+		box_mesh.instantiate();
+		Slicer slicer;
+
+		// A cube taking a corner out of the box
+		Vector<Vector3> points;
+		TypedArray<Plane> planes;
+		for (int i = 0; i < 8; i++) {
+			points.push_back(Vector3(i & 1, (i >> 1) & 1, (i >> 2) & 1) * 0.5 - Vector3(0.25, 0.25, 0.25));
+		}
+		for (int axis = 0; axis < 3; axis++) {
+			Vector3 normal;
+			normal[axis] = 1;
+			planes.push_back(Plane(normal, 0.75));
+			planes.push_back(Plane(-normal, -0.25));
+		}
+		Ref<ConvexPolygonShape3D> shape;
+		shape.instantiate();
+		shape->set_points(points);
+		Transform3D shape_transform;
+		shape_transform.origin = Vector3(0.5, 0.5, 0.5);
+
+		Ref<SlicedMesh> results[2] = {
+			slicer.slice_by_convex(box_mesh, planes, NULL),
+			slicer.slice_by_convex_shape(box_mesh, shape, shape_transform, NULL),
+		};
+		for (int i = 0; i < 2; i++) {
+			REQUIRE_FALSE(results[i].is_null());
+			Ref<Mesh> inside = results[i]->get_lower_mesh();
+			REQUIRE(inside->get_surface_count() == 2);
+			REQUIRE(inside->get_aabb().is_equal_approx(AABB(Vector3(0.25, 0.25, 0.25), Vector3(0.25, 0.25, 0.25))));
+
+			// Three quarter by quarter squares on the inside of the cut
+			Vector<Vector3> cap = inside->surface_get_arrays(1)[Mesh::ARRAY_VERTEX];
+			real_t area = 0;
+			for (int j = 0; j < cap.size(); j += 3) {
+				area += (cap[j + 1] - cap[j]).cross(cap[j + 2] - cap[j]).length() * 0.5;
+			}
+			REQUIRE(Math::is_equal_approx(area, (real_t)0.1875));
+
+			Ref<Mesh> outside = results[i]->get_upper_mesh();
+			REQUIRE(outside->get_surface_count() == 2);
+			REQUIRE(outside->get_aabb().is_equal_approx(box_mesh->get_aabb()));
+		}
+
+		// Keeping only the inside leaves the outside out altogether
+		slicer.set_halves(Slicer::HALVES_LOWER);
+		Ref<SlicedMesh> inside_only = slicer.slice_by_convex(box_mesh, planes, NULL);
+		REQUIRE(inside_only->get_upper_mesh().is_null());
+		REQUIRE(inside_only->get_lower_mesh()->get_aabb().is_equal_approx(results[0]->get_lower_mesh()->get_aabb()));
+		REQUIRE(inside_only->get_lower_mesh()->surface_get_array_len(0) == results[0]->get_lower_mesh()->surface_get_array_len(0));
+		slicer.set_halves(Slicer::HALVES_BOTH);
+
+		// Volumes that miss the mesh don't cut anything
+		shape_transform.origin = Vector3(5, 0, 0);
+		REQUIRE(slicer.slice_by_convex_shape(box_mesh, shape, shape_transform, NULL).is_null());
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Carving out a volume flush with a face of the mesh") {
+		Ref<BoxMesh> box_mesh;
+		box_mesh.instantiate();
+		box_mesh->set_size(Vector3(2, 2, 2));
+		Slicer slicer;
+
+		// Takes the top of the box's x > 0 half out, its top plane lying on the box's top
+		TypedArray<Plane> planes;
+		planes.push_back(Plane(Vector3(1, 0, 0), 2));
+		planes.push_back(Plane(Vector3(-1, 0, 0), 0));
+		planes.push_back(Plane(Vector3(0, 1, 0), 1));
+		planes.push_back(Plane(Vector3(0, -1, 0), 0));
+		planes.push_back(Plane(Vector3(0, 0, 1), 2));
+		planes.push_back(Plane(Vector3(0, 0, -1), 2));
+		Ref<SlicedMesh> sliced_mesh = slicer.slice_by_convex(box_mesh, planes, NULL);
+		REQUIRE(sliced_mesh.is_valid());
+
+		// The area of the faces in a surface lying on y = 1, on either side of x = 0
+		auto top_area = [](const Ref<Mesh> &p_mesh, int p_surface, bool p_positive_x) {
+			FaceBuffer faces = FaceBuffer::faces_from_surface(p_mesh, p_surface);
+			real_t area = 0;
+			for (int i = 0; i < faces.size(); i++) {
+				SlicerFace face = faces.get_face(i);
+				Vector3 center = (face.vertex[0] + face.vertex[1] + face.vertex[2]) / 3;
+				bool on_top = true;
+				for (int j = 0; j < 3; j++) {
+					on_top = on_top && Math::abs(face.vertex[j].y - 1) < CMP_EPSILON;
+				}
+				if (on_top && (center.x > 0) == p_positive_x) {
+					area += (face.vertex[1] - face.vertex[0]).cross(face.vertex[2] - face.vertex[0]).length() / 2;
+				}
+			}
+			return area;
+		};
+
+		// Each side keeps its own part of the top, and neither gets it capped over
+		Ref<Mesh> inside = sliced_mesh->get_lower_mesh();
+		Ref<Mesh> outside = sliced_mesh->get_upper_mesh();
+		REQUIRE(inside->get_surface_count() == 2);
+		REQUIRE(outside->get_surface_count() == 2);
+		REQUIRE(Math::is_equal_approx(top_area(inside, 0, true), (real_t)2));
+		REQUIRE(Math::is_zero_approx(top_area(inside, 0, false)));
+		REQUIRE(Math::is_equal_approx(top_area(outside, 0, false), (real_t)2));
+		REQUIRE(Math::is_zero_approx(top_area(outside, 0, true)));
+		for (int i = 0; i < 2; i++) {
+			REQUIRE(Math::is_zero_approx(top_area(inside, 1, i)));
+			REQUIRE(Math::is_zero_approx(top_area(outside, 1, i)));
+		}
+
+		// Only where the volume cuts through the box gets capped, along x = 0 and y = 0
+		Vector<Vector3> cap = inside->surface_get_arrays(1)[Mesh::ARRAY_VERTEX];
+		real_t area = 0;
+		for (int i = 0; i < cap.size(); i += 3) {
+			area += (cap[i + 1] - cap[i]).cross(cap[i + 2] - cap[i]).length() / 2;
+		}
+		REQUIRE(Math::is_equal_approx(area, (real_t)4));
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Fracturing into Voronoi cells") {
+		Ref<BoxMesh> box_mesh;
+		box_mesh.instantiate();
+		Slicer slicer;
+
+		// Two seeds split the box down the middle and the one far away gets nothing
+		PackedVector3Array seeds;
+		seeds.push_back(Vector3(-0.25, 0, 0));
+		seeds.push_back(Vector3(0.25, 0.1, 0));
+		seeds.push_back(Vector3(10, 0, 0));
+		TypedArray<Mesh> fragments = slicer.fracture(box_mesh, seeds, NULL);
+		REQUIRE(fragments.size() == 3);
+		Ref<Mesh> left = fragments[0];
+		Ref<Mesh> right = fragments[1];
+		Ref<Mesh> missing = fragments[2];
+		REQUIRE(missing.is_null());
+		REQUIRE(left->get_surface_count() == 2);
+		REQUIRE(right->get_surface_count() == 2);
+		REQUIRE(left->get_aabb().get_center().x < 0);
+		REQUIRE(right->get_aabb().get_center().x > 0);
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] Fracturing is deterministic and keeps the whole surface") {
+		Ref<SphereMesh> sphere_mesh;
+		sphere_mesh.instantiate();
+		Slicer slicer;
+
+		TypedArray<Mesh> fragments = slicer.fracture_random(sphere_mesh, 8, 1234, NULL);
+		TypedArray<Mesh> again = slicer.fracture_random(sphere_mesh, 8, 1234, NULL);
+		REQUIRE(fragments.size() == 8);
+		REQUIRE(again.size() == 8);
+
+		double area = 0;
+		for (int i = 0; i < fragments.size(); i++) {
+			Ref<Mesh> fragment = fragments[i];
+			Ref<Mesh> control = again[i];
+			REQUIRE(fragment.is_null() == control.is_null());
+			if (fragment.is_null()) {
+				continue;
+			}
+
+			Vector<Vector3> vertices = fragment->surface_get_arrays(0)[Mesh::ARRAY_VERTEX];
+			Vector<Vector3> control_vertices = control->surface_get_arrays(0)[Mesh::ARRAY_VERTEX];
+			REQUIRE(vertices.size() == control_vertices.size());
+			for (int j = 0; j < vertices.size(); j++) {
+				REQUIRE(vertices[j] == control_vertices[j]);
+			}
+			for (int j = 0; j < vertices.size(); j += 3) {
+				area += (vertices[j + 1] - vertices[j]).cross(vertices[j + 2] - vertices[j]).length() * 0.5;
+			}
+		}
+
+		double control_area = 0;
+		Vector<Face3> faces = sphere_mesh->get_faces();
+		for (int i = 0; i < faces.size(); i++) {
+			control_area += faces[i].get_area();
+		}
+		REQUIRE(Math::abs(area - control_area) < 0.001);
 	}
 }
 } //namespace TestIntersector
@@ -35,6 +35,7 @@
 #include "tests/test_macros.h"
 
 #include "../utils/surface_filler.h"
+#include "test_mesh_utils.h"
 
 namespace TestSurfaceFiller {
 
@@ -49,9 +50,10 @@ TEST_SUITE("[surface_filler]") {
 		face_1.set_tangents(Vector4(1, 0, 0, 1), Vector4(1, 0, 0, 1), Vector4(1, 0, 0, 1));
 		face_2.set_tangents(Vector4(1, 0, 0, 1), Vector4(1, 0, 0, 1), Vector4(1, 0, 0, 1));
 
-		Vector<SlicerFace> faces;
-		faces.push_back(face_1);
-		faces.push_back(face_2);
+		FaceBuffer faces;
+		faces.set_format(FaceBuffer::ATTRIBUTE_TANGENT | FaceBuffer::ATTRIBUTE_UV);
+		TestMeshUtils::push_face(faces, face_1);
+		TestMeshUtils::push_face(faces, face_2);
 
 		SurfaceFiller filler(faces);
 		for (int i = 0; i < 6; i++) {
@@ -109,6 +111,102 @@ TEST_SUITE("[surface_filler]") {
 		// 	REQUIRE(tangents[i + 3] == 1);
 		// }
 	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] encodes every attribute of an indexed surface") {
+		Vector<Vector3> vertices = { Vector3(0, 0, 0), Vector3(2, 0, 0), Vector3(2, 1, 3), Vector3(0, 1, 3) };
+		Vector<Vector3> normals = { Vector3(0, 1, 0), Vector3(0, 1, 0), Vector3(0, 0, 1), Vector3(0, 0, -1) };
+		Vector<Color> colors = { Color(1, 0, 0), Color(0, 1, 0), Color(0, 0, 1), Color(1, 1, 1) };
+		Vector<Vector2> uv2s = { Vector2(0.25, 0.5), Vector2(0.5, 0.5), Vector2(0.5, 0.75), Vector2(0.25, 0.75) };
+		Vector<int> bones = { 0, 1, 0, 0, 2, 0, 0, 0, 1, 2, 0, 0, 3, 0, 0, 0 };
+		Vector<real_t> weights = { 0.5, 0.5, 0, 0, 1, 0, 0, 0, 0.25, 0.75, 0, 0, 1, 0, 0, 0 };
+		Vector<int> indices = { 0, 1, 2, 2, 3, 0 };
+
+		Array arrays;
+		arrays.resize(Mesh::ARRAY_MAX);
+		arrays[Mesh::ARRAY_VERTEX] = vertices;
+		arrays[Mesh::ARRAY_NORMAL] = normals;
+		arrays[Mesh::ARRAY_COLOR] = colors;
+		arrays[Mesh::ARRAY_TEX_UV2] = uv2s;
+		arrays[Mesh::ARRAY_BONES] = bones;
+		arrays[Mesh::ARRAY_WEIGHTS] = weights;
+		arrays[Mesh::ARRAY_INDEX] = indices;
+
+		FaceBuffer source = FaceBuffer::faces_from_arrays(arrays);
+		FaceBuffer faces = FaceBuffer::faces_from_arrays(arrays, true);
+		REQUIRE(faces.is_indexed());
+		REQUIRE(faces.vertices.size() == 4);
+
+		SurfaceFiller filler(faces);
+		filler.fill_vertices();
+		filler.fill_indices();
+
+		Ref<ArrayMesh> mesh = memnew(ArrayMesh);
+		filler.add_to_mesh(mesh, Ref<Material>());
+		REQUIRE(mesh->get_surface_count() == 1);
+		REQUIRE(mesh->get_aabb().is_equal_approx(AABB(Vector3(0, 0, 0), Vector3(2, 1, 3))));
+
+		uint64_t format = mesh->surface_get_format(0);
+		REQUIRE((format & Mesh::ARRAY_FORMAT_INDEX));
+		REQUIRE((format & Mesh::ARRAY_FORMAT_NORMAL));
+		REQUIRE((format & Mesh::ARRAY_FORMAT_COLOR));
+		REQUIRE((format & Mesh::ARRAY_FORMAT_TEX_UV2));
+		REQUIRE((format & Mesh::ARRAY_FORMAT_BONES));
+		REQUIRE((format & Mesh::ARRAY_FORMAT_WEIGHTS));
+		REQUIRE(!(format & Mesh::ARRAY_FORMAT_TEX_UV));
+
+		// Reading the surface back has to give the same faces, give or take the precision
+		// normals, colors and weights get packed down to
+		FaceBuffer read_back = FaceBuffer::faces_from_arrays(mesh->surface_get_arrays(0));
+		REQUIRE(read_back.size() == 2);
+		for (int i = 0; i < 2; i++) {
+			SlicerFace expected = source.get_face(i);
+			SlicerFace actual = read_back.get_face(i);
+			for (int j = 0; j < 3; j++) {
+				REQUIRE(actual.vertex[j] == expected.vertex[j]);
+				REQUIRE(actual.normal[j].distance_to(expected.normal[j]) < 0.001);
+				REQUIRE(actual.color[j].is_equal_approx(expected.color[j]));
+				REQUIRE(actual.uv2[j] == expected.uv2[j]);
+				REQUIRE(actual.bones[j] == expected.bones[j]);
+				for (int k = 0; k < 4; k++) {
+					REQUIRE(Math::abs(actual.weights[j][k] - expected.weights[j][k]) < 0.0001);
+				}
+			}
+		}
+	}
+
+	TEST_CASE("[Modules][Slicer][SceneTree] flips the winding while streaming vertices") {
+		SlicerFace face(Vector3(0, 0, 0), Vector3(1, 0, 0), Vector3(1, 0, 1));
+		face.set_uvs(Vector2(0, 0), Vector2(1, 0), Vector2(1, 1));
+
+		FaceBuffer faces;
+		faces.set_format(FaceBuffer::ATTRIBUTE_UV);
+		TestMeshUtils::push_face(faces, face);
+		TestMeshUtils::push_face(faces, SlicerFace(Vector3(2, 0, 0), Vector3(3, 0, 0), Vector3(3, 0, 1)));
+		faces.uvs[3] = Vector2(0, 0);
+		faces.uvs[4] = Vector2(1, 0);
+		faces.uvs[5] = Vector2(1, 1);
+
+		SurfaceFiller filler(faces);
+		filler.fill_vertices(true);
+
+		Ref<ArrayMesh> mesh = memnew(ArrayMesh);
+		filler.add_to_mesh(mesh, Ref<Material>());
+		REQUIRE(mesh->get_aabb().is_equal_approx(AABB(Vector3(0, 0, 0), Vector3(3, 0, 1))));
+
+		Array arrays = mesh->surface_get_arrays(0);
+		Vector<Vector3> vertices = arrays[Mesh::ARRAY_VERTEX];
+		Vector<Vector2> uvs = arrays[Mesh::ARRAY_TEX_UV];
+		REQUIRE(vertices.size() == 6);
+		for (int i = 0; i < 6; i += 3) {
+			// Only the last two corners of each face trade places
+			REQUIRE(vertices[i] == faces.vertices[i]);
+			REQUIRE(vertices[i + 1] == faces.vertices[i + 2]);
+			REQUIRE(vertices[i + 2] == faces.vertices[i + 1]);
+			REQUIRE(uvs[i] == faces.uvs[i]);
+			REQUIRE(uvs[i + 1] == faces.uvs[i + 2]);
+			REQUIRE(uvs[i + 2] == faces.uvs[i + 1]);
+		}
+	}
 }
 } //namespace TestSurfaceFiller
 
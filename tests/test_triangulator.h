@@ -46,8 +46,12 @@ TEST_SUITE("[triangulator]") {
 		interception_points.push_back(Vector3(0, 0, 1));
 		interception_points.push_back(Vector3(0.5, 0, 0.5));
 
-		Vector<SlicerFace> faces = Triangulator::monotone_chain(interception_points, Vector3(0, 1, 0));
-		REQUIRE(faces.size() == 2);
+		FaceBuffer buffer = Triangulator::monotone_chain(interception_points, Vector3(0, 1, 0));
+		REQUIRE(buffer.size() == 2);
+
+		Vector<SlicerFace> faces;
+		faces.push_back(buffer.get_face(0));
+		faces.push_back(buffer.get_face(1));
 		REQUIRE(faces[0] == SlicerFace(Vector3(1, 0, 1), Vector3(0, 0, 1), Vector3(0, 0, 0)));
 		REQUIRE(faces[1] == SlicerFace(Vector3(1, 0, 1), Vector3(0, 0, 0), Vector3(1, 0, 0)));
 
@@ -68,6 +72,182 @@ TEST_SUITE("[triangulator]") {
 		REQUIRE(faces[1].tangent[1] == Vector4(-1, 0, 0, -1));
 		REQUIRE(faces[1].tangent[2] == Vector4(-1, 0, 0, -1));
 	}
+
+	TEST_CASE("[Modules][Slicer] compact_points collapses coincident points") {
+		Vector<Vector3> points;
+		points.push_back(Vector3(0, 0, 0));
+		points.push_back(Vector3(1, 0, 0));
+		points.push_back(Vector3(0, 0, 0));
+		points.push_back(Vector3(1, 0, 1));
+		points.push_back(Vector3(1, 0, 0.000001));
+		points.push_back(Vector3(0, 0, 1));
+
+		REQUIRE(Triangulator::compact_points(points, Vector3(0, 1, 0)) == 2);
+		REQUIRE(points.size() == 4);
+		REQUIRE(points[0] == Vector3(0, 0, 0));
+		REQUIRE(points[1] == Vector3(1, 0, 0));
+		REQUIRE(points[2] == Vector3(1, 0, 1));
+		REQUIRE(points[3] == Vector3(0, 0, 1));
+		REQUIRE(Triangulator::compact_points(points, Vector3(0, 1, 0)) == 0);
+
+		// Feeding the hull every point twice over changes nothing about it
+		Vector<Vector3> doubled = points;
+		doubled.append_array(points);
+		FaceBuffer hull = Triangulator::monotone_chain(points, Vector3(0, 1, 0));
+		FaceBuffer doubled_hull = Triangulator::monotone_chain(doubled, Vector3(0, 1, 0));
+		REQUIRE(doubled_hull.size() == hull.size());
+		for (int i = 0; i < hull.size(); i++) {
+			REQUIRE(doubled_hull.get_face(i) == hull.get_face(i));
+		}
+	}
+
+	// Adds the outline of a polygon on the y = 0 plane, as the unordered segments a slice
+	// would have cut across the faces around it
+	static void add_outline(Vector<Vector3> &r_segments, const Vector<Vector2> &p_points, bool p_reversed = false) {
+		for (int i = 0; i < p_points.size(); i++) {
+			Vector2 a = p_points[i];
+			Vector2 b = p_points[(i + 1) % p_points.size()];
+			if (p_reversed) {
+				SWAP(a, b);
+			}
+			r_segments.push_back(Vector3(a.x, 0, a.y));
+			r_segments.push_back(Vector3(b.x, 0, b.y));
+		}
+	}
+
+	static Vector<Vector2> get_square(const Vector2 &p_center, real_t p_size) {
+		real_t half = p_size / 2;
+		return Vector<Vector2>({ p_center + Vector2(-half, -half), p_center + Vector2(half, -half), p_center + Vector2(half, half), p_center + Vector2(-half, half) });
+	}
+
+	// Sums the areas of the faces, with those wound the other way round from the first
+	// one taking away from it
+	static real_t get_area(const FaceBuffer &p_faces) {
+		real_t area = 0;
+		for (int i = 0; i < p_faces.size(); i++) {
+			SlicerFace face = p_faces.get_face(i);
+			area += (face.vertex[1] - face.vertex[0]).cross(face.vertex[2] - face.vertex[0]).y / 2;
+		}
+		return Math::abs(area);
+	}
+
+	static bool is_wound_like(const FaceBuffer &p_faces, real_t p_sign) {
+		for (int i = 0; i < p_faces.size(); i++) {
+			SlicerFace face = p_faces.get_face(i);
+			if ((face.vertex[1] - face.vertex[0]).cross(face.vertex[2] - face.vertex[0]).y * p_sign <= 0) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	TEST_CASE("[Modules][Slicer] triangulate_segments links the outline back up") {
+		Vector<Vector3> segments;
+		add_outline(segments, get_square(Vector2(0.5, 0.5), 1));
+		// Shuffled and with one of them turned around
+		SWAP(segments.write[0], segments.write[4]);
+		SWAP(segments.write[1], segments.write[5]);
+		SWAP(segments.write[2], segments.write[3]);
+
+		FaceBuffer faces = Triangulator::triangulate_segments(segments, Vector3(0, 1, 0));
+		REQUIRE(faces.size() == 2);
+		REQUIRE(Math::is_equal_approx(get_area(faces), (real_t)1));
+		REQUIRE(faces.format & FaceBuffer::ATTRIBUTE_NORMAL);
+		REQUIRE(faces.normals[0] == Vector3(0, 1, 0));
+
+		// Wound the same way as monotone_chain would have
+		FaceBuffer hull = Triangulator::monotone_chain(Vector<Vector3>({ Vector3(0, 0, 0), Vector3(1, 0, 0), Vector3(1, 0, 1), Vector3(0, 0, 1) }), Vector3(0, 1, 0));
+		SlicerFace hull_face = hull.get_face(0);
+		REQUIRE(is_wound_like(faces, (hull_face.vertex[1] - hull_face.vertex[0]).cross(hull_face.vertex[2] - hull_face.vertex[0]).y));
+
+		for (int i = 0; i < faces.uvs.size(); i++) {
+			REQUIRE(faces.uvs[i].x >= 0);
+			REQUIRE(faces.uvs[i].y <= 1);
+		}
+	}
+
+	TEST_CASE("[Modules][Slicer] triangulate_segments reports the collapsed points") {
+		Vector<Vector3> segments;
+		add_outline(segments, get_square(Vector2(0.5, 0.5), 1));
+		// Every corner ends one segment and starts the next, one of them a hair off
+		segments.write[7] = Vector3(0.000001, 0, 0);
+
+		int welded = -1;
+		FaceBuffer faces = Triangulator::triangulate_segments(segments, Vector3(0, 1, 0), false, &welded);
+		REQUIRE(welded == 4);
+		REQUIRE(faces.size() == 2);
+		REQUIRE(Math::is_equal_approx(get_area(faces), (real_t)1));
+
+		// Too few segments to make up an outline, so nothing gets collapsed
+		welded = -1;
+		Triangulator::triangulate_segments(Vector<Vector3>({ Vector3(0, 0, 0), Vector3(1, 0, 0) }), Vector3(0, 1, 0), false, &welded);
+		REQUIRE(welded == 0);
+	}
+
+	TEST_CASE("[Modules][Slicer] triangulate_segments keeps concave outlines") {
+		// An L made up of three unit squares, which a convex hull would fill in
+		Vector<Vector3> segments;
+		add_outline(segments, Vector<Vector2>({ Vector2(0, 0), Vector2(2, 0), Vector2(2, 1), Vector2(1, 1), Vector2(1, 2), Vector2(0, 2) }));
+
+		FaceBuffer faces = Triangulator::triangulate_segments(segments, Vector3(0, 1, 0));
+		REQUIRE(faces.size() == 4);
+		REQUIRE(Math::is_equal_approx(get_area(faces), (real_t)3));
+		for (int i = 0; i < faces.size(); i++) {
+			SlicerFace face = faces.get_face(i);
+			Vector3 center = (face.vertex[0] + face.vertex[1] + face.vertex[2]) / 3;
+			REQUIRE_FALSE((center.x > 1 && center.z > 1));
+		}
+	}
+
+	TEST_CASE("[Modules][Slicer] triangulate_segments cuts out holes") {
+		for (int reversed = 0; reversed < 2; reversed++) {
+			Vector<Vector3> segments;
+			add_outline(segments, get_square(Vector2(), 4), reversed);
+			add_outline(segments, get_square(Vector2(-1, 0), 1), reversed);
+			add_outline(segments, get_square(Vector2(1, 0.5), 1), !reversed);
+			// An island inside the second hole
+			add_outline(segments, get_square(Vector2(1, 0.5), 0.5));
+
+			FaceBuffer faces = Triangulator::triangulate_segments(segments, Vector3(0, 1, 0));
+			REQUIRE(Math::is_equal_approx(get_area(faces), (real_t)(16 - 1 - 1 + 0.25)));
+			SlicerFace first = faces.get_face(0);
+			REQUIRE(is_wound_like(faces, (first.vertex[1] - first.vertex[0]).cross(first.vertex[2] - first.vertex[0]).y));
+			for (int i = 0; i < faces.size(); i++) {
+				SlicerFace face = faces.get_face(i);
+				Vector3 center = (face.vertex[0] + face.vertex[1] + face.vertex[2]) / 3;
+				REQUIRE_FALSE((Math::abs(center.x + 1) < 0.5 && Math::abs(center.z) < 0.5));
+			}
+		}
+	}
+
+	TEST_CASE("[Modules][Slicer] triangulate_segments handles many islands") {
+		// Enough separate circles to get spread over the WorkerThreadPool
+		Vector<Vector3> segments;
+		for (int i = 0; i < 8; i++) {
+			Vector<Vector2> circle;
+			for (int j = 0; j < 200; j++) {
+				real_t angle = Math_TAU * j / 200;
+				circle.push_back(Vector2(i * 3 + Math::cos(angle), Math::sin(angle)));
+			}
+			add_outline(segments, circle, i % 2);
+		}
+
+		FaceBuffer faces = Triangulator::triangulate_segments(segments, Vector3(0, 1, 0));
+		REQUIRE(faces.size() == 8 * 198);
+		REQUIRE(get_area(faces) > 8 * 3.1);
+		REQUIRE(get_area(faces) < 8 * Math_PI);
+
+		FaceBuffer again = Triangulator::triangulate_segments(segments, Vector3(0, 1, 0));
+		REQUIRE(again.size() == faces.size());
+		for (int i = 0; i < faces.size(); i++) {
+			REQUIRE(again.get_face(i) == faces.get_face(i));
+		}
+
+		FaceBuffer indexed = Triangulator::triangulate_segments(segments, Vector3(0, 1, 0), true);
+		REQUIRE(indexed.is_indexed());
+		REQUIRE(indexed.size() == faces.size());
+		REQUIRE(indexed.vertices.size() == 8 * 200);
+	}
 }
 } //namespace TestTriangulator
 
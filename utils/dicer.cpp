@@ -0,0 +1,319 @@
+/**************************************************************************/
+/*  dicer.cpp                                                             */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "dicer.h"
+
+#include "triangulator.h"
+
+// Counts how many of the sorted offsets come before the passed in distance
+static int count_offsets_below(const LocalVector<real_t> &p_offsets, real_t p_distance, bool p_inclusive) {
+	int lo = 0;
+	int hi = p_offsets.size();
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		bool below = p_inclusive ? p_offsets[mid] <= p_distance : p_offsets[mid] < p_distance;
+		if (below) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+// Caps come out of the triangulator in their own format, which the cells only learn
+// about once the first of them comes through
+static void append_cap_face(FaceBuffer &r_dst, const FaceBuffer &p_src, int p_face, bool p_flip) {
+	if (r_dst.vertices.size() == 0) {
+		r_dst.set_format(p_src.format);
+	}
+
+	int base = p_face * 3;
+	r_dst.append_vertex(p_src, base);
+	r_dst.append_vertex(p_src, p_flip ? base + 2 : base + 1);
+	r_dst.append_vertex(p_src, p_flip ? base + 1 : base + 2);
+}
+
+bool Dicer::Cell::is_empty() const {
+	for (uint32_t i = 0; i < surfaces.size(); i++) {
+		if (surfaces[i].size() > 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void Dicer::add_axis(const Vector3 &p_normal, const Vector<real_t> &p_offsets) {
+	ERR_FAIL_COND(axes.size() >= MAX_AXES);
+	ERR_FAIL_COND_MSG(!p_normal.is_normalized(), "The normal of a dicing axis must be normalized.");
+
+	LocalVector<real_t> sorted;
+	sorted.resize(p_offsets.size());
+	for (int i = 0; i < p_offsets.size(); i++) {
+		sorted[i] = p_offsets[i];
+	}
+	sorted.sort();
+
+	Axis axis;
+	axis.normal = p_normal;
+	// Planes closer together than the distance at which a point counts as being on them
+	// can't be told apart, so only the first of them is kept
+	for (uint32_t i = 0; i < sorted.size(); i++) {
+		if (axis.offsets.size() == 0 || sorted[i] - axis.offsets[axis.offsets.size() - 1] > CMP_EPSILON) {
+			axis.offsets.push_back(sorted[i]);
+		}
+	}
+	axes.push_back(axis);
+}
+
+void Dicer::begin(int p_surface_count) {
+	int cell_count = 1;
+	int plane_count = 0;
+	for (uint32_t i = 0; i < axes.size(); i++) {
+		axes[i].stride = cell_count;
+		axes[i].segments.clear();
+		axes[i].segments.resize(axes[i].offsets.size());
+		cell_count *= axes[i].offsets.size() + 1;
+		plane_count += axes[i].offsets.size();
+	}
+
+	cells.clear();
+	cells.resize(cell_count);
+	for (int i = 0; i < cell_count; i++) {
+		cells[i].surfaces.resize(p_surface_count);
+	}
+
+	// Every split narrows down the cells a piece can go to by at least one plane, so the
+	// recursion never goes deeper than there are planes
+	scratch.resize(plane_count + 1);
+}
+
+int Dicer::get_cell_count() const {
+	return cells.size();
+}
+
+Dicer::CellRange Dicer::get_face_range(const FaceBuffer &p_faces, int p_face, uint32_t p_axis_mask) const {
+	CellRange range;
+	for (uint32_t a = 0; a < axes.size(); a++) {
+		if (!(p_axis_mask & (1 << a))) {
+			continue;
+		}
+
+		const Axis &axis = axes[a];
+		real_t min = axis.normal.dot(p_faces.vertices[p_faces.get_vertex_index(p_face, 0)]);
+		real_t max = min;
+		for (int i = 1; i < 3; i++) {
+			real_t dist = axis.normal.dot(p_faces.vertices[p_faces.get_vertex_index(p_face, i)]);
+			min = MIN(min, dist);
+			max = MAX(max, dist);
+		}
+
+		// Same tolerance as Intersector::get_side_of, a face only needs splitting by the
+		// planes that have one of its corners clearly on either side. hi ends up below lo
+		// when the whole face sits within that tolerance of plane hi
+		range.lo[a] = count_offsets_below(axis.offsets, min + CMP_EPSILON, true);
+		range.hi[a] = count_offsets_below(axis.offsets, max - CMP_EPSILON, false);
+	}
+	return range;
+}
+
+void Dicer::gather_segments(const FaceBuffer &p_faces, int p_face, const CellRange &p_range) {
+	// A piece that has made it into its cell can only touch the plane above it from below,
+	// or lie flat on it. Same as with a regular slice (see Intersector), an edge lying on
+	// that plane gets traced against the piece's winding, whether it was cut there or
+	// already was in the source, and a flat piece traces all of its edges in winding order.
+	// The piece across the plane never reports the edge
+	for (uint32_t a = 0; a < axes.size(); a++) {
+		Axis &axis = axes[a];
+		int plane = p_range.lo[a];
+		if (plane >= (int)axis.offsets.size()) {
+			continue;
+		}
+
+		Vector3 corners[3];
+		int off = -1;
+		int on_count = 0;
+		for (int i = 0; i < 3; i++) {
+			corners[i] = p_faces.vertices[p_faces.get_vertex_index(p_face, i)];
+			if (Math::abs(axis.normal.dot(corners[i]) - axis.offsets[plane]) <= CMP_EPSILON) {
+				on_count++;
+			} else {
+				off = i;
+			}
+		}
+
+		if (on_count == 2) {
+			axis.segments[plane].push_back(corners[(off + 2) % 3]);
+			axis.segments[plane].push_back(corners[(off + 1) % 3]);
+		} else if (on_count == 3) {
+			for (int i = 0; i < 3; i++) {
+				axis.segments[plane].push_back(corners[i]);
+				axis.segments[plane].push_back(corners[(i + 1) % 3]);
+			}
+		}
+	}
+}
+
+template <typename Emit>
+void Dicer::dice_face(const FaceBuffer &p_faces, int p_face, const CellRange &p_range, uint32_t p_axis_mask, bool p_gather_segments, int p_depth, const Emit &p_emit) {
+	int axis_idx = -1;
+	for (uint32_t a = 0; a < axes.size(); a++) {
+		if (p_range.lo[a] < p_range.hi[a]) {
+			axis_idx = a;
+			break;
+		}
+	}
+
+	if (axis_idx == -1) {
+		int cell = 0;
+		for (uint32_t a = 0; a < axes.size(); a++) {
+			cell += p_range.lo[a] * axes[a].stride;
+		}
+		if (p_gather_segments) {
+			gather_segments(p_faces, p_face, p_range);
+		}
+		p_emit(p_faces, p_face, cell);
+		return;
+	}
+
+	ERR_FAIL_INDEX(p_depth, (int)scratch.size());
+
+	// Going for the middle plane of the ones the face crosses keeps the recursion shallow
+	// when a face spans a lot of them
+	Axis &axis = axes[axis_idx];
+	int plane = (p_range.lo[axis_idx] + p_range.hi[axis_idx] - 1) / 2;
+
+	Intersector::SplitResult &split = scratch[p_depth];
+	split.reset();
+	split.set_format(p_faces.format);
+	Intersector::split_face_by_plane(Plane(axis.normal, axis.offsets[plane]), p_faces, p_face, split);
+
+	CellRange sides[2] = { p_range, p_range };
+	sides[0].lo[axis_idx] = plane + 1;
+	sides[1].hi[axis_idx] = plane;
+	const FaceBuffer *pieces[2] = { &split.upper_faces, &split.lower_faces };
+
+	for (int s = 0; s < 2; s++) {
+		for (int i = 0; i < pieces[s]->size(); i++) {
+			// A piece can only have gotten smaller than the face it came from, so it never
+			// leaves the cells its side of the plane was already limited to
+			CellRange range = get_face_range(*pieces[s], i, p_axis_mask);
+			for (uint32_t a = 0; a < axes.size(); a++) {
+				if (p_axis_mask & (1 << a)) {
+					range.lo[a] = CLAMP(range.lo[a], sides[s].lo[a], sides[s].hi[a]);
+					range.hi[a] = CLAMP(range.hi[a], range.lo[a], sides[s].hi[a]);
+				} else {
+					range.lo[a] = sides[s].lo[a];
+					range.hi[a] = sides[s].hi[a];
+				}
+			}
+			dice_face(*pieces[s], i, range, p_axis_mask, p_gather_segments, p_depth + 1, p_emit);
+		}
+	}
+}
+
+void Dicer::dice_surface(int p_surface, const FaceBuffer &p_faces) {
+	ERR_FAIL_COND(cells.size() == 0);
+	ERR_FAIL_INDEX(p_surface, (int)cells[0].surfaces.size());
+	ERR_FAIL_COND(p_faces.is_indexed());
+
+	for (uint32_t i = 0; i < cells.size(); i++) {
+		cells[i].surfaces[p_surface].set_format(p_faces.format);
+	}
+
+	auto emit = [this, p_surface](const FaceBuffer &p_src, int p_face, int p_cell) {
+		cells[p_cell].surfaces[p_surface].append_face(p_src, p_face);
+	};
+
+	// Pieces lying flat on a plane are only diced for the outlines they trace
+	auto skip = [](const FaceBuffer &p_src, int p_face, int p_cell) {};
+
+	uint32_t axis_mask = (1 << axes.size()) - 1;
+	for (int i = 0; i < p_faces.size(); i++) {
+		CellRange range = get_face_range(p_faces, i, axis_mask);
+
+		int flat_axis = -1;
+		for (uint32_t a = 0; a < axes.size() && flat_axis == -1; a++) {
+			if (range.hi[a] < range.lo[a]) {
+				flat_axis = a;
+			}
+		}
+
+		if (flat_axis == -1) {
+			dice_face(p_faces, i, range, axis_mask, true, 0, emit);
+			continue;
+		}
+
+		// Just like a regular slice, a face lying flat on a plane doesn't go to the cells
+		// on either side of it but is part of that plane's cross section. It's put in the
+		// cell below the plane, where gather_segments picks up its edges, and cut up by the
+		// other planes like any other face so its edges line up with the faces around it
+		range.lo[flat_axis] = range.hi[flat_axis];
+		dice_face(p_faces, i, range, axis_mask & ~(1 << flat_axis), true, 0, skip);
+	}
+}
+
+void Dicer::build_cross_sections() {
+	for (uint32_t a = 0; a < axes.size(); a++) {
+		Axis &axis = axes[a];
+		int stride = axis.stride;
+		uint32_t other_axes = ((1 << axes.size()) - 1) & ~(1 << a);
+
+		// The cell below a plane gets its caps as they are and the one above gets them
+		// with their winding flipped, same as the lower and upper halves of a slice
+		auto emit = [this, stride](const FaceBuffer &p_src, int p_face, int p_cell) {
+			append_cap_face(cells[p_cell].cross_section, p_src, p_face, false);
+			append_cap_face(cells[p_cell + stride].cross_section, p_src, p_face, true);
+		};
+
+		for (uint32_t p = 0; p < axis.offsets.size(); p++) {
+			if (axis.segments[p].size() == 0) {
+				continue;
+			}
+
+			// The caps span the whole plane, so they still need cutting up by the rest of
+			// the grid. Their edges along those cuts are already part of the other planes'
+			// outlines and don't get gathered again
+			FaceBuffer caps = Triangulator::triangulate_segments(axis.segments[p], axis.normal);
+			for (int i = 0; i < caps.size(); i++) {
+				CellRange range = get_face_range(caps, i, other_axes);
+				for (uint32_t b = 0; b < axes.size(); b++) {
+					if (b == a) {
+						range.lo[b] = p;
+						range.hi[b] = p;
+					} else {
+						range.hi[b] = MAX(range.lo[b], range.hi[b]);
+					}
+				}
+				dice_face(caps, i, range, other_axes, false, 0, emit);
+			}
+		}
+	}
+}
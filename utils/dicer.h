@@ -0,0 +1,115 @@
+/**************************************************************************/
+/*  dicer.h                                                               */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef DICER_H
+#define DICER_H
+
+#include "core/templates/local_vector.h"
+#include "face_buffer.h"
+#include "intersector.h"
+
+/**
+ * Cuts surfaces into the cells of a grid of planes in one go. The grid is made up of up
+ * to three axes, each a normal along with a sorted list of parallel planes, and every
+ * face is only ever split by the planes its own extent actually crosses: a face lying
+ * inside a single cell is copied straight into it and one crossing a few planes is split
+ * by those alone, one plane at a time, rather than the whole mesh going through a full
+ * slice for every plane.
+ *
+ * Cells are numbered with the first axis varying fastest. Cell i along an axis is the
+ * slab below its plane i, so an axis with n planes has n + 1 cells
+ */
+struct Dicer {
+	static constexpr int MAX_AXES = 3;
+
+	struct Axis {
+		Vector3 normal;
+		// Plane distances along the normal, in ascending order
+		LocalVector<real_t> offsets;
+		// The cut segments gathered for each plane, see Intersector::SplitResult
+		LocalVector<Vector<Vector3>> segments;
+		int stride = 1;
+	};
+
+	struct Cell {
+		// One buffer per diced surface, in the same order as the surfaces were passed in
+		LocalVector<FaceBuffer> surfaces;
+		// The caps of every plane bounding this cell, already wound to face out of it
+		FaceBuffer cross_section;
+
+		bool is_empty() const;
+	};
+
+	LocalVector<Axis> axes;
+	LocalVector<Cell> cells;
+
+	/**
+	 * Adds an axis of planes sharing the passed in normal. The offsets don't need to be
+	 * sorted and duplicates are dropped. Must be called before begin
+	 */
+	void add_axis(const Vector3 &p_normal, const Vector<real_t> &p_offsets);
+
+	/**
+	 * Sets up every cell to receive the given number of surfaces
+	 */
+	void begin(int p_surface_count);
+
+	/**
+	 * Cuts the faces of one surface into the cells. The faces must not be indexed
+	 */
+	void dice_surface(int p_surface, const FaceBuffer &p_faces);
+
+	/**
+	 * Triangulates the segments gathered on each plane and hands the resulting caps to the
+	 * cells on either side of it, diced by the other axes. Call once every surface is in
+	 */
+	void build_cross_sections();
+
+	int get_cell_count() const;
+
+private:
+	// Which cells along each axis a face may still end up in
+	struct CellRange {
+		int lo[MAX_AXES] = {};
+		int hi[MAX_AXES] = {};
+	};
+
+	// One split result per level of recursion, so splitting a piece again never touches
+	// the buffers the piece itself is being read from
+	LocalVector<Intersector::SplitResult> scratch;
+
+	CellRange get_face_range(const FaceBuffer &p_faces, int p_face, uint32_t p_axis_mask) const;
+	void gather_segments(const FaceBuffer &p_faces, int p_face, const CellRange &p_range);
+
+	template <typename Emit>
+	void dice_face(const FaceBuffer &p_faces, int p_face, const CellRange &p_range, uint32_t p_axis_mask, bool p_gather_segments, int p_depth, const Emit &p_emit);
+};
+
+#endif // DICER_H
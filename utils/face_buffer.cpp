@@ -0,0 +1,384 @@
+/**************************************************************************/
+/*  face_buffer.cpp                                                       */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "face_buffer.h"
+
+#include "core/error/error_macros.h"
+#include "face_filler.h"
+
+template <typename T>
+static _FORCE_INLINE_ void append_stream(LocalVector<T> &r_dst, const LocalVector<T> &p_src, uint32_t p_begin, uint32_t p_count) {
+	uint32_t offset = r_dst.size();
+	r_dst.resize(offset + p_count);
+	for (uint32_t i = 0; i < p_count; i++) {
+		r_dst[offset + i] = p_src[p_begin + i];
+	}
+}
+
+/**
+ * Copies a run of vertices across every stream the buffers carry
+ */
+static void append_vertex_range(FaceBuffer &r_dst, const FaceBuffer &p_src, uint32_t p_begin, uint32_t p_count) {
+	append_stream(r_dst.vertices, p_src.vertices, p_begin, p_count);
+
+	if (r_dst.has(FaceBuffer::ATTRIBUTE_NORMAL)) {
+		append_stream(r_dst.normals, p_src.normals, p_begin, p_count);
+	}
+
+	if (r_dst.has(FaceBuffer::ATTRIBUTE_TANGENT)) {
+		append_stream(r_dst.tangents, p_src.tangents, p_begin, p_count);
+	}
+
+	if (r_dst.has(FaceBuffer::ATTRIBUTE_COLOR)) {
+		append_stream(r_dst.colors, p_src.colors, p_begin, p_count);
+	}
+
+	if (r_dst.has(FaceBuffer::ATTRIBUTE_BONES)) {
+		append_stream(r_dst.bones, p_src.bones, p_begin, p_count);
+	}
+
+	if (r_dst.has(FaceBuffer::ATTRIBUTE_WEIGHTS)) {
+		append_stream(r_dst.weights, p_src.weights, p_begin, p_count);
+	}
+
+	if (r_dst.has(FaceBuffer::ATTRIBUTE_UV)) {
+		append_stream(r_dst.uvs, p_src.uvs, p_begin, p_count);
+	}
+
+	if (r_dst.has(FaceBuffer::ATTRIBUTE_UV2)) {
+		append_stream(r_dst.uv2s, p_src.uv2s, p_begin, p_count);
+	}
+}
+
+template <typename T>
+static _FORCE_INLINE_ void swap_last_corners(LocalVector<T> &r_stream) {
+	for (uint32_t i = 0; i + 2 < r_stream.size(); i += 3) {
+		SWAP(r_stream[i + 1], r_stream[i + 2]);
+	}
+}
+
+FaceBuffer FaceBuffer::faces_from_arrays(const Array &arrays, bool p_preserve_indices) {
+	FaceBuffer faces;
+	ERR_FAIL_COND_V(arrays.size() != Mesh::ARRAY_MAX, faces);
+	Vector<Vector3> positions = arrays[Mesh::ARRAY_VERTEX];
+	Vector<int> indices = arrays[Mesh::ARRAY_INDEX];
+	bool is_index_array = indices.size() > 0;
+	int vert_count = is_index_array ? indices.size() : positions.size();
+	if (vert_count == 0 || vert_count % 3 != 0) {
+		return faces;
+	}
+
+	FaceFiller filler(faces, arrays);
+
+	if (is_index_array && p_preserve_indices) {
+		// Keep the surface's own layout: every unique vertex is read once and the faces
+		// simply point at them
+		faces.set_format(faces.format | FaceBuffer::ATTRIBUTE_INDEX);
+		int unique_count = positions.size();
+		faces.resize_vertices(unique_count);
+		filler.fill_vertices(unique_count);
+
+		const int *indices_ptr = indices.ptr();
+		faces.resize(vert_count / 3);
+		for (int i = 0; i < vert_count; i++) {
+			ERR_FAIL_INDEX_V(indices_ptr[i], unique_count, FaceBuffer());
+			faces.indices[i] = indices_ptr[i];
+		}
+
+		return faces;
+	}
+
+	faces.resize(vert_count / 3);
+
+	if (is_index_array) {
+		filler.fill_vertices(vert_count, indices.ptr());
+	} else {
+		filler.fill_vertices(vert_count);
+	}
+
+	return faces;
+}
+
+FaceBuffer FaceBuffer::faces_from_surface(const Ref<Mesh> mesh, int surface_idx, bool p_preserve_indices) {
+	ERR_FAIL_COND_V(mesh.is_null(), FaceBuffer());
+	ERR_FAIL_INDEX_V(surface_idx, mesh->get_surface_count(), FaceBuffer());
+	// Slicer functionality really only makes sense in the context of a mesh composed of
+	// triangles
+	if (mesh->surface_get_primitive_type(surface_idx) != Mesh::PRIMITIVE_TRIANGLES) {
+		return FaceBuffer();
+	}
+
+	return faces_from_arrays(mesh->surface_get_arrays(surface_idx), p_preserve_indices);
+}
+
+AABB FaceBuffer::get_aabb() const {
+	AABB aabb;
+	if (vertices.size() == 0) {
+		return aabb;
+	}
+
+	aabb.position = vertices[0];
+	for (uint32_t i = 1; i < vertices.size(); i++) {
+		aabb.expand_to(vertices[i]);
+	}
+	return aabb;
+}
+
+uint64_t FaceBuffer::get_memory_usage() const {
+	return vertices.size() * sizeof(Vector3) +
+			normals.size() * sizeof(Vector3) +
+			tangents.size() * sizeof(Vector4) +
+			colors.size() * sizeof(Color) +
+			bones.size() * sizeof(Vector4) +
+			weights.size() * sizeof(Vector4) +
+			uvs.size() * sizeof(Vector2) +
+			uv2s.size() * sizeof(Vector2) +
+			indices.size() * sizeof(int);
+}
+
+void FaceBuffer::set_format(uint32_t p_format) {
+	// Switching formats with faces already stored would leave the streams out of step
+	// with each other
+	ERR_FAIL_COND(size() != 0 && p_format != format);
+	format = p_format;
+}
+
+void FaceBuffer::resize(int p_faces) {
+	if (is_indexed()) {
+		indices.resize(p_faces * 3);
+	} else {
+		resize_vertices(p_faces * 3);
+	}
+}
+
+void FaceBuffer::resize_vertices(int p_vertices) {
+	vertices.resize(p_vertices);
+
+	if (has(ATTRIBUTE_NORMAL)) {
+		normals.resize(p_vertices);
+	}
+
+	if (has(ATTRIBUTE_TANGENT)) {
+		tangents.resize(p_vertices);
+	}
+
+	if (has(ATTRIBUTE_COLOR)) {
+		colors.resize(p_vertices);
+	}
+
+	if (has(ATTRIBUTE_BONES)) {
+		bones.resize(p_vertices);
+	}
+
+	if (has(ATTRIBUTE_WEIGHTS)) {
+		weights.resize(p_vertices);
+	}
+
+	if (has(ATTRIBUTE_UV)) {
+		uvs.resize(p_vertices);
+	}
+
+	if (has(ATTRIBUTE_UV2)) {
+		uv2s.resize(p_vertices);
+	}
+}
+
+void FaceBuffer::reserve_vertices(int p_vertices) {
+	vertices.reserve(p_vertices);
+
+	if (has(ATTRIBUTE_NORMAL)) {
+		normals.reserve(p_vertices);
+	}
+
+	if (has(ATTRIBUTE_TANGENT)) {
+		tangents.reserve(p_vertices);
+	}
+
+	if (has(ATTRIBUTE_COLOR)) {
+		colors.reserve(p_vertices);
+	}
+
+	if (has(ATTRIBUTE_BONES)) {
+		bones.reserve(p_vertices);
+	}
+
+	if (has(ATTRIBUTE_WEIGHTS)) {
+		weights.reserve(p_vertices);
+	}
+
+	if (has(ATTRIBUTE_UV)) {
+		uvs.reserve(p_vertices);
+	}
+
+	if (has(ATTRIBUTE_UV2)) {
+		uv2s.reserve(p_vertices);
+	}
+}
+
+void FaceBuffer::clear() {
+	vertices.clear();
+	normals.clear();
+	tangents.clear();
+	colors.clear();
+	bones.clear();
+	weights.clear();
+	uvs.clear();
+	uv2s.clear();
+	indices.clear();
+}
+
+void FaceBuffer::append_faces(const FaceBuffer &p_src) {
+	DEV_ASSERT(p_src.format == format);
+
+	uint32_t vertex_offset = vertices.size();
+	append_vertex_range(*this, p_src, 0, p_src.vertices.size());
+
+	if (is_indexed()) {
+		uint32_t index_offset = indices.size();
+		indices.resize(index_offset + p_src.indices.size());
+		for (uint32_t i = 0; i < p_src.indices.size(); i++) {
+			indices[index_offset + i] = p_src.indices[i] + vertex_offset;
+		}
+	}
+}
+
+void FaceBuffer::append_face_range(const FaceBuffer &p_src, int p_begin, int p_count) {
+	DEV_ASSERT(p_src.format == format && !is_indexed());
+	append_vertex_range(*this, p_src, p_begin * 3, p_count * 3);
+}
+
+void FaceBuffer::reorder_faces(const LocalVector<int> &p_order) {
+	ERR_FAIL_COND((int)p_order.size() != size());
+
+	if (is_indexed()) {
+		// Only the faces move, the vertices they point at can stay put
+		LocalVector<int> reordered;
+		reordered.resize(indices.size());
+		for (uint32_t i = 0; i < p_order.size(); i++) {
+			reordered[i * 3] = indices[p_order[i] * 3];
+			reordered[i * 3 + 1] = indices[p_order[i] * 3 + 1];
+			reordered[i * 3 + 2] = indices[p_order[i] * 3 + 2];
+		}
+		indices = reordered;
+		return;
+	}
+
+	FaceBuffer reordered;
+	reordered.set_format(format);
+	for (uint32_t i = 0; i < p_order.size(); i++) {
+		append_vertex_range(reordered, *this, p_order[i] * 3, 3);
+	}
+	*this = reordered;
+}
+
+void FaceBuffer::flip_winding() {
+	if (is_indexed()) {
+		swap_last_corners(indices);
+		return;
+	}
+
+	swap_last_corners(vertices);
+	swap_last_corners(normals);
+	swap_last_corners(tangents);
+	swap_last_corners(colors);
+	swap_last_corners(bones);
+	swap_last_corners(weights);
+	swap_last_corners(uvs);
+	swap_last_corners(uv2s);
+}
+
+SlicerFace FaceBuffer::get_face(int p_face) const {
+	ERR_FAIL_INDEX_V(p_face, size(), SlicerFace());
+	int a = get_vertex_index(p_face, 0);
+	int b = get_vertex_index(p_face, 1);
+	int c = get_vertex_index(p_face, 2);
+	SlicerFace face(vertices[a], vertices[b], vertices[c]);
+
+	if (has(ATTRIBUTE_NORMAL)) {
+		face.set_normals(normals[a], normals[b], normals[c]);
+	}
+
+	if (has(ATTRIBUTE_TANGENT)) {
+		face.set_tangents(tangents[a], tangents[b], tangents[c]);
+	}
+
+	if (has(ATTRIBUTE_COLOR)) {
+		face.set_colors(colors[a], colors[b], colors[c]);
+	}
+
+	if (has(ATTRIBUTE_BONES)) {
+		face.set_bones(bones[a], bones[b], bones[c]);
+	}
+
+	if (has(ATTRIBUTE_WEIGHTS)) {
+		face.set_weights(weights[a], weights[b], weights[c]);
+	}
+
+	if (has(ATTRIBUTE_UV)) {
+		face.set_uvs(uvs[a], uvs[b], uvs[c]);
+	}
+
+	if (has(ATTRIBUTE_UV2)) {
+		face.set_uv2s(uv2s[a], uv2s[b], uv2s[c]);
+	}
+
+	return face;
+}
+
+void FaceBuffer::compute_tangents(int p_face) {
+	// computing tangents requires both UV and normals set, and somewhere to put them
+	if (!has(ATTRIBUTE_NORMAL) || !has(ATTRIBUTE_UV) || !has(ATTRIBUTE_TANGENT)) {
+		return;
+	}
+
+	if (!is_indexed()) {
+		int base = p_face * 3;
+		SlicerFace::compute_tangents(&vertices[base], &normals[base], &uvs[base], &tangents[base]);
+		return;
+	}
+
+	// Shared vertices simply take the tangent of the last face computed for them
+	Vector3 face_vertices[3];
+	Vector3 face_normals[3];
+	Vector2 face_uvs[3];
+	Vector4 face_tangents[3];
+	for (int i = 0; i < 3; i++) {
+		int idx = get_vertex_index(p_face, i);
+		face_vertices[i] = vertices[idx];
+		face_normals[i] = normals[idx];
+		face_uvs[i] = uvs[idx];
+	}
+
+	SlicerFace::compute_tangents(face_vertices, face_normals, face_uvs, face_tangents);
+
+	for (int i = 0; i < 3; i++) {
+		tangents[get_vertex_index(p_face, i)] = face_tangents[i];
+	}
+}
@@ -0,0 +1,325 @@
+/**************************************************************************/
+/*  face_buffer.h                                                         */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef FACE_BUFFER_H
+#define FACE_BUFFER_H
+
+#include "core/error/error_macros.h"
+#include "core/templates/local_vector.h"
+#include "slicer_face.h"
+
+/**
+ * Structure of arrays storage for a list of triangles. Each attribute lives in
+ * its own contiguous stream with three entries per face, and only the streams
+ * named in `format` are ever populated. A surface with just vertices and uvs
+ * therefore never pays for normals, colors, bones and so on, and appending a
+ * face only touches the streams that actually exist.
+ *
+ * When ATTRIBUTE_INDEX is part of the format the streams instead hold each unique
+ * vertex once and `indices` describes the faces, three entries per face, the same
+ * way an indexed mesh surface does.
+ */
+struct FaceBuffer {
+	enum Attribute {
+		ATTRIBUTE_NORMAL = 1 << 0,
+		ATTRIBUTE_TANGENT = 1 << 1,
+		ATTRIBUTE_COLOR = 1 << 2,
+		ATTRIBUTE_BONES = 1 << 3,
+		ATTRIBUTE_WEIGHTS = 1 << 4,
+		ATTRIBUTE_UV = 1 << 5,
+		ATTRIBUTE_UV2 = 1 << 6,
+		// Not a vertex stream, marks that faces are described by `indices`
+		ATTRIBUTE_INDEX = 1 << 7,
+		// Every bit which corresponds to an actual vertex stream
+		ATTRIBUTE_STREAMS = ATTRIBUTE_INDEX - 1,
+	};
+
+	// Stands in for a real format in the templated methods below when the attributes
+	// aren't known until runtime, in which case they check `format` as they go
+	static constexpr uint32_t FORMAT_DYNAMIC = UINT32_MAX;
+
+	uint32_t format = 0;
+
+	LocalVector<Vector3> vertices;
+	LocalVector<Vector3> normals;
+	LocalVector<Vector4> tangents;
+	LocalVector<Color> colors;
+	LocalVector<Vector4> bones;
+	LocalVector<Vector4> weights;
+	LocalVector<Vector2> uvs;
+	LocalVector<Vector2> uv2s;
+
+	LocalVector<int> indices;
+
+	/**
+	 * Parse a mesh's surface into a buffer of faces. This will preserve the mapping
+	 * associated with each vertex and can handle both indexed and non indexed vertex
+	 * arrays. Indexed arrays are expanded into loose faces unless p_preserve_indices
+	 * is set, in which case the buffer keeps the surface's own index array
+	 */
+	static FaceBuffer faces_from_surface(const Ref<Mesh> mesh, int surface_idx, bool p_preserve_indices = false);
+
+	/**
+	 * Same as faces_from_surface, for when the surface's arrays have already been read
+	 * out of the mesh. The arrays are assumed to describe triangles
+	 */
+	static FaceBuffer faces_from_arrays(const Array &arrays, bool p_preserve_indices = false);
+
+	_FORCE_INLINE_ int size() const {
+		return is_indexed() ? indices.size() / 3 : vertices.size() / 3;
+	}
+
+	_FORCE_INLINE_ bool has(uint32_t p_attribute) const {
+		return (format & p_attribute) != 0;
+	}
+
+	/**
+	 * Same as has(), except when FORMAT is known at compile time the check gets folded
+	 * away entirely, leaving no branches behind in the per vertex loops
+	 */
+	template <uint32_t FORMAT>
+	_FORCE_INLINE_ bool has_attribute(uint32_t p_attribute) const {
+		if constexpr (FORMAT == FORMAT_DYNAMIC) {
+			return has(p_attribute);
+		} else {
+			return (FORMAT & p_attribute) != 0;
+		}
+	}
+
+	/**
+	 * Whether a specialization for FORMAT is allowed to operate on this buffer
+	 */
+	template <uint32_t FORMAT>
+	_FORCE_INLINE_ bool is_format() const {
+		return FORMAT == FORMAT_DYNAMIC || FORMAT == (format & ATTRIBUTE_STREAMS);
+	}
+
+	_FORCE_INLINE_ bool is_indexed() const {
+		return has(ATTRIBUTE_INDEX);
+	}
+
+	/**
+	 * Whether both buffers carry the same vertex streams, regardless of how their
+	 * faces are laid out
+	 */
+	_FORCE_INLINE_ bool has_same_attributes(const FaceBuffer &p_other) const {
+		return (format & ~ATTRIBUTE_INDEX) == (p_other.format & ~ATTRIBUTE_INDEX);
+	}
+
+	/**
+	 * The position in the vertex streams of one of a face's three corners
+	 */
+	_FORCE_INLINE_ int get_vertex_index(int p_face, int p_corner) const {
+		return is_indexed() ? indices[p_face * 3 + p_corner] : p_face * 3 + p_corner;
+	}
+
+	/**
+	 * The bounds of every vertex in the buffer
+	 */
+	AABB get_aabb() const;
+
+	/**
+	 * Roughly how many bytes the buffer's streams are holding on to
+	 */
+	uint64_t get_memory_usage() const;
+
+	/**
+	 * Sets which attribute streams this buffer carries. This can only be changed
+	 * while the buffer is empty
+	 */
+	void set_format(uint32_t p_format);
+
+	/**
+	 * Resizes the buffer to hold the given number of faces. For indexed buffers this
+	 * only resizes the index array, see resize_vertices
+	 */
+	void resize(int p_faces);
+
+	/**
+	 * Resizes every active vertex stream to hold the given number of vertices
+	 */
+	void resize_vertices(int p_vertices);
+
+	/**
+	 * Makes room for the given number of vertices in every active vertex stream without
+	 * adding any, so appending up to that many never has to grow them
+	 */
+	void reserve_vertices(int p_vertices);
+
+	/**
+	 * Removes all faces while keeping the allocated capacity around for reuse
+	 */
+	void clear();
+
+	// The append methods below are templated on the buffer's attribute streams, see
+	// FormatDispatch for picking a specialization once per surface. Called without a
+	// template argument they fall back to checking the format at runtime
+
+	/**
+	 * Copies a single vertex from another buffer with the same attributes and
+	 * returns its position in this buffer's streams
+	 */
+	template <uint32_t FORMAT = FORMAT_DYNAMIC>
+	int append_vertex(const FaceBuffer &p_src, int p_vertex);
+
+	/**
+	 * Adds a new vertex at `t` along the edge between two of p_src's vertices,
+	 * interpolating every attribute along the way, and returns its position in
+	 * this buffer's streams
+	 */
+	template <uint32_t FORMAT = FORMAT_DYNAMIC>
+	int append_edge_vertex(const FaceBuffer &p_src, int p_from, int p_to, real_t t);
+
+	/**
+	 * Copies a single face from another buffer with the same format
+	 */
+	template <uint32_t FORMAT = FORMAT_DYNAMIC>
+	void append_face(const FaceBuffer &p_src, int p_face);
+
+	/**
+	 * Copies every face from another buffer with the same format
+	 */
+	void append_faces(const FaceBuffer &p_src);
+
+	/**
+	 * Copies p_count faces starting from p_begin in one go, stream by stream. Both buffers
+	 * need the same format and, since the vertices are copied as they are, must not be
+	 * indexed
+	 */
+	void append_face_range(const FaceBuffer &p_src, int p_begin, int p_count);
+
+	/**
+	 * Rearranges the faces so that face i becomes what used to be face p_order[i]
+	 */
+	void reorder_faces(const LocalVector<int> &p_order);
+
+	/**
+	 * Turns every face around by swapping its last two corners
+	 */
+	void flip_winding();
+
+	/**
+	 * Gathers a single face back into its AoS form. Mostly useful for tests and debugging
+	 */
+	SlicerFace get_face(int p_face) const;
+
+	/**
+	 * Uses normal and UV information to generate tangents for each point in the face
+	 */
+	void compute_tangents(int p_face);
+};
+
+template <uint32_t FORMAT>
+int FaceBuffer::append_vertex(const FaceBuffer &p_src, int p_vertex) {
+	DEV_ASSERT(has_same_attributes(p_src) && is_format<FORMAT>());
+
+	vertices.push_back(p_src.vertices[p_vertex]);
+
+	if (has_attribute<FORMAT>(ATTRIBUTE_NORMAL)) {
+		normals.push_back(p_src.normals[p_vertex]);
+	}
+
+	if (has_attribute<FORMAT>(ATTRIBUTE_TANGENT)) {
+		tangents.push_back(p_src.tangents[p_vertex]);
+	}
+
+	if (has_attribute<FORMAT>(ATTRIBUTE_COLOR)) {
+		colors.push_back(p_src.colors[p_vertex]);
+	}
+
+	if (has_attribute<FORMAT>(ATTRIBUTE_BONES)) {
+		bones.push_back(p_src.bones[p_vertex]);
+	}
+
+	if (has_attribute<FORMAT>(ATTRIBUTE_WEIGHTS)) {
+		weights.push_back(p_src.weights[p_vertex]);
+	}
+
+	if (has_attribute<FORMAT>(ATTRIBUTE_UV)) {
+		uvs.push_back(p_src.uvs[p_vertex]);
+	}
+
+	if (has_attribute<FORMAT>(ATTRIBUTE_UV2)) {
+		uv2s.push_back(p_src.uv2s[p_vertex]);
+	}
+
+	return vertices.size() - 1;
+}
+
+template <uint32_t FORMAT>
+int FaceBuffer::append_edge_vertex(const FaceBuffer &p_src, int p_from, int p_to, real_t t) {
+	DEV_ASSERT(has_same_attributes(p_src) && is_format<FORMAT>());
+
+	vertices.push_back(p_src.vertices[p_from].lerp(p_src.vertices[p_to], t));
+
+	if (has_attribute<FORMAT>(ATTRIBUTE_NORMAL)) {
+		normals.push_back(p_src.normals[p_from].lerp(p_src.normals[p_to], t));
+	}
+
+	if (has_attribute<FORMAT>(ATTRIBUTE_TANGENT)) {
+		tangents.push_back(p_src.tangents[p_from].lerp(p_src.tangents[p_to], t));
+	}
+
+	if (has_attribute<FORMAT>(ATTRIBUTE_COLOR)) {
+		colors.push_back(p_src.colors[p_from].lerp(p_src.colors[p_to], t));
+	}
+
+	if (has_attribute<FORMAT>(ATTRIBUTE_BONES)) {
+		bones.push_back(p_src.bones[p_from].lerp(p_src.bones[p_to], t));
+	}
+
+	if (has_attribute<FORMAT>(ATTRIBUTE_WEIGHTS)) {
+		weights.push_back(p_src.weights[p_from].lerp(p_src.weights[p_to], t));
+	}
+
+	if (has_attribute<FORMAT>(ATTRIBUTE_UV)) {
+		uvs.push_back(p_src.uvs[p_from].lerp(p_src.uvs[p_to], t));
+	}
+
+	if (has_attribute<FORMAT>(ATTRIBUTE_UV2)) {
+		uv2s.push_back(p_src.uv2s[p_from].lerp(p_src.uv2s[p_to], t));
+	}
+
+	return vertices.size() - 1;
+}
+
+template <uint32_t FORMAT>
+void FaceBuffer::append_face(const FaceBuffer &p_src, int p_face) {
+	DEV_ASSERT(has_same_attributes(p_src) && is_format<FORMAT>());
+
+	for (int i = 0; i < 3; i++) {
+		int vertex_idx = append_vertex<FORMAT>(p_src, p_src.get_vertex_index(p_face, i));
+		if (is_indexed()) {
+			indices.push_back(vertex_idx);
+		}
+	}
+}
+
+#endif // FACE_BUFFER_H
@@ -0,0 +1,115 @@
+/**************************************************************************/
+/*  face_bvh.cpp                                                          */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "face_bvh.h"
+
+void FaceBVH::build(FaceBuffer &r_faces) {
+	nodes.clear();
+	int face_count = r_faces.size();
+	if (face_count == 0) {
+		return;
+	}
+
+	LocalVector<int> order;
+	LocalVector<AABB> face_aabbs;
+	LocalVector<Vector3> centroids;
+	order.resize(face_count);
+	face_aabbs.resize(face_count);
+	centroids.resize(face_count);
+
+	for (int i = 0; i < face_count; i++) {
+		order[i] = i;
+		AABB aabb(r_faces.vertices[r_faces.get_vertex_index(i, 0)], Vector3());
+		aabb.expand_to(r_faces.vertices[r_faces.get_vertex_index(i, 1)]);
+		aabb.expand_to(r_faces.vertices[r_faces.get_vertex_index(i, 2)]);
+		face_aabbs[i] = aabb;
+		centroids[i] = aabb.get_center();
+	}
+
+	Node root;
+	root.count = face_count;
+	nodes.push_back(root);
+
+	LocalVector<int> stack;
+	stack.push_back(0);
+	while (stack.size() > 0) {
+		int node_idx = stack[stack.size() - 1];
+		stack.resize(stack.size() - 1);
+
+		// Copied out since adding the children below can move the nodes around
+		Node node = nodes[node_idx];
+		AABB aabb = face_aabbs[order[node.begin]];
+		AABB centroid_bounds(centroids[order[node.begin]], Vector3());
+		for (int i = node.begin + 1; i < node.begin + node.count; i++) {
+			aabb.merge_with(face_aabbs[order[i]]);
+			centroid_bounds.expand_to(centroids[order[i]]);
+		}
+		nodes[node_idx].aabb = aabb;
+
+		if (node.count <= LEAF_SIZE) {
+			continue;
+		}
+
+		// Split down the middle of the longest side of the box around the faces' centers,
+		// which keeps things cheap to build while still giving each child a tight box
+		int axis = centroid_bounds.get_longest_axis_index();
+		real_t middle = centroid_bounds.get_center()[axis];
+		int i = node.begin;
+		int j = node.begin + node.count - 1;
+		while (i <= j) {
+			if (centroids[order[i]][axis] < middle) {
+				i++;
+			} else {
+				SWAP(order[i], order[j]);
+				j--;
+			}
+		}
+
+		// Every center landing on the same side means they're all bunched up in the same
+		// spot, in which case there's nothing better to do than split them by count
+		int left_count = i - node.begin;
+		if (left_count == 0 || left_count == node.count) {
+			left_count = node.count / 2;
+		}
+
+		int left = nodes.size();
+		nodes.resize(left + 2);
+		nodes[node_idx].left = left;
+		nodes[left].begin = node.begin;
+		nodes[left].count = left_count;
+		nodes[left + 1].begin = node.begin + left_count;
+		nodes[left + 1].count = node.count - left_count;
+
+		stack.push_back(left + 1);
+		stack.push_back(left);
+	}
+
+	r_faces.reorder_faces(order);
+}
@@ -0,0 +1,77 @@
+/**************************************************************************/
+/*  face_bvh.h                                                            */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef FACE_BVH_H
+#define FACE_BVH_H
+
+#include "core/templates/local_vector.h"
+#include "face_buffer.h"
+
+/**
+ * A bounding volume hierarchy over the faces of a FaceBuffer. Building the tree reorders
+ * the buffer's faces so that every node covers one contiguous run of them, which lets a
+ * slice hand whole subtrees lying on one side of the plane over in bulk and only look at
+ * the individual faces of the leaves that actually straddle it
+ */
+struct FaceBVH {
+	// The most faces a node holds before it gets split in two
+	static constexpr int LEAF_SIZE = 16;
+
+	struct Node {
+		AABB aabb;
+		int begin = 0;
+		int count = 0;
+		// The children are always stored next to each other, so the right one is at
+		// left + 1. -1 for leaves
+		int left = -1;
+
+		_FORCE_INLINE_ bool is_leaf() const {
+			return left == -1;
+		}
+	};
+
+	// The root, when there is one, is always the first node
+	LocalVector<Node> nodes;
+
+	/**
+	 * Builds the tree for the passed in faces, reordering them along the way
+	 */
+	void build(FaceBuffer &r_faces);
+
+	_FORCE_INLINE_ bool is_empty() const {
+		return nodes.size() == 0;
+	}
+
+	uint64_t get_memory_usage() const {
+		return nodes.size() * sizeof(Node);
+	}
+};
+
+#endif // FACE_BVH_H
@@ -31,12 +31,13 @@
 #ifndef FACE_FILLER_H
 #define FACE_FILLER_H
 
-#include "slicer_face.h"
+#include "face_buffer.h"
+#include "format_dispatch.h"
 
 /**
  * Responsible for serializing data from vertex arrays, as they are
- * given from the visual server, into an array of SlicerFaces while
- * maintaining info about things such as normals and uvs etc.
+ * given from the visual server, into a FaceBuffer while maintaining
+ * info about things such as normals and uvs etc.
  */
 struct FaceFiller {
 	bool has_normals;
@@ -62,10 +63,10 @@ struct FaceFiller {
 	Vector<Vector2> uvs;
 
 	Vector<Vector2> uv2s;
-	Vector<SlicerFace> &faces;
+	FaceBuffer &faces;
 
 	// Yuck. What an eye sore this constructor is
-	FaceFiller(Vector<SlicerFace> &r_faces, const Array &p_surface_arrays) :
+	FaceFiller(FaceBuffer &r_faces, const Array &p_surface_arrays) :
 			faces(r_faces) {
 		vertices = p_surface_arrays[Mesh::ARRAY_VERTEX];
 
@@ -89,76 +90,97 @@ struct FaceFiller {
 
 		uv2s = p_surface_arrays[Mesh::ARRAY_TEX_UV2];
 		has_uv2s = uv2s.size() > 0 && uv2s.size() == vertices.size();
+
+		uint32_t format = 0;
+		format |= has_normals ? FaceBuffer::ATTRIBUTE_NORMAL : 0;
+		format |= has_tangents ? FaceBuffer::ATTRIBUTE_TANGENT : 0;
+		format |= has_colors ? FaceBuffer::ATTRIBUTE_COLOR : 0;
+		format |= has_bones ? FaceBuffer::ATTRIBUTE_BONES : 0;
+		format |= has_weights ? FaceBuffer::ATTRIBUTE_WEIGHTS : 0;
+		format |= has_uvs ? FaceBuffer::ATTRIBUTE_UV : 0;
+		format |= has_uv2s ? FaceBuffer::ATTRIBUTE_UV2 : 0;
+		faces.set_format(format);
 	}
 
 	/**
 	 * Takes data from the vertex array using the lookup_idx and puts it into
-	 * our face vector using set_idx
+	 * our face buffer using set_idx. The buffer needs to already be sized to fit
 	 */
+	template <uint32_t FORMAT = FaceBuffer::FORMAT_DYNAMIC>
 	_FORCE_INLINE_ void fill(int set_idx, int lookup_idx) {
 		// Having this function work vertex by vertex makes the code a bit nicer,
-		// especially with having to support indexed and non-indexed vertices,
-		// but just performance-wise I hate it. There's no reason, besides uglier
-		// and more complicated code, why we can't be doing these has_* checks on
-		// a per face basis. Maybe even a per mesh basis. Admitidly it'll probably
-		// all come out in the wash, but it bothers me conceptually. Let's put in
-		// a TODO about it. Maybe there's something incredibly clever we can do with
-		// macros that *won't* make me want to tear out what's left of my hair.
-		int face_idx = set_idx / 3;
-		int set_offset = set_idx % 3;
-
-		if (set_offset == 0) {
-			faces.write[face_idx].has_normals = has_normals;
-			faces.write[face_idx].has_tangents = has_tangents;
-			faces.write[face_idx].has_colors = has_colors;
-			faces.write[face_idx].has_bones = has_bones;
-			faces.write[face_idx].has_weights = has_weights;
-			faces.write[face_idx].has_uvs = has_uvs;
-			faces.write[face_idx].has_uv2s = has_uv2s;
-		}
-		faces.write[face_idx].vertex[set_offset] = vertices[lookup_idx].snapped(Vector3(0.0001, 0.0001, 0.0001));
-
-		if (has_normals) {
-			faces.write[face_idx].normal[set_offset] = normals[lookup_idx];
+		// especially with having to support indexed and non-indexed vertices.
+		// The attribute checks used to bother me conceptually, happening for every
+		// single vertex when they only ever change per mesh, but called through
+		// fill_vertices they're resolved at compile time and simply disappear
+		DEV_ASSERT(faces.is_format<FORMAT>());
+		faces.vertices[set_idx] = vertices[lookup_idx].snapped(Vector3(0.0001, 0.0001, 0.0001));
+
+		if (faces.has_attribute<FORMAT>(FaceBuffer::ATTRIBUTE_NORMAL)) {
+			faces.normals[set_idx] = normals[lookup_idx];
 		}
 
-		if (has_tangents) {
-			faces.write[face_idx].tangent[set_offset] = Vector4(
+		if (faces.has_attribute<FORMAT>(FaceBuffer::ATTRIBUTE_TANGENT)) {
+			faces.tangents[set_idx] = Vector4(
 					tangents[lookup_idx * 4 + 0],
 					tangents[lookup_idx * 4 + 1],
 					tangents[lookup_idx * 4 + 2],
 					tangents[lookup_idx * 4 + 3]);
 		}
 
-		if (has_colors) {
-			faces.write[face_idx].color[set_offset] = colors[lookup_idx];
+		if (faces.has_attribute<FORMAT>(FaceBuffer::ATTRIBUTE_COLOR)) {
+			faces.colors[set_idx] = colors[lookup_idx];
 		}
 
-		if (has_bones) {
-			faces.write[face_idx].bones[set_offset] = Vector4(
+		if (faces.has_attribute<FORMAT>(FaceBuffer::ATTRIBUTE_BONES)) {
+			faces.bones[set_idx] = Vector4(
 					bones[lookup_idx * 4],
 					bones[lookup_idx * 4 + 1],
 					bones[lookup_idx * 4 + 2],
 					bones[lookup_idx * 4 + 3]);
 		}
 
-		if (has_weights) {
-			faces.write[face_idx].weights[set_offset] = Vector4(
-					weights[lookup_idx],
+		if (faces.has_attribute<FORMAT>(FaceBuffer::ATTRIBUTE_WEIGHTS)) {
+			faces.weights[set_idx] = Vector4(
+					weights[lookup_idx * 4],
 					weights[lookup_idx * 4 + 1],
 					weights[lookup_idx * 4 + 2],
 					weights[lookup_idx * 4 + 3]);
 		}
 
-		if (has_uvs) {
-			faces.write[face_idx].uv[set_offset] = uvs[lookup_idx];
+		if (faces.has_attribute<FORMAT>(FaceBuffer::ATTRIBUTE_UV)) {
+			faces.uvs[set_idx] = uvs[lookup_idx];
 		}
 
-		if (has_uv2s) {
-			faces.write[face_idx].uv2[set_offset] = uv2s[lookup_idx];
+		if (faces.has_attribute<FORMAT>(FaceBuffer::ATTRIBUTE_UV2)) {
+			faces.uv2s[set_idx] = uv2s[lookup_idx];
 		}
 	}
 
+	/**
+	 * Fills the first p_count vertices of the buffer, reading each one through p_lookup
+	 * when given or one to one otherwise. The attribute checks are picked once up front
+	 * for the whole run
+	 */
+	void fill_vertices(int p_count, const int *p_lookup = nullptr) {
+		FormatDispatch::dispatch<FillVertices>(faces.format, *this, p_count, p_lookup);
+	}
+
+	struct FillVertices {
+		template <uint32_t FORMAT>
+		static void run(FaceFiller &filler, int p_count, const int *p_lookup) {
+			if (p_lookup) {
+				for (int i = 0; i < p_count; i++) {
+					filler.fill<FORMAT>(i, p_lookup[i]);
+				}
+			} else {
+				for (int i = 0; i < p_count; i++) {
+					filler.fill<FORMAT>(i, i);
+				}
+			}
+		}
+	};
+
 	~FaceFiller() {
 	}
 };
@@ -0,0 +1,90 @@
+/**************************************************************************/
+/*  format_dispatch.h                                                     */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef FORMAT_DISPATCH_H
+#define FORMAT_DISPATCH_H
+
+#include "face_buffer.h"
+
+/**
+ * Picks a compile time specialization of a kernel for a FaceBuffer format. Only the
+ * formats meshes commonly come in get their own specialization, baking in every
+ * ATTRIBUTE_* check so the per vertex loops don't branch and only ever touch streams
+ * which exist. Anything else runs the FORMAT_DYNAMIC version, which checks the format
+ * at runtime like before.
+ *
+ * A kernel is any type with a `template <uint32_t FORMAT> static void run(...)` method.
+ * Dispatch should happen once per surface rather than once per face or vertex
+ */
+namespace FormatDispatch {
+enum CommonFormat : uint32_t {
+	// Positions, normals and UVs, by far the most common layout and the one we care
+	// about most
+	FORMAT_NORMAL_UV = FaceBuffer::ATTRIBUTE_NORMAL | FaceBuffer::ATTRIBUTE_UV,
+	// What Godot's primitive meshes, our own cross sections and most imports end up with
+	FORMAT_NORMAL_TANGENT_UV = FORMAT_NORMAL_UV | FaceBuffer::ATTRIBUTE_TANGENT,
+	// Lightmapped meshes
+	FORMAT_NORMAL_UV_UV2 = FORMAT_NORMAL_UV | FaceBuffer::ATTRIBUTE_UV2,
+	FORMAT_NORMAL_TANGENT_UV_UV2 = FORMAT_NORMAL_TANGENT_UV | FaceBuffer::ATTRIBUTE_UV2,
+	// Vertex colored meshes
+	FORMAT_NORMAL_COLOR_UV = FORMAT_NORMAL_UV | FaceBuffer::ATTRIBUTE_COLOR,
+	// Skinned meshes
+	FORMAT_SKINNED = FORMAT_NORMAL_TANGENT_UV | FaceBuffer::ATTRIBUTE_BONES | FaceBuffer::ATTRIBUTE_WEIGHTS,
+};
+
+template <class Kernel, class... Args>
+_FORCE_INLINE_ void dispatch(uint32_t p_format, Args &&...p_args) {
+	switch (p_format & FaceBuffer::ATTRIBUTE_STREAMS) {
+		case FORMAT_NORMAL_UV:
+			Kernel::template run<FORMAT_NORMAL_UV>(p_args...);
+			break;
+		case FORMAT_NORMAL_TANGENT_UV:
+			Kernel::template run<FORMAT_NORMAL_TANGENT_UV>(p_args...);
+			break;
+		case FORMAT_NORMAL_UV_UV2:
+			Kernel::template run<FORMAT_NORMAL_UV_UV2>(p_args...);
+			break;
+		case FORMAT_NORMAL_TANGENT_UV_UV2:
+			Kernel::template run<FORMAT_NORMAL_TANGENT_UV_UV2>(p_args...);
+			break;
+		case FORMAT_NORMAL_COLOR_UV:
+			Kernel::template run<FORMAT_NORMAL_COLOR_UV>(p_args...);
+			break;
+		case FORMAT_SKINNED:
+			Kernel::template run<FORMAT_SKINNED>(p_args...);
+			break;
+		default:
+			Kernel::template run<FaceBuffer::FORMAT_DYNAMIC>(p_args...);
+			break;
+	}
+}
+} //namespace FormatDispatch
+
+#endif // FORMAT_DISPATCH_H
@@ -30,50 +30,173 @@
 
 #include "intersector.h"
 
+#include "core/object/worker_thread_pool.h"
+#include "core/templates/hash_map.h"
+#include "face_bvh.h"
+#include "format_dispatch.h"
+#include "vertex_classifier.h"
+
 namespace Intersector {
 /**
- * FaceIntersectInfo is one place where we, superficially, deviate from the original
- * Ezy-Slice implementation. The idea is to generalize the plane-face relationship as
- * much as possible to try to reduce long series of conditionals with largely similar
- * blocks for code and hopefully make the actual process that's happening a bit easier
- * to grok.
+ * How to split a face for one particular combination of its corners' sides of the plane.
+ * Points are referred to by index, where 0 to 2 are the face's own corners and 3 and 4
+ * are the points cut along its edges, in the order they're listed in `cuts`
  */
-struct FaceIntersectInfo {
-	SideOfPlane sides[3];
+struct SplitCase {
+	// The face doesn't cross the plane and goes into triangle_sides[0] as is
+	bool uncut = false;
+
+	// Each cut is a pair of corners on opposite sides of the plane, with the point being
+	// found starting out from the first of them. That's always the corner over the plane,
+	// so the two faces sharing a cut edge come up with the exact same point
+	uint8_t cut_count = 0;
+	uint8_t cuts[2][2] = {};
+
+	// The stretches of the cross section's outline running across the face, if any. Only
+	// a face lying flat on the plane has more than one, tracing all three of its edges
+	uint8_t segment_count = 0;
+	uint8_t segments[3][2] = {};
+
+	// The new triangles, all wound the same way as the source face, and which half each
+	// of them belongs to
+	uint8_t triangle_count = 0;
+	uint8_t triangles[3][3] = {};
+	SideOfPlane triangle_sides[3] = {};
+};
 
-	int num_of_points_above;
-	Vector3 points_above[3];
+constexpr SplitCase make_split_case(const SideOfPlane *sides) {
+	SplitCase split_case;
+	int over = 0;
+	int under = 0;
+	for (int i = 0; i < 3; i++) {
+		over += sides[i] == SideOfPlane::OVER;
+		under += sides[i] == SideOfPlane::UNDER;
+	}
 
-	int num_of_points_below;
-	Vector3 points_below[3];
+	// Lying flat on the plane the face doesn't belong to either half, but it's part of
+	// the cross section. It traces its edges in winding order, so an edge shared with
+	// another flat face gets traced once each way round and the two cancel out, see
+	// Triangulator::triangulate_segments, leaving only the flat area's outline
+	if (over == 0 && under == 0) {
+		split_case.segment_count = 3;
+		for (int i = 0; i < 3; i++) {
+			split_case.segments[i][0] = i;
+			split_case.segments[i][1] = (i + 1) % 3;
+		}
+		return split_case;
+	}
 
-	int num_of_points_on;
-	Vector3 points_on[3];
+	// Nothing crosses the plane. This covers every corner being on the same side as well
+	// as the face only touching the plane with a corner or an edge
+	if (over == 0 || under == 0) {
+		split_case.uncut = true;
+		split_case.triangle_count = 1;
+		split_case.triangles[0][0] = 0;
+		split_case.triangles[0][1] = 1;
+		split_case.triangles[0][2] = 2;
+		split_case.triangle_sides[0] = over > 0 ? SideOfPlane::OVER : SideOfPlane::UNDER;
+
+		// An edge lying on the plane is part of the outline, but it's shared with a face
+		// on the other side or lying flat on the plane. Only the face below it reports it,
+		// against its winding. That's the same way round the flat face across it traces it,
+		// so the two come out as one, while two faces below meeting at the edge cancel out
+		if (under == 1) {
+			int off = sides[0] == SideOfPlane::UNDER ? 0 : (sides[1] == SideOfPlane::UNDER ? 1 : 2);
+			split_case.segment_count = 1;
+			split_case.segments[0][0] = (off + 2) % 3;
+			split_case.segments[0][1] = (off + 1) % 3;
+		}
+		return split_case;
+	}
 
-	FaceIntersectInfo(const Plane &plane, const SlicerFace &face) {
-		num_of_points_above = 0;
-		num_of_points_below = 0;
-		num_of_points_on = 0;
+	// One corner on the plane with the other two on either side of it. The edge between
+	// those two gets cut and the face is split in two along the line to the corner
+	if (over + under == 2) {
+		int on = sides[0] == SideOfPlane::ON ? 0 : (sides[1] == SideOfPlane::ON ? 1 : 2);
+		int next = (on + 1) % 3;
+		int prev = (on + 2) % 3;
+		int above = sides[next] == SideOfPlane::OVER ? next : prev;
+		int below = above == next ? prev : next;
+
+		split_case.cut_count = 1;
+		split_case.cuts[0][0] = above;
+		split_case.cuts[0][1] = below;
+
+		split_case.segment_count = 1;
+		split_case.segments[0][0] = on;
+		split_case.segments[0][1] = 3;
+
+		split_case.triangle_count = 2;
+		split_case.triangles[0][0] = on;
+		split_case.triangles[0][1] = next;
+		split_case.triangles[0][2] = 3;
+		split_case.triangle_sides[0] = sides[next];
+		split_case.triangles[1][0] = on;
+		split_case.triangles[1][1] = 3;
+		split_case.triangles[1][2] = prev;
+		split_case.triangle_sides[1] = sides[prev];
+		return split_case;
+	}
 
-		SideOfPlane sides_of[3] = {
-			get_side_of(plane, face.vertex[0]),
-			get_side_of(plane, face.vertex[1]),
-			get_side_of(plane, face.vertex[2])
-		};
+	// A full split, with one corner alone on its side of the plane. Both of its edges get
+	// cut, leaving a triangle on its side and a quad, made up of two triangles, on the other
+	SideOfPlane lone_side = over == 1 ? SideOfPlane::OVER : SideOfPlane::UNDER;
+	int lone = sides[0] == lone_side ? 0 : (sides[1] == lone_side ? 1 : 2);
+	int next = (lone + 1) % 3;
+	int prev = (lone + 2) % 3;
+
+	// The edges are cut in corner order, whichever way round the face is
+	int first = next < prev ? next : prev;
+	int second = next < prev ? prev : next;
+	bool from_lone = lone_side == SideOfPlane::OVER;
+	split_case.cut_count = 2;
+	split_case.cuts[0][0] = from_lone ? lone : first;
+	split_case.cuts[0][1] = from_lone ? first : lone;
+	split_case.cuts[1][0] = from_lone ? lone : second;
+	split_case.cuts[1][1] = from_lone ? second : lone;
+	int next_cut = next == first ? 3 : 4;
+	int prev_cut = next == first ? 4 : 3;
+
+	split_case.segment_count = 1;
+	split_case.segments[0][0] = 3;
+	split_case.segments[0][1] = 4;
+
+	split_case.triangle_count = 3;
+	split_case.triangles[0][0] = lone;
+	split_case.triangles[0][1] = next_cut;
+	split_case.triangles[0][2] = prev_cut;
+	split_case.triangle_sides[0] = lone_side;
+	split_case.triangles[1][0] = next;
+	split_case.triangles[1][1] = prev_cut;
+	split_case.triangles[1][2] = next_cut;
+	split_case.triangle_sides[1] = sides[next];
+	split_case.triangles[2][0] = prev;
+	split_case.triangles[2][1] = prev_cut;
+	split_case.triangles[2][2] = next;
+	split_case.triangle_sides[2] = sides[next];
+	return split_case;
+}
 
-		for (int i = 0; i < 3; i++) {
-			SideOfPlane side = sides_of[i];
-			sides[i] = side;
+struct SplitTable {
+	SplitCase cases[27];
+};
 
-			if (side == SideOfPlane::OVER)
-				points_above[num_of_points_above++] = face.vertex[i];
-			else if (side == SideOfPlane::UNDER)
-				points_below[num_of_points_below++] = face.vertex[i];
-			else
-				points_on[num_of_points_on++] = face.vertex[i];
-		}
+constexpr SplitTable make_split_table() {
+	SplitTable table;
+	for (int i = 0; i < 27; i++) {
+		SideOfPlane sides[3] = { SideOfPlane(i % 3), SideOfPlane((i / 3) % 3), SideOfPlane(i / 9) };
+		table.cases[i] = make_split_case(sides);
 	}
-};
+	return table;
+}
+
+// Every combination of over, under and on for a face's three corners, indexed by
+// get_split_case_index
+static constexpr SplitTable SPLIT_TABLE = make_split_table();
+
+_FORCE_INLINE_ int get_split_case_index(const SideOfPlane *sides) {
+	return sides[0] + sides[1] * 3 + sides[2] * 9;
+}
 
 // Similar to Face3::get_side_of but focused on a single point
 // rather than an entire face. Plane has a `is_point_over` method but
@@ -83,231 +206,807 @@ struct FaceIntersectInfo {
 // I don't think we need to feel too bad about reimplementing to meet
 // our exact needs
 SideOfPlane get_side_of(const Plane &plane, Vector3 point) {
-	real_t dist = plane.distance_to(point);
-	if (dist > CMP_EPSILON) {
+	return get_side_of_distance(plane.distance_to(point));
+}
+
+SideOfPlane get_side_of_aabb(const Plane &plane, const AABB &aabb) {
+	// Only the two corners reaching furthest along and against the normal matter, if
+	// neither of those gets to the plane then nothing else in the box can
+	Vector3 end = aabb.position + aabb.size;
+	Vector3 top;
+	Vector3 bottom;
+	for (int i = 0; i < 3; i++) {
+		bool positive = plane.normal[i] >= 0;
+		top[i] = positive ? end[i] : aabb.position[i];
+		bottom[i] = positive ? aabb.position[i] : end[i];
+	}
+
+	if (plane.distance_to(bottom) > CMP_EPSILON) {
 		return SideOfPlane::OVER;
 	}
 
-	if (dist < -CMP_EPSILON) {
+	if (plane.distance_to(top) < -CMP_EPSILON) {
 		return SideOfPlane::UNDER;
 	}
 
 	return SideOfPlane::ON;
 }
 
-bool line_intersects(const Plane &plane, const Vector3 a, const Vector3 b, Vector3 &out) {
-	Vector3 ab = b - a;
-	real_t t = (plane.d - plane.normal.dot(a)) / (plane.normal.dot(ab));
+/**
+ * The current thread's scratch buffers that aren't lent out. They're freed along with the
+ * thread
+ */
+struct SpareScratch {
+	LocalVector<SplitScratch *> spares;
+
+	~SpareScratch() {
+		for (uint32_t i = 0; i < spares.size(); i++) {
+			memdelete(spares[i]);
+		}
+	}
+};
 
-	if (t >= CMP_EPSILON && t <= (1 + CMP_EPSILON)) {
-		Vector3 intersect_point = a + t * ab;
-		out.x = intersect_point.x;
-		out.y = intersect_point.y;
-		out.z = intersect_point.z;
+static thread_local SpareScratch spare_scratch;
 
-		return true;
+SplitScratch::Borrow::Borrow() {
+	LocalVector<SplitScratch *> &spares = spare_scratch.spares;
+	if (spares.is_empty()) {
+		scratch = memnew(SplitScratch);
+		return;
 	}
-	return false;
+
+	scratch = spares[spares.size() - 1];
+	spares.resize(spares.size() - 1);
 }
 
-bool points_all_on_same_side(const SlicerFace &face, FaceIntersectInfo &info, SplitResult &result) {
-	// This is actually a bit of a divergence from Ezy-Slice, where instead they just return and then handle
-	// this case in a different loop. With the way we have things setup though I think we can just handle them
-	// while we're here with all of already deduced info
-	if (info.num_of_points_above == 3) {
-		result.upper_faces.push_back(face);
-		return true;
-	} else if (info.num_of_points_below == 3) {
-		result.lower_faces.push_back(face);
-		return true;
-	} else if (info.num_of_points_on == 3) {
-		result.intersection_points.push_back(face.vertex[0]);
-		result.intersection_points.push_back(face.vertex[1]);
-		result.intersection_points.push_back(face.vertex[2]);
-		return true;
-	}
-
-	return false;
+SplitScratch::Borrow::~Borrow() {
+	spare_scratch.spares.push_back(scratch);
 }
 
-bool one_side_is_parallel(const SlicerFace &face, FaceIntersectInfo &info, SplitResult &result) {
-	// if two points are actually lying *on* the plane then we know there won't be any real intersection,
-	// we can just reuse the facd as is after determining if the remaining point is above or below the plane
-	if (info.num_of_points_on == 2) {
-		if (info.num_of_points_above == 1) {
-			result.upper_faces.push_back(face);
-		} else {
-			result.lower_faces.push_back(face);
+// Face3 has its own split_by_plane but we need to make a few modifications to support
+// all the data that SlicerFace is responsible for holding. Rather than working through a
+// chain of edge cases for every face, the corners' sides of the plane pick a precomputed
+// SplitCase which spells out exactly which edges to cut and which triangles come out
+//
+// Having result passed in and filled out by reference should hopefully allow us to reuse
+// the same one over a series of faces
+template <uint32_t FORMAT>
+void split_face(const Plane &plane, const FaceBuffer &faces, int face_idx, const SideOfPlane *sides, SplitResult &result) {
+	DEV_ASSERT(!faces.is_indexed());
+	const SplitCase &split_case = SPLIT_TABLE.cases[get_split_case_index(sides)];
+
+	int base = face_idx * 3;
+	if (split_case.uncut) {
+		if (result.keeps(split_case.triangle_sides[0])) {
+			FaceBuffer &target = split_case.triangle_sides[0] == SideOfPlane::OVER ? result.upper_faces : result.lower_faces;
+			target.append_face<FORMAT>(faces, face_idx);
+		}
+		for (int i = 0; i < split_case.segment_count; i++) {
+			result.cut_segments.push_back(faces.vertices[base + split_case.segments[i][0]]);
+			result.cut_segments.push_back(faces.vertices[base + split_case.segments[i][1]]);
 		}
-		return true;
+		return;
+	}
+
+	Vector3 points[5];
+	points[0] = faces.vertices[base];
+	points[1] = faces.vertices[base + 1];
+	points[2] = faces.vertices[base + 2];
+
+	// How far along each cut edge the plane crosses it. Every attribute of a cut point is
+	// just a lerp between its edge's two corners by the same amount
+	real_t t[2];
+	for (int i = 0; i < split_case.cut_count; i++) {
+		// The corners are known to be on opposite sides, so there's always a crossing
+		// between them
+		const Vector3 &from = points[split_case.cuts[i][0]];
+		Vector3 edge = points[split_case.cuts[i][1]] - from;
+		t[i] = (plane.d - plane.normal.dot(from)) / plane.normal.dot(edge);
+		points[3 + i] = from + t[i] * edge;
 	}
 
-	return false;
+	for (int i = 0; i < split_case.segment_count; i++) {
+		result.cut_segments.push_back(points[split_case.segments[i][0]]);
+		result.cut_segments.push_back(points[split_case.segments[i][1]]);
+	}
+
+	for (int i = 0; i < split_case.triangle_count; i++) {
+		if (!result.keeps(split_case.triangle_sides[i])) {
+			continue;
+		}
+
+		FaceBuffer &target = split_case.triangle_sides[i] == SideOfPlane::OVER ? result.upper_faces : result.lower_faces;
+		for (int j = 0; j < 3; j++) {
+			int point = split_case.triangles[i][j];
+			if (point < 3) {
+				target.append_vertex<FORMAT>(faces, base + point);
+			} else {
+				const uint8_t *cut = split_case.cuts[point - 3];
+				target.append_edge_vertex<FORMAT>(faces, base + cut[0], base + cut[1], t[point - 3]);
+			}
+		}
+	}
 }
 
-bool pointed_away(const SlicerFace &face, FaceIntersectInfo &info, SplitResult &result) {
-	// Similar to one_side_is_parallel except in this case only one point is on the plane
-	// and the other 2 are on the same side
-	if (info.num_of_points_on == 1) {
-		if (info.num_of_points_above == 2) {
-			result.upper_faces.push_back(face);
-			return true;
-		} else if (info.num_of_points_below == 2) {
-			result.lower_faces.push_back(face);
-			return true;
+/**
+ * Adds the cross section segment a face contributes given its corners' sides of the
+ * plane, without building any of the triangles split_face would
+ */
+void add_split_segment(const Plane &plane, const Vector3 *corners, const SideOfPlane *sides, Vector<Vector3> &r_segments) {
+	const SplitCase &split_case = SPLIT_TABLE.cases[get_split_case_index(sides)];
+	for (int i = 0; i < split_case.segment_count * 2; i++) {
+		int point = split_case.segments[i / 2][i % 2];
+		if (point < 3) {
+			r_segments.push_back(corners[point]);
+			continue;
 		}
+
+		const uint8_t *cut = split_case.cuts[point - 3];
+		const Vector3 &from = corners[cut[0]];
+		Vector3 edge = corners[cut[1]] - from;
+		real_t t = (plane.d - plane.normal.dot(from)) / plane.normal.dot(edge);
+		r_segments.push_back(from + t * edge);
+	}
+}
+
+/**
+ * Makes room in both halves for everything split_face is about to add for the given
+ * faces, so each stream gets allocated the once instead of grown a face at a time
+ */
+void reserve_split(const SideOfPlane *sides, int face_count, SplitResult &result) {
+	int triangles[3] = {};
+	for (int i = 0; i < face_count; i++) {
+		const SplitCase &split_case = SPLIT_TABLE.cases[get_split_case_index(sides + i * 3)];
+		for (int j = 0; j < split_case.triangle_count; j++) {
+			triangles[split_case.triangle_sides[j]]++;
+		}
+	}
+
+	if (result.keep_upper) {
+		result.upper_faces.reserve_vertices(result.upper_faces.vertices.size() + triangles[SideOfPlane::OVER] * 3);
+	}
+	if (result.keep_lower) {
+		result.lower_faces.reserve_vertices(result.lower_faces.vertices.size() + triangles[SideOfPlane::UNDER] * 3);
 	}
+}
 
-	return false;
+void split_face_by_plane(const Plane &plane, const FaceBuffer &faces, int face_idx, SplitResult &result) {
+	SideOfPlane sides[3] = {
+		get_side_of(plane, faces.vertices[face_idx * 3]),
+		get_side_of(plane, faces.vertices[face_idx * 3 + 1]),
+		get_side_of(plane, faces.vertices[face_idx * 3 + 2])
+	};
+	split_face<FaceBuffer::FORMAT_DYNAMIC>(plane, faces, face_idx, sides, result);
 }
 
-bool face_split_in_half(const Plane &plane, const SlicerFace &face, FaceIntersectInfo &info, SplitResult &result) {
-	// If one point is lying on the plane and the other 2 points are on either side all we really need to do is split
-	// the triangle in half (or, more accurately, in two)
-	if (info.num_of_points_on == 1) {
-		Vector3 on = info.points_on[0];
-
-		// We know that there is one on either side or else it would have been caught in `pointed_away`
-		ERR_FAIL_COND_V(info.num_of_points_above != 1 || info.num_of_points_below != 1, false);
-		Vector3 above = info.points_above[0];
-		Vector3 below = info.points_below[0];
-
-		Vector3 a = face.vertex[0];
-		Vector3 b = face.vertex[1];
-		Vector3 c = face.vertex[2];
-
-		Vector3 intersect_point;
-		if (!line_intersects(plane, above, below, intersect_point)) {
-			ERR_FAIL_V(false);
-		}
-
-		result.intersection_points.push_back(on);
-		result.intersection_points.push_back(intersect_point);
-
-		SlicerFace upper_face;
-		SlicerFace lower_face;
-
-		// We need to make sure, for any new triangle we're generating, that the points are created clockwise so that
-		// the face renders correctly. Sadly our FaceIntersectInfo helper fails us here and we need to fall back on
-		// tedious conditionals to manually handle this logic. I'd really love a way of reliably generalizing this
-		if (on == a) {
-			upper_face = face.sub_face(a, b, intersect_point);
-			lower_face = face.sub_face(a, intersect_point, c);
-		} else if (on == b) {
-			upper_face = face.sub_face(b, c, intersect_point);
-			lower_face = face.sub_face(b, intersect_point, a);
-		} else {
-			upper_face = face.sub_face(c, a, intersect_point);
-			lower_face = face.sub_face(c, intersect_point, b);
+/**
+ * Bookkeeping for splitting an indexed surface. Source vertices are copied into each half
+ * the first time a face on that side uses them, and the cut vertices are shared between
+ * the faces on either side of the edge they were made from
+ */
+template <uint32_t FORMAT>
+struct IndexedSplit {
+	struct EdgeCut {
+		int upper;
+		int lower;
+		Vector3 point;
+	};
+
+	const FaceBuffer &faces;
+	const real_t *distances;
+	const SideOfPlane *sides;
+	SplitResult &result;
+
+	LocalVector<int> &upper_map;
+	LocalVector<int> &lower_map;
+	HashMap<uint64_t, EdgeCut> edge_cuts;
+
+	IndexedSplit(const FaceBuffer &p_faces, const real_t *p_distances, const SideOfPlane *p_sides, SplitResult &r_result, LocalVector<int> &r_upper_map, LocalVector<int> &r_lower_map) :
+			faces(p_faces), distances(p_distances), sides(p_sides), result(r_result), upper_map(r_upper_map), lower_map(r_lower_map) {
+		int vertex_count = faces.vertices.size();
+		upper_map.resize(vertex_count);
+		lower_map.resize(vertex_count);
+
+		for (int i = 0; i < vertex_count; i++) {
+			upper_map[i] = -1;
+			lower_map[i] = -1;
+		}
+	}
+
+	_FORCE_INLINE_ int upper_vertex(int p_idx) {
+		if (upper_map[p_idx] == -1) {
+			upper_map[p_idx] = result.upper_faces.append_vertex<FORMAT>(faces, p_idx);
+		}
+		return upper_map[p_idx];
+	}
+
+	_FORCE_INLINE_ int lower_vertex(int p_idx) {
+		if (lower_map[p_idx] == -1) {
+			lower_map[p_idx] = result.lower_faces.append_vertex<FORMAT>(faces, p_idx);
+		}
+		return lower_map[p_idx];
+	}
+
+	EdgeCut cut_edge(int p_a, int p_b) {
+		// Always intersect from the lower index so both faces sharing the edge come up
+		// with the exact same point
+		int from = MIN(p_a, p_b);
+		int to = MAX(p_a, p_b);
+		uint64_t key = ((uint64_t)from << 32) | (uint64_t)to;
+
+		EdgeCut *existing = edge_cuts.getptr(key);
+		if (existing) {
+			return *existing;
 		}
 
-		result.upper_faces.push_back(upper_face);
-		result.lower_faces.push_back(lower_face);
+		// The points are on opposite sides of the plane so this can't divide by zero
+		real_t t = distances[from] / (distances[from] - distances[to]);
+
+		// Worked out the same way append_edge_vertex does, so it matches the cut vertex
+		// added to either half down to the bit
+		EdgeCut cut;
+		cut.point = faces.vertices[from].lerp(faces.vertices[to], t);
+		cut.upper = result.keep_upper ? result.upper_faces.append_edge_vertex<FORMAT>(faces, from, to, t) : -1;
+		cut.lower = result.keep_lower ? result.lower_faces.append_edge_vertex<FORMAT>(faces, from, to, t) : -1;
 
-		return true;
+		edge_cuts.insert(key, cut);
+		return cut;
+	}
+
+	/**
+	 * Copies a face already known to be entirely on one side of the plane, without
+	 * needing its vertices to be classified
+	 */
+	_FORCE_INLINE_ void copy_face(int p_face, SideOfPlane p_side) {
+		if (!result.keeps(p_side)) {
+			return;
+		}
+
+		for (int i = 0; i < 3; i++) {
+			int idx = faces.indices[p_face * 3 + i];
+			if (p_side == SideOfPlane::OVER) {
+				result.upper_faces.indices.push_back(upper_vertex(idx));
+			} else {
+				result.lower_faces.indices.push_back(lower_vertex(idx));
+			}
+		}
 	}
 
-	return false;
+	void split_face(int p_face) {
+		int idx[3] = {
+			faces.indices[p_face * 3],
+			faces.indices[p_face * 3 + 1],
+			faces.indices[p_face * 3 + 2]
+		};
+
+		int num_of_points_above = 0;
+		int num_of_points_below = 0;
+		for (int i = 0; i < 3; i++) {
+			num_of_points_above += sides[idx[i]] == SideOfPlane::OVER;
+			num_of_points_below += sides[idx[i]] == SideOfPlane::UNDER;
+		}
+
+		// Faces lying flat on the plane don't belong to either half but trace their edges,
+		// same as split_face
+		if (num_of_points_above == 0 && num_of_points_below == 0) {
+			for (int i = 0; i < 3; i++) {
+				result.cut_segments.push_back(faces.vertices[idx[i]]);
+				result.cut_segments.push_back(faces.vertices[idx[(i + 1) % 3]]);
+			}
+			return;
+		}
+
+		if (num_of_points_below == 0) {
+			for (int i = 0; i < 3 && result.keep_upper; i++) {
+				result.upper_faces.indices.push_back(upper_vertex(idx[i]));
+			}
+			return;
+		}
+
+		if (num_of_points_above == 0) {
+			for (int i = 0; i < 3 && result.keep_lower; i++) {
+				result.lower_faces.indices.push_back(lower_vertex(idx[i]));
+			}
+
+			// Same as split_face, of the two faces meeting at an edge on the plane only the
+			// one below it adds it to the outline, against its winding
+			if (num_of_points_below == 1) {
+				for (int i = 0; i < 3; i++) {
+					if (sides[idx[i]] == SideOfPlane::UNDER) {
+						result.cut_segments.push_back(faces.vertices[idx[(i + 2) % 3]]);
+						result.cut_segments.push_back(faces.vertices[idx[(i + 1) % 3]]);
+					}
+				}
+			}
+			return;
+		}
+
+		// The face straddles the plane. Walking its edges in order and clipping them
+		// against the plane gives us a triangle or quad for each side that keeps the
+		// source face's winding
+		int upper_polygon[4];
+		int lower_polygon[4];
+		int upper_count = 0;
+		int lower_count = 0;
+
+		for (int i = 0; i < 3; i++) {
+			int a = idx[i];
+			int b = idx[(i + 1) % 3];
+			SideOfPlane side_a = sides[a];
+			SideOfPlane side_b = sides[b];
+
+			if (side_a != SideOfPlane::UNDER && result.keep_upper) {
+				upper_polygon[upper_count++] = upper_vertex(a);
+			}
+
+			if (side_a != SideOfPlane::OVER && result.keep_lower) {
+				lower_polygon[lower_count++] = lower_vertex(a);
+			}
+
+			if (side_a == SideOfPlane::ON) {
+				result.cut_segments.push_back(faces.vertices[a]);
+			}
+
+			if ((side_a == SideOfPlane::OVER && side_b == SideOfPlane::UNDER) ||
+					(side_a == SideOfPlane::UNDER && side_b == SideOfPlane::OVER)) {
+				EdgeCut cut = cut_edge(a, b);
+				if (result.keep_upper) {
+					upper_polygon[upper_count++] = cut.upper;
+				}
+				if (result.keep_lower) {
+					lower_polygon[lower_count++] = cut.lower;
+				}
+				result.cut_segments.push_back(cut.point);
+			}
+		}
+
+		// A half that isn't kept never had anything added to its polygon
+		add_polygon(result.upper_faces, upper_polygon, upper_count);
+		add_polygon(result.lower_faces, lower_polygon, lower_count);
+	}
+
+	_FORCE_INLINE_ void add_polygon(FaceBuffer &r_faces, const int *p_polygon, int p_count) {
+		for (int i = 1; i < p_count - 1; i++) {
+			r_faces.indices.push_back(p_polygon[0]);
+			r_faces.indices.push_back(p_polygon[i]);
+			r_faces.indices.push_back(p_polygon[i + 1]);
+		}
+	}
+};
+
+/**
+ * Walks the tree with the plane, calling p_whole for every node found to be entirely on
+ * one side of it and p_leaf for every leaf which reaches it
+ */
+template <typename WholeCallback, typename LeafCallback>
+void walk_bvh(const Plane &plane, const FaceBVH &bvh, WholeCallback p_whole, LeafCallback p_leaf) {
+	LocalVector<int> stack;
+	stack.push_back(0);
+	while (stack.size() > 0) {
+		const FaceBVH::Node &node = bvh.nodes[stack[stack.size() - 1]];
+		stack.resize(stack.size() - 1);
+
+		SideOfPlane side = get_side_of_aabb(plane, node.aabb);
+		if (side != SideOfPlane::ON) {
+			p_whole(node, side);
+		} else if (node.is_leaf()) {
+			p_leaf(node);
+		} else {
+			// Right first so the left subtree gets visited first, keeping the faces in
+			// the same order they're stored in
+			stack.push_back(node.left + 1);
+			stack.push_back(node.left);
+		}
+	}
 }
 
-void full_split(const Plane &plane, const SlicerFace &face, FaceIntersectInfo &info, SplitResult &result) {
-	// at this point, all edge cases have been tested and failed, we need to perform
-	// full intersection tests against the lines. From this point onwards we will generate
-	// 3 triangles
-	ERR_FAIL_COND(info.num_of_points_on != 0);
-	ERR_FAIL_COND(info.num_of_points_above == 0);
-	ERR_FAIL_COND(info.num_of_points_below == 0);
-
-	Vector3 a = face.vertex[0];
-	Vector3 b = face.vertex[1];
-	Vector3 c = face.vertex[2];
-
-	// If we've gotten to this point then we can be able to confidently say that two points lie on one side
-	// and one point lies on the other. We just need to find out which is which;
-	Vector3 on_same_side_1;
-	Vector3 on_same_side_2;
-	Vector3 on_lone_side;
-
-	if (info.num_of_points_above == 2) {
-		on_same_side_1 = info.points_above[0];
-		on_same_side_2 = info.points_above[1];
-		on_lone_side = info.points_below[0];
-	} else if (info.num_of_points_below == 2) {
-		on_same_side_1 = info.points_below[0];
-		on_same_side_2 = info.points_below[1];
-		on_lone_side = info.points_above[0];
-	} else {
-		ERR_FAIL_MSG("Slicer's full_split method was called with unexpected intersection info");
-	}
-
-	Vector3 intersection_point_1;
-	Vector3 intersection_point_2;
-	if (!line_intersects(plane, on_same_side_1, on_lone_side, intersection_point_1) ||
-			!line_intersects(plane, on_same_side_2, on_lone_side, intersection_point_2)) {
-		ERR_FAIL();
-	}
-
-	SlicerFace lone_tri;
-	SlicerFace same_tri_1;
-	SlicerFace same_tri_2;
-
-	// As mentioned in face_split_in_half, we need to make sure that we add our points
-	// clockwise or else it won't render correctly. I'd love some way of generalizing this
-	// to be less redundant
-	if (on_lone_side == a) {
-		lone_tri = face.sub_face(a, intersection_point_1, intersection_point_2);
-		same_tri_1 = face.sub_face(b, intersection_point_2, intersection_point_1);
-		same_tri_2 = face.sub_face(c, intersection_point_2, b);
-	} else if (on_lone_side == b) {
-		lone_tri = face.sub_face(b, intersection_point_2, intersection_point_1);
-		same_tri_1 = face.sub_face(c, intersection_point_1, intersection_point_2);
-		same_tri_2 = face.sub_face(a, intersection_point_1, c);
-	} else {
-		lone_tri = face.sub_face(c, intersection_point_1, intersection_point_2);
-		same_tri_1 = face.sub_face(a, intersection_point_2, intersection_point_1);
-		same_tri_2 = face.sub_face(b, intersection_point_2, a);
-	}
-
-	if (info.num_of_points_above == 2) {
-		result.upper_faces.push_back(same_tri_1);
-		result.upper_faces.push_back(same_tri_2);
-		result.lower_faces.push_back(lone_tri);
-	} else {
-		result.lower_faces.push_back(same_tri_1);
-		result.lower_faces.push_back(same_tri_2);
-		result.upper_faces.push_back(lone_tri);
-	}
-
-	result.intersection_points.push_back(intersection_point_1);
-	result.intersection_points.push_back(intersection_point_2);
+template <uint32_t FORMAT>
+void split_surface_with_bvh(const Plane &plane, const FaceBuffer &faces, const FaceBVH &bvh, SplitResult &result) {
+	if (!faces.is_indexed()) {
+		// Only the vertices of the leaves reaching the plane ever get classified
+		real_t distances[FaceBVH::LEAF_SIZE * 3];
+		SideOfPlane sides[FaceBVH::LEAF_SIZE * 3];
+
+		walk_bvh(
+				plane, bvh,
+				[&](const FaceBVH::Node &node, SideOfPlane side) {
+					if (result.keeps(side)) {
+						FaceBuffer &target = side == SideOfPlane::OVER ? result.upper_faces : result.lower_faces;
+						target.append_face_range(faces, node.begin, node.count);
+					}
+				},
+				[&](const FaceBVH::Node &node) {
+					VertexClassifier::classify(plane, &faces.vertices[node.begin * 3], node.count * 3, distances, sides);
+					for (int i = 0; i < node.count; i++) {
+						split_face<FORMAT>(plane, faces, node.begin + i, sides + i * 3, result);
+					}
+				});
+		return;
+	}
+
+	// Indexed faces can share vertices across leaves, so the classifications are kept for
+	// the whole surface but only filled in for the vertices of faces that need them
+	SplitScratch::Borrow scratch;
+	LocalVector<real_t> &distances = scratch->distances;
+	LocalVector<SideOfPlane> &sides = scratch->sides;
+	distances.resize(faces.vertices.size());
+	sides.resize(faces.vertices.size());
+	IndexedSplit<FORMAT> split(faces, distances.ptr(), sides.ptr(), result, scratch->upper_map, scratch->lower_map);
+
+	walk_bvh(
+			plane, bvh,
+			[&](const FaceBVH::Node &node, SideOfPlane side) {
+				for (int i = node.begin; i < node.begin + node.count; i++) {
+					split.copy_face(i, side);
+				}
+			},
+			[&](const FaceBVH::Node &node) {
+				for (int i = node.begin; i < node.begin + node.count; i++) {
+					for (int j = 0; j < 3; j++) {
+						int idx = faces.indices[i * 3 + j];
+						distances[idx] = plane.distance_to(faces.vertices[idx]);
+						sides[idx] = get_side_of_distance(distances[idx]);
+					}
+					split.split_face(i);
+				}
+			});
 }
 
-// Face3 has its own split_by_plane but we need to make a few modifications to support
-// all the data that SlicerFace is responsible for holding. Also Ezy-Slice uses a few clever
-// tricks to handle edge cases
-//
-// Having result passed in and filled out by reference should hopefully allow us to reuse
-// the same one over a series of faces
-void split_face_by_plane(const Plane &plane, const SlicerFace &face, SplitResult &result) {
-	FaceIntersectInfo info(plane, face);
+// Loose surfaces with at least this many faces get split a chunk at a time on the
+// WorkerThreadPool. Chunks are a multiple of four vertices long so the SIMD classification
+// lines up the same way it does when classifying the whole surface in one go
+static constexpr int PARALLEL_MIN_FACES = 16384;
+static constexpr int CHUNK_FACES = 4096;
 
-	if (points_all_on_same_side(face, info, result)) {
-		return;
+/**
+ * Splits a loose surface in chunks of faces, each into its own SplitResult. Every face
+ * is split on its own, so appending the chunks back together in order gives exactly what
+ * splitting the faces one after another would have
+ */
+template <uint32_t FORMAT>
+struct ChunkedSplit {
+	const Plane &plane;
+	const FaceBuffer &faces;
+	// Out of the splitting thread's scratch, each chunk still has its capacity from the
+	// last time it was used
+	LocalVector<SplitResult> &chunks;
+
+	ChunkedSplit(const Plane &p_plane, const FaceBuffer &p_faces, const SplitResult &p_result, LocalVector<SplitResult> &r_chunks) :
+			plane(p_plane), faces(p_faces), chunks(r_chunks) {
+		chunks.resize((faces.size() + CHUNK_FACES - 1) / CHUNK_FACES);
+		for (uint32_t i = 0; i < chunks.size(); i++) {
+			chunks[i].reset();
+			chunks[i].set_format(faces.format);
+			chunks[i].keep_upper = p_result.keep_upper;
+			chunks[i].keep_lower = p_result.keep_lower;
+		}
 	}
 
-	if (one_side_is_parallel(face, info, result)) {
-		return;
+	void split_chunk(uint32_t p_chunk, void *p_userdata) {
+		int begin = p_chunk * CHUNK_FACES;
+		int count = MIN(CHUNK_FACES, faces.size() - begin);
+
+		SplitScratch::Borrow scratch;
+		LocalVector<real_t> &distances = scratch->distances;
+		LocalVector<SideOfPlane> &sides = scratch->sides;
+		distances.resize(count * 3);
+		sides.resize(count * 3);
+		VertexClassifier::classify(plane, &faces.vertices[begin * 3], count * 3, distances.ptr(), sides.ptr());
+		reserve_split(sides.ptr(), count, chunks[p_chunk]);
+		for (int i = 0; i < count; i++) {
+			split_face<FORMAT>(plane, faces, begin + i, sides.ptr() + i * 3, chunks[p_chunk]);
+		}
 	}
 
-	if (pointed_away(face, info, result)) {
-		return;
+	void merge_into(SplitResult &r_result) {
+		int upper_vertices = r_result.upper_faces.vertices.size();
+		int lower_vertices = r_result.lower_faces.vertices.size();
+		for (uint32_t i = 0; i < chunks.size(); i++) {
+			upper_vertices += chunks[i].upper_faces.vertices.size();
+			lower_vertices += chunks[i].lower_faces.vertices.size();
+		}
+		r_result.upper_faces.reserve_vertices(upper_vertices);
+		r_result.lower_faces.reserve_vertices(lower_vertices);
+
+		for (uint32_t i = 0; i < chunks.size(); i++) {
+			r_result.upper_faces.append_faces(chunks[i].upper_faces);
+			r_result.lower_faces.append_faces(chunks[i].lower_faces);
+			r_result.cut_segments.append_array(chunks[i].cut_segments);
+		}
 	}
+};
 
-	if (face_split_in_half(plane, face, info, result)) {
-		return;
+struct SplitSurface {
+	template <uint32_t FORMAT>
+	static void run(const Plane &plane, const FaceBuffer &faces, SplitResult &result, const FaceBVH *bvh) {
+		if (bvh && !bvh->is_empty()) {
+			split_surface_with_bvh<FORMAT>(plane, faces, *bvh, result);
+			return;
+		}
+
+		SplitScratch::Borrow scratch;
+
+		// Indexed surfaces share vertices between their faces and stay serial, chunks would
+		// each end up with their own copies of the vertices along their borders
+		if (!faces.is_indexed() && faces.size() >= PARALLEL_MIN_FACES) {
+			ChunkedSplit<FORMAT> split(plane, faces, result, scratch->chunks);
+			WorkerThreadPool::GroupID group_id = WorkerThreadPool::get_singleton()->add_template_group_task(&split, &ChunkedSplit<FORMAT>::split_chunk, (void *)nullptr, split.chunks.size(), -1, true, "Slicer split surface");
+			WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_id);
+			split.merge_into(result);
+			return;
+		}
+
+		// Every vertex gets classified up front in one batched pass rather than one
+		// at a time as the faces get walked. For indexed surfaces this also means each
+		// unique vertex is only classified the once, no matter how many faces share it
+		int vertex_count = faces.vertices.size();
+		LocalVector<real_t> &distances = scratch->distances;
+		LocalVector<SideOfPlane> &sides = scratch->sides;
+		distances.resize(vertex_count);
+		sides.resize(vertex_count);
+		VertexClassifier::classify(plane, faces.vertices.ptr(), vertex_count, distances.ptr(), sides.ptr());
+
+		if (!faces.is_indexed()) {
+			reserve_split(sides.ptr(), faces.size(), result);
+			for (int i = 0; i < faces.size(); i++) {
+				split_face<FORMAT>(plane, faces, i, sides.ptr() + i * 3, result);
+			}
+			return;
+		}
+
+		IndexedSplit<FORMAT> split(faces, distances.ptr(), sides.ptr(), result, scratch->upper_map, scratch->lower_map);
+		for (int i = 0; i < faces.size(); i++) {
+			split.split_face(i);
+		}
+	}
+};
+
+void split_surface_by_plane(const Plane &plane, const FaceBuffer &faces, SplitResult &result, const FaceBVH *p_bvh) {
+	FormatDispatch::dispatch<SplitSurface>(faces.format, plane, faces, result, p_bvh);
+}
+
+/**
+ * What a SurfaceSplitter needs to pick up where it left off. The kernel itself is behind
+ * split_batch so that each format still gets its own specialization
+ */
+struct SurfaceSplitter::State {
+	Plane plane;
+	const FaceBuffer &faces;
+	SplitResult &result;
+
+	// Indexed surfaces keep the classifications of every vertex, loose ones only those of
+	// the batch being split
+	LocalVector<real_t> distances;
+	LocalVector<SideOfPlane> sides;
+	int classified_vertices = 0;
+	int split_faces = 0;
+
+	virtual void split_batch(int p_max_faces) = 0;
+
+	State(const Plane &p_plane, const FaceBuffer &p_faces, SplitResult &r_result) :
+			plane(p_plane), faces(p_faces), result(r_result) {}
+	virtual ~State() {}
+};
+
+template <uint32_t FORMAT>
+struct IncrementalSplit : public SurfaceSplitter::State {
+	// Held for as long as the splitter is, so these can't come out of the thread's scratch
+	LocalVector<int> upper_map;
+	LocalVector<int> lower_map;
+	IndexedSplit<FORMAT> *indexed = nullptr;
+
+	void split_batch(int p_max_faces) override {
+		// Batches are kept to a multiple of four vertices long, so the SIMD classification
+		// lines up the same way it does when classifying the whole surface in one go
+		int batch = (MAX(p_max_faces, 1) + 3) & ~3;
+
+		if (!faces.is_indexed()) {
+			int count = MIN(batch, faces.size() - split_faces);
+			distances.resize(count * 3);
+			sides.resize(count * 3);
+			VertexClassifier::classify(plane, &faces.vertices[split_faces * 3], count * 3, distances.ptr(), sides.ptr());
+			for (int i = 0; i < count; i++) {
+				split_face<FORMAT>(plane, faces, split_faces + i, sides.ptr() + i * 3, result);
+			}
+			split_faces += count;
+			return;
+		}
+
+		int vertex_count = faces.vertices.size();
+		if (classified_vertices < vertex_count) {
+			int count = MIN(batch * 3, vertex_count - classified_vertices);
+			VertexClassifier::classify(plane, &faces.vertices[classified_vertices], count, distances.ptr() + classified_vertices, sides.ptr() + classified_vertices);
+			classified_vertices += count;
+			return;
+		}
+
+		int count = MIN(batch, faces.size() - split_faces);
+		for (int i = split_faces; i < split_faces + count; i++) {
+			indexed->split_face(i);
+		}
+		split_faces += count;
+	}
+
+	IncrementalSplit(const Plane &p_plane, const FaceBuffer &p_faces, SplitResult &r_result) :
+			SurfaceSplitter::State(p_plane, p_faces, r_result) {
+		if (!faces.is_indexed()) {
+			return;
+		}
+
+		distances.resize(faces.vertices.size());
+		sides.resize(faces.vertices.size());
+		indexed = memnew(IndexedSplit<FORMAT>(faces, distances.ptr(), sides.ptr(), result, upper_map, lower_map));
+	}
+
+	~IncrementalSplit() {
+		if (indexed) {
+			memdelete(indexed);
+		}
+	}
+};
+
+struct CreateSplitterState {
+	template <uint32_t FORMAT>
+	static void run(const Plane &plane, const FaceBuffer &faces, SplitResult &result, SurfaceSplitter::State *&r_state) {
+		r_state = memnew(IncrementalSplit<FORMAT>(plane, faces, result));
+	}
+};
+
+SurfaceSplitter::SurfaceSplitter(const Plane &p_plane, const FaceBuffer &p_faces, SplitResult &r_result) {
+	FormatDispatch::dispatch<CreateSplitterState>(p_faces.format, p_plane, p_faces, r_result, state);
+}
+
+SurfaceSplitter::~SurfaceSplitter() {
+	memdelete(state);
+}
+
+bool SurfaceSplitter::split(int p_max_faces) {
+	if (!is_done()) {
+		state->split_batch(p_max_faces);
+	}
+	return !is_done();
+}
+
+bool SurfaceSplitter::is_done() const {
+	return state->split_faces == state->faces.size();
+}
+
+int SurfaceSplitter::get_split_face_count() const {
+	return state->split_faces;
+}
+
+int SurfaceSplitter::get_face_count() const {
+	return state->faces.size();
+}
+
+struct SplitSurfaceByConvex {
+	template <uint32_t FORMAT>
+	static void run(const Vector<Plane> &planes, const FaceBuffer &faces, SplitResult &result, LocalVector<Vector<Vector3>> &r_plane_segments, bool p_keep_outside) {
+		int plane_count = planes.size();
+		int vertex_count = faces.vertices.size();
+		r_plane_segments.resize(plane_count);
+
+		// Every vertex gets classified against every plane in one batched pass per plane,
+		// with plane p's sides starting at p * vertex_count
+		SplitScratch::Borrow scratch;
+		LocalVector<real_t> &distances = scratch->distances;
+		LocalVector<SideOfPlane> &sides = scratch->sides;
+		distances.resize(plane_count * vertex_count);
+		sides.resize(plane_count * vertex_count);
+		for (int p = 0; p < plane_count; p++) {
+			VertexClassifier::classify(planes[p], faces.vertices.ptr(), vertex_count, distances.ptr() + p * vertex_count, sides.ptr() + p * vertex_count);
+		}
+
+		// The pieces of a face still inside every plane handled so far. The two stages
+		// take turns being split from and split into
+		// Whatever a stage would put over its plane is thrown away unless the outside is kept
+		bool keep_outside = p_keep_outside && result.keep_upper;
+		SplitResult stages[2];
+		for (int k = 0; k < 2; k++) {
+			stages[k].set_format(faces.format);
+			stages[k].keep_upper = keep_outside;
+		}
+		LocalVector<uint8_t> crossed;
+		crossed.resize(plane_count);
+
+		for (int i = 0; i < faces.size(); i++) {
+			const Vector3 *corners = &faces.vertices[i * 3];
+			bool outside = false;
+			bool crossing = false;
+
+			// The part of a face lying flat on one of the planes that's inside the others
+			// goes to whichever side the mesh is solid on. That's the inside when the face
+			// points the same way as the plane, and since Godot's front faces wind clockwise
+			// that's when its corners wind counterclockwise around the plane's normal
+			bool flat = false;
+			bool flat_inside = false;
+
+			for (int p = 0; p < plane_count; p++) {
+				const SideOfPlane *face_sides = &sides[p * vertex_count + i * 3];
+				int over = 0;
+				int under = 0;
+				for (int j = 0; j < 3; j++) {
+					over += face_sides[j] == SideOfPlane::OVER;
+					under += face_sides[j] == SideOfPlane::UNDER;
+				}
+
+				crossed[p] = over > 0 && under > 0;
+				crossing |= crossed[p];
+				if (over > 0 || under > 0) {
+					// The whole cross section of each plane is needed to cap it, not just the
+					// part of it inside the volume, so the segments are gathered for every face
+					add_split_segment(planes[p], corners, face_sides, r_plane_segments[p]);
+					outside |= under == 0;
+					continue;
+				}
+
+				// The mesh only touches the plane there, so nothing needs capping. A face
+				// with the mesh solid under it traces its edges the other way round from
+				// the faces below them, cancelling them out of the cross section
+				flat = true;
+				flat_inside = (corners[1] - corners[0]).cross(corners[2] - corners[0]).dot(planes[p].normal) < 0;
+				for (int j = 0; j < 3 && flat_inside; j++) {
+					r_plane_segments[p].push_back(corners[(j + 1) % 3]);
+					r_plane_segments[p].push_back(corners[j]);
+				}
+			}
+
+			bool inside = !flat || flat_inside;
+			if (outside || (!crossing && !inside)) {
+				if (keep_outside) {
+					result.upper_faces.append_face<FORMAT>(faces, i);
+				}
+				continue;
+			}
+
+			if (!crossing) {
+				if (result.keep_lower) {
+					result.lower_faces.append_face<FORMAT>(faces, i);
+				}
+				continue;
+			}
+
+			// Peel the face apart one crossed plane at a time. Whatever ends up over a
+			// plane is outside for good and only the part under it carries on to the next
+			SplitResult *pieces = nullptr;
+			int stage = 0;
+			for (int p = 0; p < plane_count; p++) {
+				if (!crossed[p]) {
+					continue;
+				}
+
+				SplitResult &split = stages[stage];
+				split.reset();
+				if (pieces == nullptr) {
+					split_face<FORMAT>(planes[p], faces, i, &sides[p * vertex_count + i * 3], split);
+				} else {
+					const FaceBuffer &remaining = pieces->lower_faces;
+					for (int j = 0; j < remaining.size(); j++) {
+						SideOfPlane piece_sides[3];
+						for (int k = 0; k < 3; k++) {
+							piece_sides[k] = get_side_of(planes[p], remaining.vertices[j * 3 + k]);
+						}
+						split_face<FORMAT>(planes[p], remaining, j, piece_sides, split);
+					}
+				}
+
+				if (keep_outside) {
+					result.upper_faces.append_faces(split.upper_faces);
+				}
+				pieces = &split;
+				stage = 1 - stage;
+			}
+			if (inside && result.keep_lower) {
+				result.lower_faces.append_faces(pieces->lower_faces);
+			} else if (!inside && keep_outside) {
+				result.upper_faces.append_faces(pieces->lower_faces);
+			}
+		}
 	}
+};
 
-	// We've tried all of our clever edge cases, time to do a full intersection test
-	full_split(plane, face, info, result);
+void split_surface_by_convex(const Vector<Plane> &planes, const FaceBuffer &faces, SplitResult &result, LocalVector<Vector<Vector3>> &r_plane_segments, bool p_keep_outside) {
+	ERR_FAIL_COND(faces.is_indexed());
+	FormatDispatch::dispatch<SplitSurfaceByConvex>(faces.format, planes, faces, result, r_plane_segments, p_keep_outside);
 }
 } //namespace Intersector
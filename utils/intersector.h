@@ -31,7 +31,9 @@
 #ifndef INTERSECTOR_H
 #define INTERSECTOR_H
 
-#include "slicer_face.h"
+#include "face_buffer.h"
+
+struct FaceBVH;
 
 /**
  * Contains functions related to finding intersection points
@@ -41,7 +43,7 @@ namespace Intersector {
 // Note that this is slightly different than Face3::Side,
 // as it refers to the position of a single Vector3 rather
 // than a face
-enum SideOfPlane {
+enum SideOfPlane : uint8_t {
 	OVER,
 	UNDER,
 	ON,
@@ -49,29 +51,183 @@ enum SideOfPlane {
 
 struct SplitResult {
 	Ref<Material> material;
-	Vector<SlicerFace> upper_faces;
-	Vector<SlicerFace> lower_faces;
-	Vector<Vector3> intersection_points;
+	FaceBuffer upper_faces;
+	FaceBuffer lower_faces;
+	// The outline of the cross section, as one pair of points for every face the plane
+	// runs across, and the edges of faces lying flat on it. Edges on the plane can come
+	// up more than once, see Triangulator::triangulate_segments for how they're merged
+	// as it links the segments back up into loops
+	Vector<Vector3> cut_segments;
+
+	// Set to OVER or UNDER when the whole surface was found to be on that side of the
+	// plane. It then never gets split at all and the surface's original arrays are
+	// handed to that half as they are, instead of going through upper_faces and
+	// lower_faces
+	SideOfPlane unsplit_side = SideOfPlane::ON;
+	Array unsplit_arrays;
+	uint64_t unsplit_format = 0;
+
+	// Either half can be left out when only the other one is wanted, in which case no
+	// faces are ever added to it. The cut segments are collected either way. These are
+	// left alone by reset
+	bool keep_upper = true;
+	bool keep_lower = true;
+
+	_FORCE_INLINE_ bool keeps(SideOfPlane p_side) const {
+		return p_side == SideOfPlane::OVER ? keep_upper : keep_lower;
+	}
+
+	/**
+	 * Both halves carry the same attributes as the faces being split, so this
+	 * should be set to the source buffer's format before splitting into it
+	 */
+	void set_format(uint32_t p_format) {
+		upper_faces.set_format(p_format);
+		lower_faces.set_format(p_format);
+	}
 
 	void reset() {
-		upper_faces.resize(0);
-		lower_faces.resize(0);
-		intersection_points.resize(0);
+		upper_faces.clear();
+		lower_faces.clear();
+		cut_segments.resize(0);
+		unsplit_side = SideOfPlane::ON;
+		unsplit_arrays = Array();
+		unsplit_format = 0;
 	}
 
 	SplitResult() {}
 };
 
+/**
+ * Scratch buffers used while splitting, kept around between splits so that a steady
+ * stream of them stops allocating once the buffers have grown big enough. Only what a
+ * split throws away when it's done lives here, the halves it hands back are its own
+ */
+struct SplitScratch {
+	LocalVector<real_t> distances;
+	LocalVector<SideOfPlane> sides;
+
+	// Where each source vertex ended up in either half, for indexed surfaces
+	LocalVector<int> upper_map;
+	LocalVector<int> lower_map;
+
+	// The pieces of a surface split a chunk at a time on the WorkerThreadPool
+	LocalVector<SplitResult> chunks;
+
+	/**
+	 * Lends out one of the current thread's spare scratch buffers for as long as it's in
+	 * scope. Each thread keeps as many spares as it ever had lent out at once, since a
+	 * split waiting on the WorkerThreadPool can end up running another on the same thread
+	 */
+	class Borrow {
+		SplitScratch *scratch = nullptr;
+
+	public:
+		_FORCE_INLINE_ SplitScratch *operator->() const {
+			return scratch;
+		}
+
+		Borrow();
+		Borrow(const Borrow &) = delete;
+		Borrow &operator=(const Borrow &) = delete;
+		~Borrow();
+	};
+};
+
 /**
  * Calculates which side of the passed in plane the given point falls on
  */
 SideOfPlane get_side_of(const Plane &plane, Vector3 point);
 
 /**
- * Performs an intersection on the given face using the passed in plane and stores
- * the result in the result param.
+ * Same as get_side_of, for when the point's signed distance from the plane is already known
+ */
+_FORCE_INLINE_ SideOfPlane get_side_of_distance(real_t dist) {
+	if (dist > CMP_EPSILON) {
+		return SideOfPlane::OVER;
+	}
+
+	if (dist < -CMP_EPSILON) {
+		return SideOfPlane::UNDER;
+	}
+
+	return SideOfPlane::ON;
+}
+
+/**
+ * Which side of the plane a whole box falls on. Returns ON whenever any part of the box
+ * comes within CMP_EPSILON of the plane, so OVER and UNDER guarantee that every point
+ * inside the box would have come back the same from get_side_of
+ */
+SideOfPlane get_side_of_aabb(const Plane &plane, const AABB &aabb);
+
+/**
+ * Performs an intersection on the face at face_idx using the passed in plane and stores
+ * the result in the result param. Only works on non indexed buffers, see
+ * split_surface_by_plane for handling both
+ */
+void split_face_by_plane(const Plane &plane, const FaceBuffer &faces, int face_idx, SplitResult &result);
+
+/**
+ * Splits every face of the buffer by the passed in plane. Indexed buffers stay indexed,
+ * with each vertex classified once and each cut edge intersected once, so faces sharing
+ * an edge in the source also share the new vertices along the cut.
+ *
+ * When given a tree built over the faces (see FaceBVH) only the faces in leaves reaching
+ * the plane get looked at individually, everything else is copied over a subtree at a time
+ */
+void split_surface_by_plane(const Plane &plane, const FaceBuffer &faces, SplitResult &result, const FaceBVH *p_bvh = nullptr);
+
+/**
+ * Splits a surface by a plane the same way split_surface_by_plane does, only a batch of
+ * faces at a time, so a big split can be spread out over several calls. The faces and the
+ * result have to stay where they are until the splitter is done with them. Trees built
+ * over the faces aren't used, every face gets looked at on its own
+ */
+class SurfaceSplitter {
+public:
+	struct State;
+
+private:
+	State *state = nullptr;
+
+public:
+	/**
+	 * Splits about p_max_faces more faces. Indexed surfaces first classify their vertices,
+	 * the same amount of them at a time. Returns whether there's anything left to split
+	 */
+	bool split(int p_max_faces);
+
+	bool is_done() const;
+
+	/**
+	 * How many of the surface's faces have been split so far, out of get_face_count
+	 */
+	int get_split_face_count() const;
+	int get_face_count() const;
+
+	SurfaceSplitter(const Plane &p_plane, const FaceBuffer &p_faces, SplitResult &r_result);
+	SurfaceSplitter(const SurfaceSplitter &) = delete;
+	SurfaceSplitter &operator=(const SurfaceSplitter &) = delete;
+	~SurfaceSplitter();
+};
+
+/**
+ * Splits every face of the buffer by a convex volume, given as the planes bounding it with
+ * their normals facing outwards. Whatever is behind all of the planes ends up in the
+ * result's lower_faces and the rest in its upper_faces. Each face is classified against
+ * every plane up front, so faces wholly inside or outside are copied over as they are and
+ * the rest only get split by the planes they actually cross.
+ *
+ * A face lying flat on one of the planes is split by the others like any other face, with
+ * the part inside them going to whichever side the mesh is solid on.
+ *
+ * r_plane_segments gets one entry per plane, holding the cut segments of every face crossing
+ * that plane, whether or not they're inside the volume. Where the mesh only touches a plane
+ * there's nothing to cap, and its segments cancel out. Without p_keep_outside nothing is
+ * added to upper_faces, for when only the inside is wanted. Only works on non indexed buffers
  */
-void split_face_by_plane(const Plane &plane, const SlicerFace &face, SplitResult &result);
+void split_surface_by_convex(const Vector<Plane> &planes, const FaceBuffer &faces, SplitResult &result, LocalVector<Vector<Vector3>> &r_plane_segments, bool p_keep_outside = true);
 } //namespace Intersector
 
 #endif // INTERSECTOR_H
@@ -0,0 +1,184 @@
+/**************************************************************************/
+/*  mesh_cache.cpp                                                        */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "mesh_cache.h"
+
+#include "core/core_string_names.h"
+#include "core/error/error_macros.h"
+
+void MeshCache::_mesh_changed(RID p_rid) {
+	MutexLock lock(mutex);
+	version++;
+	_erase(p_rid);
+}
+
+void MeshCache::_erase(const RID &p_rid) {
+	Entry *entry = entries.getptr(p_rid);
+	if (!entry) {
+		return;
+	}
+
+	memory_usage -= entry->memory_usage;
+	lru.erase(entry->lru);
+	entries.erase(p_rid);
+}
+
+void MeshCache::_evict_to(uint64_t p_memory_limit) {
+	while (memory_usage > p_memory_limit && lru.back()) {
+		// Copied out since erasing frees the list element holding it
+		RID rid = lru.back()->get();
+		_erase(rid);
+	}
+}
+
+void MeshCache::_watch(const Ref<Mesh> &p_mesh, const RID &p_rid) {
+	// The connection is left in place once made, a change to a mesh that has since been
+	// evicted is just a cheap miss
+	Callable on_changed = callable_mp(this, &MeshCache::_mesh_changed).bind(p_rid);
+	if (!p_mesh->is_connected(CoreStringName(changed), on_changed)) {
+		p_mesh->connect_changed(on_changed);
+	}
+}
+
+void MeshCache::_insert(const RID &p_rid, const Ref<ParsedMesh> &p_parsed, uint64_t p_memory_usage) {
+	// Meshes bigger than the whole cache are never cached
+	if (p_memory_usage > memory_limit) {
+		return;
+	}
+
+	_erase(p_rid);
+	_evict_to(memory_limit - MIN(p_memory_usage, memory_limit));
+
+	Entry entry;
+	entry.parsed = p_parsed;
+	entry.memory_usage = p_memory_usage;
+	entry.lru = lru.push_front(p_rid);
+	entries.insert(p_rid, entry);
+	memory_usage += p_memory_usage;
+}
+
+Ref<ParsedMesh> MeshCache::get_parsed_mesh(const Ref<Mesh> &p_mesh, bool p_preserve_indices, bool p_build_bvh) {
+	ERR_FAIL_COND_V(p_mesh.is_null(), Ref<ParsedMesh>());
+	RID rid = p_mesh->get_rid();
+	if (!rid.is_valid()) {
+		return ParsedMesh::parse(p_mesh, p_preserve_indices, p_build_bvh);
+	}
+
+	// A cached entry that only lacks a tree still has all the faces the tree gets built
+	// over, so there's no need to read the mesh back in for it
+	Ref<ParsedMesh> without_bvh;
+	{
+		MutexLock lock(mutex);
+		Entry *entry = entries.getptr(rid);
+		if (entry && entry->parsed->preserve_indices == p_preserve_indices) {
+			if (entry->parsed->has_bvh || !p_build_bvh) {
+				lru.move_to_front(entry->lru);
+				return entry->parsed;
+			}
+			without_bvh = entry->parsed;
+		}
+	}
+
+	// Listen for changes before parsing so that there's no window where the mesh could
+	// change without us hearing about it
+	_watch(p_mesh, rid);
+
+	uint64_t parse_version;
+	{
+		MutexLock lock(mutex);
+		parse_version = version;
+	}
+
+	// Parsing is the slow part so it happens outside of the lock. If another thread
+	// happens to be parsing the same mesh the second result just replaces the first
+	Ref<ParsedMesh> parsed = without_bvh.is_valid() ? without_bvh->duplicate_with_bvh() : ParsedMesh::parse(p_mesh, p_preserve_indices, p_build_bvh);
+	uint64_t parsed_memory = parsed->get_memory_usage();
+	{
+		MutexLock lock(mutex);
+		if (version != parse_version) {
+			// The mesh, or one like it, changed while we were parsing. Still hand back the
+			// result but don't trust it enough to cache
+			return parsed;
+		}
+
+		_insert(rid, parsed, parsed_memory);
+	}
+
+	return parsed;
+}
+
+void MeshCache::add_parsed_mesh(const Ref<Mesh> &p_mesh, const Ref<ParsedMesh> &p_parsed) {
+	ERR_FAIL_COND(p_mesh.is_null());
+	ERR_FAIL_COND(p_parsed.is_null());
+	RID rid = p_mesh->get_rid();
+	if (!rid.is_valid()) {
+		return;
+	}
+
+	_watch(p_mesh, rid);
+	uint64_t parsed_memory = p_parsed->get_memory_usage();
+	MutexLock lock(mutex);
+	_insert(rid, p_parsed, parsed_memory);
+}
+
+void MeshCache::set_memory_limit(uint64_t p_memory_limit) {
+	MutexLock lock(mutex);
+	memory_limit = p_memory_limit;
+	_evict_to(memory_limit);
+}
+
+uint64_t MeshCache::get_memory_limit() const {
+	MutexLock lock(mutex);
+	return memory_limit;
+}
+
+uint64_t MeshCache::get_memory_usage() {
+	MutexLock lock(mutex);
+	return memory_usage;
+}
+
+int MeshCache::get_entry_count() {
+	MutexLock lock(mutex);
+	return entries.size();
+}
+
+bool MeshCache::has_mesh(const Ref<Mesh> &p_mesh) {
+	ERR_FAIL_COND_V(p_mesh.is_null(), false);
+	MutexLock lock(mutex);
+	return entries.has(p_mesh->get_rid());
+}
+
+void MeshCache::clear() {
+	MutexLock lock(mutex);
+	version++;
+	entries.clear();
+	lru.clear();
+	memory_usage = 0;
+}
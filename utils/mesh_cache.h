@@ -0,0 +1,104 @@
+/**************************************************************************/
+/*  mesh_cache.h                                                          */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include "core/object/object.h"
+#include "core/os/mutex.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/list.h"
+#include "core/templates/rid.h"
+#include "parsed_mesh.h"
+
+/**
+ * Keeps hold of the parsed form of recently sliced meshes so that slicing the same mesh
+ * again can skip reading it back out of the rendering server. Entries are keyed by the
+ * mesh's RID, dropped whenever the mesh emits `changed`, and evicted least recently used
+ * first once the cache grows past its memory limit.
+ *
+ * Lookups are guarded by a mutex so a single cache can be shared by slices happening on
+ * different threads
+ */
+class MeshCache : public Object {
+	GDCLASS(MeshCache, Object);
+
+	struct Entry {
+		Ref<ParsedMesh> parsed;
+		uint64_t memory_usage = 0;
+		List<RID>::Element *lru = nullptr;
+	};
+
+	mutable Mutex mutex;
+	HashMap<RID, Entry> entries;
+	// Most recently used at the front
+	List<RID> lru;
+
+	uint64_t memory_limit = 32 * 1024 * 1024;
+	uint64_t memory_usage = 0;
+
+	// Bumped on every invalidation so that a parse racing against a change to its mesh
+	// doesn't get cached after the fact
+	uint64_t version = 0;
+
+	void _mesh_changed(RID p_rid);
+	void _watch(const Ref<Mesh> &p_mesh, const RID &p_rid);
+	void _insert(const RID &p_rid, const Ref<ParsedMesh> &p_parsed, uint64_t p_memory_usage);
+	void _erase(const RID &p_rid);
+	void _evict_to(uint64_t p_memory_limit);
+
+public:
+	/**
+	 * Returns the parsed form of the mesh, only parsing it if it isn't already cached. A
+	 * cached mesh which already has a FaceBVH is also handed out when p_build_bvh isn't set
+	 */
+	Ref<ParsedMesh> get_parsed_mesh(const Ref<Mesh> &p_mesh, bool p_preserve_indices = false, bool p_build_bvh = false);
+
+	/**
+	 * Caches an already parsed form of the mesh, replacing whatever was cached for it. For
+	 * meshes built out of faces that are still at hand, such as the halves of a slice
+	 */
+	void add_parsed_mesh(const Ref<Mesh> &p_mesh, const Ref<ParsedMesh> &p_parsed);
+
+	/**
+	 * The most memory, in bytes, the cached meshes may use before the least recently
+	 * used ones start getting evicted. Meshes bigger than this on their own are never cached
+	 */
+	void set_memory_limit(uint64_t p_memory_limit);
+	uint64_t get_memory_limit() const;
+
+	uint64_t get_memory_usage();
+	int get_entry_count();
+	bool has_mesh(const Ref<Mesh> &p_mesh);
+
+	void clear();
+};
+
+#endif // MESH_CACHE_H
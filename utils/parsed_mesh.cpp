@@ -0,0 +1,128 @@
+/**************************************************************************/
+/*  parsed_mesh.cpp                                                       */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "parsed_mesh.h"
+
+#include "core/error/error_macros.h"
+#include "intersector.h"
+
+static AABB get_arrays_aabb(const Array &p_arrays) {
+	Vector<Vector3> positions = p_arrays[Mesh::ARRAY_VERTEX];
+	AABB aabb;
+	if (positions.size() == 0) {
+		return aabb;
+	}
+
+	const Vector3 *positions_ptr = positions.ptr();
+	aabb.position = positions_ptr[0];
+	for (int i = 1; i < positions.size(); i++) {
+		aabb.expand_to(positions_ptr[i]);
+	}
+	return aabb;
+}
+
+Ref<ParsedMesh> ParsedMesh::parse(const Ref<Mesh> &p_mesh, bool p_preserve_indices, bool p_build_bvh) {
+	ERR_FAIL_COND_V(p_mesh.is_null(), Ref<ParsedMesh>());
+
+	Ref<ParsedMesh> parsed;
+	parsed.instantiate();
+	parsed->preserve_indices = p_preserve_indices;
+	parsed->has_bvh = p_build_bvh;
+	parsed->surfaces.resize(p_mesh->get_surface_count());
+
+	for (int i = 0; i < p_mesh->get_surface_count(); i++) {
+		Surface &surface = parsed->surfaces[i];
+		surface.material = p_mesh->surface_get_material(i);
+		surface.faces = FaceBuffer::faces_from_surface(p_mesh, i, p_preserve_indices);
+		surface.aabb = surface.faces.get_aabb();
+		if (p_build_bvh) {
+			surface.bvh.build(surface.faces);
+		}
+	}
+
+	return parsed;
+}
+
+Ref<ParsedMesh> ParsedMesh::duplicate_with_bvh() const {
+	Ref<ParsedMesh> parsed;
+	parsed.instantiate();
+	parsed->preserve_indices = preserve_indices;
+	parsed->has_bvh = true;
+	parsed->surfaces = surfaces;
+
+	for (uint32_t i = 0; i < parsed->surfaces.size(); i++) {
+		Surface &surface = parsed->surfaces[i];
+		if (!has_bvh) {
+			surface.bvh.build(surface.faces);
+		}
+	}
+
+	return parsed;
+}
+
+Ref<ParsedMesh> ParsedMesh::parse_for_plane(const Ref<Mesh> &p_mesh, bool p_preserve_indices, const Plane &p_plane) {
+	ERR_FAIL_COND_V(p_mesh.is_null(), Ref<ParsedMesh>());
+
+	Ref<ParsedMesh> parsed;
+	parsed.instantiate();
+	parsed->preserve_indices = p_preserve_indices;
+	parsed->surfaces.resize(p_mesh->get_surface_count());
+
+	for (int i = 0; i < p_mesh->get_surface_count(); i++) {
+		parse_surface_for_plane(p_mesh, i, p_preserve_indices, p_plane, parsed->surfaces[i]);
+	}
+
+	return parsed;
+}
+
+void ParsedMesh::parse_surface_for_plane(const Ref<Mesh> &p_mesh, int p_surface, bool p_preserve_indices, const Plane &p_plane, Surface &r_surface) {
+	r_surface.material = p_mesh->surface_get_material(p_surface);
+	if (p_mesh->surface_get_primitive_type(p_surface) != Mesh::PRIMITIVE_TRIANGLES || p_mesh->surface_get_array_len(p_surface) == 0) {
+		return;
+	}
+
+	// The arrays have to be read out either way, but finding the bounds only needs
+	// the positions and is a lot cheaper than filling in every attribute of every face
+	Array arrays = p_mesh->surface_get_arrays(p_surface);
+	r_surface.aabb = get_arrays_aabb(arrays);
+	if (Intersector::get_side_of_aabb(p_plane, r_surface.aabb) != Intersector::SideOfPlane::ON) {
+		r_surface.arrays = arrays;
+	} else {
+		r_surface.faces = FaceBuffer::faces_from_arrays(arrays, p_preserve_indices);
+	}
+}
+
+uint64_t ParsedMesh::get_memory_usage() const {
+	uint64_t usage = sizeof(ParsedMesh) + surfaces.size() * sizeof(Surface);
+	for (uint32_t i = 0; i < surfaces.size(); i++) {
+		usage += surfaces[i].faces.get_memory_usage() + surfaces[i].bvh.get_memory_usage();
+	}
+	return usage;
+}
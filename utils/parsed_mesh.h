@@ -0,0 +1,99 @@
+/**************************************************************************/
+/*  parsed_mesh.h                                                         */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef PARSED_MESH_H
+#define PARSED_MESH_H
+
+#include "core/object/ref_counted.h"
+#include "core/templates/local_vector.h"
+#include "face_buffer.h"
+#include "face_bvh.h"
+#include "scene/resources/mesh.h"
+
+/**
+ * The slice ready form of a whole mesh: one FaceBuffer per surface along with the
+ * surface's material. Reading a mesh's arrays back out of the rendering server and
+ * into face buffers is the most expensive part of a slice that doesn't depend on the
+ * plane, so once built a ParsedMesh is treated as read only and can be shared between
+ * any number of slices
+ */
+class ParsedMesh : public RefCounted {
+	GDCLASS(ParsedMesh, RefCounted);
+
+public:
+	struct Surface {
+		Ref<Material> material;
+		// Lets a slice tell that the plane misses the surface without looking at any of
+		// its faces
+		AABB aabb;
+		FaceBuffer faces;
+		// Empty unless the mesh was parsed with p_build_bvh
+		FaceBVH bvh;
+		// Only kept for the surfaces parse_for_plane skipped, see there
+		Array arrays;
+	};
+
+	LocalVector<Surface> surfaces;
+	bool preserve_indices = false;
+	bool has_bvh = false;
+
+	/**
+	 * Parses every surface of the mesh, see FaceBuffer::faces_from_surface. With
+	 * p_build_bvh each surface also gets a FaceBVH built over it, which reorders its faces
+	 */
+	static Ref<ParsedMesh> parse(const Ref<Mesh> &p_mesh, bool p_preserve_indices = false, bool p_build_bvh = false);
+
+	/**
+	 * Like parse, except only the surfaces the plane actually reaches get turned into
+	 * faces. Surfaces wholly on one side of it are left with empty faces and hold on to
+	 * their raw arrays instead, since all a slice will do with them is pass them through.
+	 * The result is specific to the plane so it shouldn't be cached
+	 */
+	static Ref<ParsedMesh> parse_for_plane(const Ref<Mesh> &p_mesh, bool p_preserve_indices, const Plane &p_plane);
+
+	/**
+	 * What parse_for_plane does for each of the mesh's surfaces, for parsing them one at
+	 * a time
+	 */
+	static void parse_surface_for_plane(const Ref<Mesh> &p_mesh, int p_surface, bool p_preserve_indices, const Plane &p_plane, Surface &r_surface);
+
+	/**
+	 * A copy of this mesh with a FaceBVH built over every surface. The copy is needed
+	 * since building the tree reorders the faces, and a parsed mesh may be shared
+	 */
+	Ref<ParsedMesh> duplicate_with_bvh() const;
+
+	/**
+	 * Roughly how many bytes the parsed surfaces are holding on to
+	 */
+	uint64_t get_memory_usage() const;
+};
+
+#endif // PARSED_MESH_H
@@ -29,8 +29,6 @@
 /**************************************************************************/
 
 #include "slicer_face.h"
-#include "core/error/error_macros.h"
-#include "face_filler.h"
 #include "triangulator.h"
 
 /**
@@ -45,51 +43,6 @@ void ortho_normalize(Vector3 &normal, Vector3 &tangent) {
 	tangent.normalize();
 }
 
-Vector<SlicerFace> parse_mesh_arrays(const Ref<Mesh> mesh, int surface_idx, bool is_index_array) {
-	ERR_FAIL_COND_V(mesh.is_null(), Vector<SlicerFace>());
-	Vector<SlicerFace> faces;
-	ERR_FAIL_INDEX_V(surface_idx, mesh->get_surface_count(), faces);
-	int vert_count = is_index_array ? mesh->surface_get_array_index_len(surface_idx) : mesh->surface_get_array_len(surface_idx);
-	if (vert_count == 0 || vert_count % 3 != 0) {
-		return faces;
-	}
-
-	faces.resize(vert_count / 3);
-
-	Array arrays = mesh->surface_get_arrays(surface_idx);
-	FaceFiller filler(faces, arrays);
-
-	if (is_index_array) {
-		Vector<int> indices = arrays[Mesh::ARRAY_INDEX];
-
-		for (int i = 0; i < vert_count; i++) {
-			filler.fill(i, indices.write[i]);
-		}
-	} else {
-		for (int i = 0; i < vert_count; i++) {
-			filler.fill(i, i);
-		}
-	}
-
-	return faces;
-}
-
-Vector<SlicerFace> SlicerFace::faces_from_surface(Ref<Mesh> mesh, int surface_idx) {
-	ERR_FAIL_COND_V(mesh.is_null(), Vector<SlicerFace>());
-	ERR_FAIL_INDEX_V(surface_idx, mesh->get_surface_count(), Vector<SlicerFace>());
-	// Slicer functionality really only makes sense in the context of a mesh composed of
-	// triangles
-	if (mesh->surface_get_primitive_type(surface_idx) != Mesh::PRIMITIVE_TRIANGLES) {
-		return Vector<SlicerFace>();
-	}
-
-	if (mesh->surface_get_format(surface_idx) & Mesh::ARRAY_FORMAT_INDEX) {
-		return parse_mesh_arrays(mesh, surface_idx, true);
-	} else {
-		return parse_mesh_arrays(mesh, surface_idx, false);
-	}
-}
-
 SlicerFace SlicerFace::sub_face(Vector3 a, Vector3 b, Vector3 c) const {
 	SlicerFace new_face(a, b, c);
 
@@ -164,17 +117,23 @@ void SlicerFace::compute_tangents() {
 		return;
 	}
 
-	real_t x1 = vertex[1].x - vertex[0].x;
-	real_t x2 = vertex[2].x - vertex[0].x;
-	real_t y1 = vertex[1].y - vertex[0].y;
-	real_t y2 = vertex[2].y - vertex[0].y;
-	real_t z1 = vertex[1].z - vertex[0].z;
-	real_t z2 = vertex[2].z - vertex[0].z;
+	Vector4 tangents[3];
+	compute_tangents(vertex, normal, uv, tangents);
+	set_tangents(tangents[0], tangents[1], tangents[2]);
+}
+
+void SlicerFace::compute_tangents(const Vector3 *p_vertices, const Vector3 *p_normals, const Vector2 *p_uvs, Vector4 *r_tangents) {
+	real_t x1 = p_vertices[1].x - p_vertices[0].x;
+	real_t x2 = p_vertices[2].x - p_vertices[0].x;
+	real_t y1 = p_vertices[1].y - p_vertices[0].y;
+	real_t y2 = p_vertices[2].y - p_vertices[0].y;
+	real_t z1 = p_vertices[1].z - p_vertices[0].z;
+	real_t z2 = p_vertices[2].z - p_vertices[0].z;
 
-	real_t s1 = uv[1].x - uv[0].x;
-	real_t s2 = uv[2].x - uv[0].x;
-	real_t t1 = uv[1].y - uv[0].y;
-	real_t t2 = uv[2].y - uv[0].y;
+	real_t s1 = p_uvs[1].x - p_uvs[0].x;
+	real_t s2 = p_uvs[2].x - p_uvs[0].x;
+	real_t t1 = p_uvs[1].y - p_uvs[0].y;
+	real_t t2 = p_uvs[2].y - p_uvs[0].y;
 
 	real_t r = 1.0f / (s1 * t2 - s2 * t1);
 
@@ -184,29 +143,27 @@ void SlicerFace::compute_tangents() {
 	// I feel like we can DRY this up a bit. But honestly all this logic is foreign to me and I wouldn't
 	// even know if I was breaking something. Maybe something worth tackling after adding a few more test
 	// cases to check for regressions
-	Vector3 n1 = normal[0];
+	Vector3 n1 = p_normals[0];
 	Vector3 nt1 = sdir;
 	ortho_normalize(n1, nt1);
-	Vector4 tan_a = Vector4(nt1.x, nt1.y, nt1.z, (n1.cross(nt1).dot(tdir) < 0.0f) ? -1.0f : 1.0f);
+	r_tangents[0] = Vector4(nt1.x, nt1.y, nt1.z, (n1.cross(nt1).dot(tdir) < 0.0f) ? -1.0f : 1.0f);
 
-	Vector3 n2 = normal[1];
+	Vector3 n2 = p_normals[1];
 	Vector3 nt2 = sdir;
 	ortho_normalize(n2, nt2);
-	Vector4 tan_b = Vector4(nt2.x, nt2.y, nt2.z, (n2.cross(nt2).dot(tdir) < 0.0f) ? -1.0f : 1.0f);
+	r_tangents[1] = Vector4(nt2.x, nt2.y, nt2.z, (n2.cross(nt2).dot(tdir) < 0.0f) ? -1.0f : 1.0f);
 
-	Vector3 n3 = normal[2];
+	Vector3 n3 = p_normals[2];
 	Vector3 nt3 = sdir;
 	ortho_normalize(n3, nt3);
-	Vector4 tan_c = Vector4(nt3.x, nt3.y, nt3.z, (n3.cross(nt3).dot(tdir) < 0.0f) ? -1.0f : 1.0f);
-
-	set_tangents(tan_a, tan_b, tan_c);
+	r_tangents[2] = Vector4(nt3.x, nt3.y, nt3.z, (n3.cross(nt3).dot(tdir) < 0.0f) ? -1.0f : 1.0f);
 }
 
 Vector3 SlicerFace::barycentric_weights(Vector3 p) const {
-	Vector3 a = vertex[0];
-	Vector3 b = vertex[1];
-	Vector3 c = vertex[2];
+	return barycentric_weights(vertex[0], vertex[1], vertex[2], p);
+}
 
+Vector3 SlicerFace::barycentric_weights(const Vector3 &a, const Vector3 &b, const Vector3 &c, const Vector3 &p) {
 	Vector3 m = (b - a).cross(c - a);
 
 	real_t nu;
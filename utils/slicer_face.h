@@ -41,10 +41,10 @@
  * of things like UV and normal mappings
  */
 struct SlicerFace : public Face3 {
-	// Maybe it would be smarter to have these be pointers or PoolVectors,
-	// seeing as most of these may often go unused. But for simplicity's
-	// sake let's just do it the memory naive way and allocate what we
-	// might need
+	// This is the memory naive way of holding a face, allocating room for every
+	// attribute whether it's used or not. That's fine for working with a face or
+	// two at a time, but anything dealing with whole surfaces should be using
+	// FaceBuffer, which only stores the attributes that are actually present
 	bool has_normals;
 	Vector3 normal[3];
 
@@ -70,13 +70,6 @@ struct SlicerFace : public Face3 {
 	bool has_uv2s;
 	Vector2 uv2[3];
 
-	/**
-	 * Parse a mesh's surface into a vector of faces. This will preserve the mapping
-	 * associated with each vertex and can handle both indexed and non indexed vertex
-	 * arrays
-	 */
-	static Vector<SlicerFace> faces_from_surface(const Ref<Mesh> mesh, int surface_idx);
-
 	/**
 	 * Creates a new face while using barycentric weights to interpolate UV, normal, etc
 	 * info on to the new points.
@@ -94,6 +87,18 @@ struct SlicerFace : public Face3 {
 	 */
 	Vector3 barycentric_weights(Vector3 point) const;
 
+	/**
+	 * Calculates Barycentric coordinate weight values for the given point in respect to
+	 * the triangle abc.
+	 */
+	static Vector3 barycentric_weights(const Vector3 &a, const Vector3 &b, const Vector3 &c, const Vector3 &point);
+
+	/**
+	 * Generates tangents for the three points of a triangle from its normals and UVs.
+	 * Shared between SlicerFace and FaceBuffer, which keep those values in different places
+	 */
+	static void compute_tangents(const Vector3 *p_vertices, const Vector3 *p_normals, const Vector2 *p_uvs, Vector4 *r_tangents);
+
 	void set_uvs(Vector2 a, Vector2 b, Vector2 c) {
 		has_uvs = true;
 		uv[0] = a;
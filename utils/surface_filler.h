@@ -31,12 +31,15 @@
 #ifndef SURFACE_FILLER_H
 #define SURFACE_FILLER_H
 
-#include "slicer_face.h"
+#include "face_buffer.h"
+#include "servers/rendering_server.h"
 
 /**
  * The inverse of FaceFiller, this struct is responsible for taking
- * SlicerFaces and serializing them back into vertex arrays for Godot
- * to read into a mesh surface
+ * a FaceBuffer and serializing it back into a mesh surface. Rather than
+ * going through vertex arrays (which Godot would then validate and pack
+ * all over again) vertices are encoded straight into the byte layout
+ * the RenderingServer stores surfaces in
  */
 struct SurfaceFiller {
 	bool has_normals;
@@ -47,173 +50,375 @@ struct SurfaceFiller {
 	bool has_uvs;
 	bool has_uv2s;
 
-	Array arrays;
-	Vector<Vector3> vertices;
+	uint64_t format;
+	int vertex_count;
+
+	// Where each attribute starts within its stream and how far apart consecutive
+	// vertices are, as the RenderingServer lays them out
+	uint32_t offsets[RS::ARRAY_MAX];
+	uint32_t vertex_stride;
+	uint32_t normal_stride;
+	uint32_t attribute_stride;
+	uint32_t skin_stride;
+
+	// Positions for every vertex, followed by normals and tangents for every vertex
+	Vector<uint8_t> vertex_data;
+	uint8_t *vertex_ptrw = nullptr;
+
+	// Colors and uvs, interleaved
+	Vector<uint8_t> attribute_data;
+	uint8_t *attribute_ptrw = nullptr;
+
+	// Bone indices and weights, interleaved
+	Vector<uint8_t> skin_data;
+	uint8_t *skin_ptrw = nullptr;
+
+	Vector<uint8_t> index_data;
+	int index_count = 0;
+
+	// Worked out as vertices get filled, so the engine doesn't need to go over them again
+	AABB aabb;
+	Vector<AABB> bone_aabbs;
+
+	const FaceBuffer &faces;
+
+	SurfaceFiller(const FaceBuffer &p_faces) :
+			faces(p_faces) {
+		has_normals = faces.has(FaceBuffer::ATTRIBUTE_NORMAL);
+		has_tangents = faces.has(FaceBuffer::ATTRIBUTE_TANGENT);
+		has_colors = faces.has(FaceBuffer::ATTRIBUTE_COLOR);
+		has_bones = faces.has(FaceBuffer::ATTRIBUTE_BONES);
+		has_weights = faces.has(FaceBuffer::ATTRIBUTE_WEIGHTS);
+		has_uvs = faces.has(FaceBuffer::ATTRIBUTE_UV);
+		has_uv2s = faces.has(FaceBuffer::ATTRIBUTE_UV2);
+
+		format = RS::ARRAY_FORMAT_VERTEX | RS::ARRAY_FLAG_FORMAT_CURRENT_VERSION;
+		if (has_normals) {
+			format |= RS::ARRAY_FORMAT_NORMAL;
+		}
+
+		if (has_tangents) {
+			format |= RS::ARRAY_FORMAT_TANGENT;
+		}
 
-	Vector<Vector3> normals;
+		if (has_colors) {
+			format |= RS::ARRAY_FORMAT_COLOR;
+		}
 
-	Vector<real_t> tangents;
+		if (has_bones) {
+			format |= RS::ARRAY_FORMAT_BONES;
+		}
 
-	Vector<Color> colors;
+		if (has_weights) {
+			format |= RS::ARRAY_FORMAT_WEIGHTS;
+		}
 
-	Vector<real_t> bones;
+		if (has_uvs) {
+			format |= RS::ARRAY_FORMAT_TEX_UV;
+		}
 
-	Vector<real_t> weights;
+		if (has_uv2s) {
+			format |= RS::ARRAY_FORMAT_TEX_UV2;
+		}
 
-	Vector<Vector2> uvs;
+		if (faces.is_indexed()) {
+			format |= RS::ARRAY_FORMAT_INDEX;
+		}
 
-	Vector<Vector2> uv2s;
+		// Indexed buffers already hold each vertex once, and for the rest this is
+		// just three per face
+		vertex_count = faces.vertices.size();
+		RS::get_singleton()->mesh_surface_make_offsets_from_format(format, vertex_count, faces.indices.size(), offsets, vertex_stride, normal_stride, attribute_stride, skin_stride);
 
-	Vector<SlicerFace> faces;
+		vertex_data.resize(vertex_count * (vertex_stride + normal_stride));
+		vertex_ptrw = vertex_data.ptrw();
 
-	SurfaceFiller(const Vector<SlicerFace> &p_faces) {
-		faces = p_faces;
-		SlicerFace first_face = faces[0];
+		if (attribute_stride > 0) {
+			attribute_data.resize(vertex_count * attribute_stride);
+			attribute_ptrw = attribute_data.ptrw();
+		}
 
-		has_normals = first_face.has_normals;
-		has_tangents = first_face.has_tangents;
-		has_colors = first_face.has_colors;
-		has_bones = first_face.has_bones;
-		has_weights = first_face.has_weights;
-		has_uvs = first_face.has_uvs;
-		has_uv2s = first_face.has_uv2s;
+		if (skin_stride > 0) {
+			skin_data.resize(vertex_count * skin_stride);
+			skin_ptrw = skin_data.ptrw();
+		}
 
-		arrays.resize(Mesh::ARRAY_MAX);
+		if (vertex_count > 0) {
+			aabb = AABB(faces.vertices[0], Vector3());
+		}
+	}
 
-		int array_length = faces.size() * 3;
-		vertices.resize(array_length);
+	/**
+	 * Takes data from the face buffer's vertex at lookup_idx and encodes it
+	 * into the vertex at set_idx of the surface (see add_to_mesh for how to
+	 * attach that information into a mesh). Whole surfaces are better off
+	 * going through fill_vertices, which streams one attribute at a time
+	 */
+	void fill(int lookup_idx, int set_idx) {
+		// TODO - I think the function definition here with lookup_idx and set_idx
+		// is reversed from FaceFiller#fill. We should make that more consistent
+		aabb.expand_to(faces.vertices[lookup_idx]);
+		write_position(set_idx, faces.vertices[lookup_idx]);
 
-		// There's gotta be a less tedious way of doing this
 		if (has_normals) {
-			normals.resize(array_length);
+			write_normal(set_idx, faces.normals[lookup_idx]);
 		}
 
 		if (has_tangents) {
-			tangents.resize(array_length * 4);
+			write_tangent(set_idx, faces.tangents[lookup_idx]);
 		}
 
 		if (has_colors) {
-			colors.resize(array_length);
+			write_color(set_idx, faces.colors[lookup_idx]);
 		}
 
-		if (has_bones) {
-			bones.resize(array_length * 4);
+		if (has_uvs) {
+			write_uv(RS::ARRAY_TEX_UV, set_idx, faces.uvs[lookup_idx]);
 		}
 
-		if (has_weights) {
-			weights.resize(array_length * 4);
+		if (has_uv2s) {
+			write_uv(RS::ARRAY_TEX_UV2, set_idx, faces.uv2s[lookup_idx]);
 		}
 
-		if (has_uvs) {
-			uvs.resize(array_length);
+		if (has_bones) {
+			write_bones(set_idx, lookup_idx);
 		}
 
-		if (has_uv2s) {
-			uv2s.resize(array_length);
+		if (has_weights) {
+			write_weights(set_idx, faces.weights[lookup_idx]);
 		}
 	}
 
 	/**
-	 * Takes data from the faces using the lookup_idx and stores it
-	 * to be saved into vertex arrays (see add_to_mesh for how to attach
-	 * that information into a mesh)
+	 * Fills every vertex of the face buffer. Rather than going vertex by vertex this
+	 * makes one pass per attribute, reading each of the buffer's streams front to back
+	 * and writing straight into the surface. Flipping the winding swaps the last two
+	 * corners of every face, which for indexed buffers is left to fill_indices
 	 */
-	_FORCE_INLINE_ void fill(int lookup_idx, int set_idx) {
-		// TODO - I think the function definition here with lookup_idx and set_idx
-		// is reversed from FaceFiller#fill. We should make that more consistent
-		//
-		// As mentioned in the FaceFiller comments, while having this function work
-		// on a vertex by vertex basis helps with cleaner code (especially, in this case,
-		// when it comes to reversing the order of cross section verts), its conceptually
-		// and perhaps performance drawback back by having to do these repeated calculations
-		// and boolean checks (I'd hope the force_inline would help with the function invocation
-		// cost but even then who knows).
-		int face_idx = lookup_idx / 3;
-		int idx_offset = lookup_idx % 3;
+	void fill_vertices(bool p_flip_winding = false) {
+		if (p_flip_winding && !faces.is_indexed()) {
+			stream_vertices<true>();
+		} else {
+			stream_vertices<false>();
+		}
+	}
 
-		SlicerFace face = faces[face_idx];
+	template <bool FLIP>
+	static _FORCE_INLINE_ int get_target(int p_vertex) {
+		if (!FLIP) {
+			return p_vertex;
+		}
+
+		// Corners 1 and 2 of each face trade places
+		static const int shift[3] = { 0, 1, -1 };
+		return p_vertex + shift[p_vertex % 3];
+	}
 
-		vertices.write[set_idx] = face.vertex[idx_offset];
+	template <bool FLIP>
+	void stream_vertices() {
+		for (int i = 0; i < vertex_count; i++) {
+			aabb.expand_to(faces.vertices[i]);
+			write_position(get_target<FLIP>(i), faces.vertices[i]);
+		}
 
 		if (has_normals) {
-			normals.write[set_idx] = face.normal[idx_offset];
+			for (int i = 0; i < vertex_count; i++) {
+				write_normal(get_target<FLIP>(i), faces.normals[i]);
+			}
 		}
 
 		if (has_tangents) {
-			tangents.write[set_idx * 4] = face.tangent[idx_offset][0];
-			tangents.write[set_idx * 4 + 1] = face.tangent[idx_offset][1];
-			tangents.write[set_idx * 4 + 2] = face.tangent[idx_offset][2];
-			tangents.write[set_idx * 4 + 3] = face.tangent[idx_offset][3];
+			for (int i = 0; i < vertex_count; i++) {
+				write_tangent(get_target<FLIP>(i), faces.tangents[i]);
+			}
 		}
 
 		if (has_colors) {
-			colors.write[set_idx] = face.color[idx_offset];
+			for (int i = 0; i < vertex_count; i++) {
+				write_color(get_target<FLIP>(i), faces.colors[i]);
+			}
 		}
 
-		if (has_bones) {
-			bones.write[set_idx * 4] = face.bones[idx_offset][0];
-			bones.write[set_idx * 4 + 1] = face.bones[idx_offset][1];
-			bones.write[set_idx * 4 + 2] = face.bones[idx_offset][2];
-			bones.write[set_idx * 4 + 3] = face.bones[idx_offset][3];
+		if (has_uvs) {
+			for (int i = 0; i < vertex_count; i++) {
+				write_uv(RS::ARRAY_TEX_UV, get_target<FLIP>(i), faces.uvs[i]);
+			}
 		}
 
-		if (has_weights) {
-			weights.write[set_idx * 4] = face.weights[idx_offset][0];
-			weights.write[set_idx * 4 + 1] = face.weights[idx_offset][1];
-			weights.write[set_idx * 4 + 2] = face.weights[idx_offset][2];
-			weights.write[set_idx * 4 + 3] = face.weights[idx_offset][3];
+		if (has_uv2s) {
+			for (int i = 0; i < vertex_count; i++) {
+				write_uv(RS::ARRAY_TEX_UV2, get_target<FLIP>(i), faces.uv2s[i]);
+			}
 		}
 
-		if (has_uvs) {
-			uvs.write[set_idx] = face.uv[idx_offset];
+		if (has_bones) {
+			for (int i = 0; i < vertex_count; i++) {
+				write_bones(get_target<FLIP>(i), i);
+			}
 		}
 
-		if (has_uv2s) {
-			uv2s.write[set_idx] = face.uv2[idx_offset];
+		if (has_weights) {
+			for (int i = 0; i < vertex_count; i++) {
+				write_weights(get_target<FLIP>(i), faces.weights[i]);
+			}
 		}
 	}
 
-	/**
-	 * Adds the vertex information read from the "fill" as a new surface
-	 * of the passed in mesh and sets the passed in material to the new
-	 * surface
-	 */
-	void add_to_mesh(Ref<ArrayMesh> mesh, Ref<Material> material) {
-		ERR_FAIL_COND(mesh.is_null());
-		arrays[Mesh::ARRAY_VERTEX] = vertices;
+	// The encodings below are the ones the RenderingServer uses for uncompressed surfaces
 
-		if (has_normals) {
-			arrays[Mesh::ARRAY_NORMAL] = normals;
+	_FORCE_INLINE_ void write_position(int p_idx, const Vector3 &p_vertex) {
+		float position[3] = { (float)p_vertex.x, (float)p_vertex.y, (float)p_vertex.z };
+		memcpy(&vertex_ptrw[offsets[RS::ARRAY_VERTEX] + p_idx * vertex_stride], position, sizeof(float) * 3);
+	}
+
+	_FORCE_INLINE_ void write_normal(int p_idx, const Vector3 &p_normal) {
+		Vector2 encoded = p_normal.octahedron_encode();
+		uint16_t normal[2] = { encode_unorm16(encoded.x), encode_unorm16(encoded.y) };
+		memcpy(&vertex_ptrw[offsets[RS::ARRAY_NORMAL] + p_idx * normal_stride], normal, 4);
+	}
+
+	_FORCE_INLINE_ void write_tangent(int p_idx, const Vector4 &p_tangent) {
+		Vector2 encoded = Vector3(p_tangent.x, p_tangent.y, p_tangent.z).octahedron_tangent_encode(p_tangent.w);
+		uint16_t tangent[2] = { encode_unorm16(encoded.x), encode_unorm16(encoded.y) };
+		memcpy(&vertex_ptrw[offsets[RS::ARRAY_TANGENT] + p_idx * normal_stride], tangent, 4);
+	}
+
+	_FORCE_INLINE_ void write_color(int p_idx, const Color &p_color) {
+		uint8_t *dst = &attribute_ptrw[offsets[RS::ARRAY_COLOR] + p_idx * attribute_stride];
+		for (int i = 0; i < 4; i++) {
+			dst[i] = CLAMP(int(p_color[i] * 255.0), 0, 255);
 		}
+	}
 
-		if (has_tangents) {
-			arrays[Mesh::ARRAY_TANGENT] = tangents;
+	_FORCE_INLINE_ void write_uv(RS::ArrayType p_type, int p_idx, const Vector2 &p_uv) {
+		float uv[2] = { (float)p_uv.x, (float)p_uv.y };
+		memcpy(&attribute_ptrw[offsets[p_type] + p_idx * attribute_stride], uv, sizeof(float) * 2);
+	}
+
+	_FORCE_INLINE_ void write_bones(int p_idx, int p_lookup_idx) {
+		// Bone indices may have been blended by SlicerFace::sub_face style interpolation,
+		// so round them back to the nearest whole index
+		const Vector4 &bone = faces.bones[p_lookup_idx];
+		uint16_t bones[4];
+		for (int i = 0; i < 4; i++) {
+			bones[i] = (uint16_t)Math::round(bone[i]);
 		}
+		memcpy(&skin_ptrw[offsets[RS::ARRAY_BONES] + p_idx * skin_stride], bones, 8);
 
-		if (has_colors) {
-			arrays[Mesh::ARRAY_COLOR] = colors;
+		if (has_weights) {
+			expand_bone_aabbs(bones, faces.weights[p_lookup_idx], faces.vertices[p_lookup_idx]);
 		}
+	}
 
-		if (has_bones) {
-			arrays[Mesh::ARRAY_BONES] = bones;
+	_FORCE_INLINE_ void write_weights(int p_idx, const Vector4 &p_weights) {
+		uint16_t weights[4];
+		for (int i = 0; i < 4; i++) {
+			weights[i] = encode_unorm16(p_weights[i]);
 		}
+		memcpy(&skin_ptrw[offsets[RS::ARRAY_WEIGHTS] + p_idx * skin_stride], weights, 8);
+	}
 
-		if (has_weights) {
-			arrays[Mesh::ARRAY_WEIGHTS] = weights;
+	static _FORCE_INLINE_ uint16_t encode_unorm16(real_t p_value) {
+		return (uint16_t)CLAMP(p_value * 65535, 0, 65535);
+	}
+
+	/**
+	 * Grows the bounds of every bone that has a say in where the vertex ends up. The engine
+	 * uses these to work out the bounds of the surface once it's skinned
+	 */
+	void expand_bone_aabbs(const uint16_t *p_bones, const Vector4 &p_weights, const Vector3 &p_vertex) {
+		for (int i = 0; i < 4; i++) {
+			if (p_weights[i] < CMP_EPSILON) {
+				continue;
+			}
+
+			int bone = p_bones[i];
+			if (bone >= bone_aabbs.size()) {
+				int previous_size = bone_aabbs.size();
+				bone_aabbs.resize(bone + 1);
+				// A negative size marks bones no vertex has been weighted to yet
+				for (int j = previous_size; j < bone_aabbs.size(); j++) {
+					bone_aabbs.write[j] = AABB(Vector3(), Vector3(-1, -1, -1));
+				}
+			}
+
+			AABB &bone_aabb = bone_aabbs.write[bone];
+			if (bone_aabb.size.x < 0) {
+				bone_aabb = AABB(p_vertex, Vector3());
+			} else {
+				bone_aabb.expand_to(p_vertex);
+			}
 		}
+	}
 
-		if (has_uvs) {
-			arrays[Mesh::ARRAY_TEX_UV] = uvs;
+	/**
+	 * Copies the index array of an indexed face buffer. The vertices themselves still
+	 * need to be filled in one to one. Flipping the winding swaps the last two corners
+	 * of every face, the same as fill_vertices does for non indexed faces
+	 */
+	void fill_indices(bool p_flip_winding = false) {
+		ERR_FAIL_COND(!faces.is_indexed());
+		index_count = faces.indices.size();
+
+		// Surfaces with few enough vertices get their indices stored in 16 bits
+		if (offsets[RS::ARRAY_INDEX] == 2) {
+			write_indices<uint16_t>(p_flip_winding);
+		} else {
+			write_indices<uint32_t>(p_flip_winding);
 		}
+	}
 
-		if (has_uv2s) {
-			arrays[Mesh::ARRAY_TEX_UV2] = uv2s;
+	template <typename T>
+	void write_indices(bool p_flip_winding) {
+		index_data.resize(index_count * sizeof(T));
+		T *indices_ptrw = (T *)index_data.ptrw();
+
+		for (int i = 0; i < index_count; i += 3) {
+			indices_ptrw[i] = faces.indices[i];
+			indices_ptrw[i + 1] = faces.indices[p_flip_winding ? i + 2 : i + 1];
+			indices_ptrw[i + 2] = faces.indices[p_flip_winding ? i + 1 : i + 2];
 		}
+	}
 
-		mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, arrays);
+	/**
+	 * Hands over everything encoded by the "fill", for when the surface gets added to a
+	 * mesh somewhere else than where it was filled (see add_surface_data). The buffers
+	 * are copy on write, so this doesn't copy any of them
+	 */
+	void get_surface_data(RS::SurfaceData &r_surface) const {
+		r_surface.primitive = RS::PRIMITIVE_TRIANGLES;
+		r_surface.format = format;
+		r_surface.vertex_data = vertex_data;
+		r_surface.attribute_data = attribute_data;
+		r_surface.skin_data = skin_data;
+		r_surface.vertex_count = vertex_count;
+		r_surface.index_data = index_data;
+		r_surface.index_count = index_count;
+		r_surface.aabb = aabb;
+		r_surface.bone_aabbs = bone_aabbs;
+	}
+
+	/**
+	 * Adds an encoded surface as a new surface of the passed in mesh and sets
+	 * the passed in material to the new surface
+	 */
+	static void add_surface_data(Ref<ArrayMesh> mesh, const RS::SurfaceData &surface, Ref<Material> material) {
+		ERR_FAIL_COND(mesh.is_null());
+		ERR_FAIL_COND(surface.vertex_count == 0);
+		mesh->add_surface(surface.format, Mesh::PRIMITIVE_TRIANGLES, surface.vertex_data, surface.attribute_data, surface.skin_data, surface.vertex_count, surface.index_data, surface.index_count, surface.aabb, Vector<uint8_t>(), surface.bone_aabbs);
 		mesh->surface_set_material(mesh->get_surface_count() - 1, material);
 	}
 
+	/**
+	 * Adds the vertices encoded by the "fill" as a new surface of the
+	 * passed in mesh and sets the passed in material to the new surface
+	 */
+	void add_to_mesh(Ref<ArrayMesh> mesh, Ref<Material> material) {
+		RS::SurfaceData surface;
+		get_surface_data(surface);
+		add_surface_data(mesh, surface, material);
+	}
+
 	~SurfaceFiller() {
 	}
 };
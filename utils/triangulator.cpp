@@ -30,6 +30,9 @@
 
 #include "triangulator.h"
 
+#include "core/object/worker_thread_pool.h"
+#include "core/templates/hash_map.h"
+
 #include <algorithm>
 #include <limits>
 
@@ -63,32 +66,140 @@ struct Mapped2D {
 	};
 };
 
+/**
+ * Two directions spanning the plane with the passed in normal, used to map points on it into 2D
+ */
+static void get_plane_basis(const Vector3 &p_normal, Vector3 &r_u, Vector3 &r_v) {
+	r_u = p_normal.cross(Vector3(0, 1, 0)).normalized();
+	if (r_u == Vector3(0, 0, 0)) {
+		r_u = p_normal.cross(Vector3(0, 0, -1)).normalized();
+	}
+	r_v = r_u.cross(p_normal);
+}
+
+// Points closer together than this are taken to be the same point of a cross section.
+// The faces on either side of a cut edge come up with the exact same point, this only
+// has to catch seams where a mesh duplicates its vertices with slightly different positions
+static constexpr real_t WELD_DISTANCE = CMP_EPSILON * 10;
+
+/**
+ * Welds points mapped onto a plane that are within WELD_DISTANCE of each other, in
+ * constant time per point. Points are hashed into a grid of cells twice that size, so
+ * anything close enough to weld to is either in the point's own cell or in one of the
+ * three cells around the corner nearest to it
+ */
+struct PointWelder {
+	static constexpr real_t CELL_SIZE = WELD_DISTANCE * 2;
+
+	// The last point added to each cell, with the others chained on from it
+	HashMap<uint64_t, int> cells;
+	LocalVector<int> next_in_cell;
+	LocalVector<Vector2> points;
+
+	static _FORCE_INLINE_ uint64_t get_key(int64_t p_x, int64_t p_y) {
+		return ((uint64_t)(uint32_t)p_x << 32) | (uint64_t)(uint32_t)p_y;
+	}
+
+	/**
+	 * Returns the index of the point the passed in one got welded to, which is a new one
+	 * when r_added comes back true
+	 */
+	int weld(const Vector2 &p_point, bool &r_added) {
+		real_t x = p_point.x / CELL_SIZE;
+		real_t y = p_point.y / CELL_SIZE;
+		int64_t cell_x = (int64_t)Math::floor(x);
+		int64_t cell_y = (int64_t)Math::floor(y);
+		int64_t near_x = x - cell_x < 0.5 ? cell_x - 1 : cell_x + 1;
+		int64_t near_y = y - cell_y < 0.5 ? cell_y - 1 : cell_y + 1;
+
+		uint64_t keys[4] = { get_key(cell_x, cell_y), get_key(near_x, cell_y), get_key(cell_x, near_y), get_key(near_x, near_y) };
+		for (int i = 0; i < 4; i++) {
+			const int *head = cells.getptr(keys[i]);
+			for (int j = head ? *head : -1; j != -1; j = next_in_cell[j]) {
+				if (points[j].distance_squared_to(p_point) <= WELD_DISTANCE * WELD_DISTANCE) {
+					r_added = false;
+					return j;
+				}
+			}
+		}
+
+		int idx = points.size();
+		int *head = cells.getptr(keys[0]);
+		next_in_cell.push_back(head ? *head : -1);
+		points.push_back(p_point);
+		cells[keys[0]] = idx;
+		r_added = true;
+		return idx;
+	}
+};
+
+/**
+ * Drops every mapped point that welds to one before it, keeping the order of the rest.
+ * Returns how many were dropped
+ */
+static int compact_mapped(Vector<Mapped2D> &r_mapped) {
+	PointWelder welder;
+	Mapped2D *mapped_ptrw = r_mapped.ptrw();
+	int kept = 0;
+	for (int i = 0; i < r_mapped.size(); i++) {
+		bool added;
+		welder.weld(mapped_ptrw[i].mapped, added);
+		if (added) {
+			mapped_ptrw[kept++] = mapped_ptrw[i];
+		}
+	}
+
+	int removed = r_mapped.size() - kept;
+	r_mapped.resize(kept);
+	return removed;
+}
+
 namespace Triangulator {
 real_t tri_area_2d(real_t x1, real_t y1, real_t x2, real_t y2, real_t x3, real_t y3) {
 	return (x1 - x2) * (y2 - y3) - (x2 - x3) * (y1 - y2);
 }
 
+int compact_points(Vector<Vector3> &r_points, Vector3 plane_normal) {
+	Vector3 u;
+	Vector3 v;
+	get_plane_basis(plane_normal, u, v);
+
+	Vector<Mapped2D> mapped;
+	mapped.resize(r_points.size());
+	for (int i = 0; i < r_points.size(); i++) {
+		mapped.set(i, Mapped2D(r_points[i], u, v));
+	}
+
+	int removed = compact_mapped(mapped);
+	if (removed > 0) {
+		r_points.resize(mapped.size());
+		for (int i = 0; i < mapped.size(); i++) {
+			r_points.write[i] = mapped[i].original;
+		}
+	}
+	return removed;
+}
+
 // Godot has a QuickHull function (along with VHACD bindings which I'm sure has all kind of crazy smart stuff in it)
 // But as this is primarily a learning exercise (and because monotone chain has a slightly different time complexity
 // and our need to support uv mappings and such) let's try to implement this ourselves (or, more accurately, copy
 // it over from Ezy-Slice)
-Vector<SlicerFace> monotone_chain(const Vector<Vector3> &interception_points, Vector3 plane_normal) {
+FaceBuffer monotone_chain(const Vector<Vector3> &interception_points, Vector3 plane_normal, bool p_indexed) {
 	// We'll be using the monotone_chain algorithm to try to get a convex hull from our assortment of
 	// interception_points along our plane
 
 	int count = interception_points.size();
-	Vector<SlicerFace> result;
+	FaceBuffer result;
+	result.set_format(FaceBuffer::ATTRIBUTE_NORMAL | FaceBuffer::ATTRIBUTE_TANGENT | FaceBuffer::ATTRIBUTE_UV | (p_indexed ? FaceBuffer::ATTRIBUTE_INDEX : 0));
 
 	if (count < 3) {
 		return result;
 	}
 
 	// First we map from 3D points into a 2D plane represented by the normal we used to cut our mesh
-	Vector3 u = plane_normal.cross(Vector3(0, 1, 0)).normalized();
-	if (u == Vector3(0, 0, 0)) {
-		u = plane_normal.cross(Vector3(0, 0, -1)).normalized();
-	}
-	Vector3 v = u.cross(plane_normal);
+	Vector3 u;
+	Vector3 v;
+	get_plane_basis(plane_normal, u, v);
 
 	// Generate an array of mapped values
 	Vector<Mapped2D> mapped;
@@ -115,6 +226,13 @@ Vector<SlicerFace> monotone_chain(const Vector<Vector3> &interception_points, Ve
 		mapped.set(i, new_mapped_value);
 	}
 
+	// Points along the cut tend to come in at least twice, once for each face sharing the
+	// edge they were cut from. Collapsing them first leaves the sort and the hull less to do
+	count -= compact_mapped(mapped);
+	if (count < 3) {
+		return result;
+	}
+
 	// Sort our newly generated array values
 	mapped.sort_custom<Mapped2D::Comparator>();
 
@@ -173,6 +291,29 @@ Vector<SlicerFace> monotone_chain(const Vector<Vector3> &interception_points, Ve
 	float width = max_div_x - min_div_x;
 	float height = max_div_y - min_div_y;
 
+	if (p_indexed) {
+		// Every hull point becomes a single vertex and the faces fan out from the first one
+		result.resize_vertices(vert_count);
+		for (int i = 0; i < vert_count; i++) {
+			Vector2 uv = hulls[i].mapped;
+			uv.x = (uv.x - min_div_x) / width;
+			uv.y = (uv.y - min_div_y) / height;
+
+			result.vertices[i] = hulls[i].original;
+			result.uvs[i] = uv;
+			result.normals[i] = plane_normal;
+		}
+
+		for (int i = 0; i < tri_count; i += 3) {
+			result.indices[i] = 0;
+			result.indices[i + 1] = i / 3 + 1;
+			result.indices[i + 2] = i / 3 + 2;
+			result.compute_tangents(i / 3);
+		}
+
+		return result;
+	}
+
 	int index_count = 1;
 
 	// Generate both the vertices and uv's in this loop
@@ -196,21 +337,659 @@ Vector<SlicerFace> monotone_chain(const Vector<Vector3> &interception_points, Ve
 		uv_c.x = (uv_c.x - min_div_x) / width;
 		uv_c.y = (uv_c.y - min_div_y) / height;
 
-		SlicerFace new_face = SlicerFace(pos_a.original, pos_b.original, pos_c.original);
+		result.vertices[i] = pos_a.original;
+		result.vertices[i + 1] = pos_b.original;
+		result.vertices[i + 2] = pos_c.original;
 
 		// TODO - Ezy-Slice support the ability to map these uv values to a specific region
 		// of the texture for atlasing.
-		new_face.set_uvs(uv_a, uv_b, uv_c);
+		result.uvs[i] = uv_a;
+		result.uvs[i + 1] = uv_b;
+		result.uvs[i + 2] = uv_c;
 
 		// The normals is the same for all vertices since the final mesh is completely flat
-		new_face.set_normals(plane_normal, plane_normal, plane_normal);
-		new_face.compute_tangents();
-
-		result.write[i / 3] = new_face;
+		result.normals[i] = plane_normal;
+		result.normals[i + 1] = plane_normal;
+		result.normals[i + 2] = plane_normal;
+		result.compute_tangents(i / 3);
 
 		index_count++;
 	}
 
 	return result;
 }
+
+// Anything with less area than this, whether it's a loop or a triangle, is dropped
+static constexpr real_t DEGENERATE_AREA = CMP_EPSILON * CMP_EPSILON;
+
+// Islands only get spread over the WorkerThreadPool when there are enough of them, with
+// enough points between them, to make up for handing them out
+static constexpr int PARALLEL_MIN_ISLANDS = 4;
+static constexpr int PARALLEL_MIN_POINTS = 1024;
+
+/**
+ * Twice the signed area of the triangle, positive when it winds counterclockwise
+ */
+static _FORCE_INLINE_ real_t cross_2d(const Vector2 &a, const Vector2 &b, const Vector2 &c) {
+	return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+static _FORCE_INLINE_ bool is_point_in_triangle(const Vector2 &p, const Vector2 &a, const Vector2 &b, const Vector2 &c) {
+	return cross_2d(a, b, p) >= 0 && cross_2d(b, c, p) >= 0 && cross_2d(c, a, p) >= 0;
+}
+
+struct CapLoop {
+	LocalVector<int> points;
+	real_t area = 0;
+	Vector2 min;
+	Vector2 max;
+	int parent = -1;
+	int depth = 0;
+};
+
+struct CapIsland {
+	int outer = -1;
+	LocalVector<int> holes;
+	// Three point indices for each triangle of the island
+	LocalVector<int> triangles;
+};
+
+/**
+ * Links the cut segments back up into the loops making up the outline of the cross
+ * section, in time linear in the number of segments. Each point gets welded with the
+ * others at the same spot through a hash of its position (see PointWelder), which is all
+ * it takes to find the segments meeting at it. Repeated segments get merged as described
+ * in triangulate_segments
+ */
+static void link_segments(const Vector<Vector3> &p_segments, const Vector3 &u, const Vector3 &v, LocalVector<Vector3> &r_points, LocalVector<Vector2> &r_mapped, LocalVector<CapLoop> &r_loops, int &r_welded) {
+	int segment_count = p_segments.size() / 2;
+	LocalVector<int> ends;
+	ends.resize(segment_count * 2);
+
+	PointWelder welder;
+	r_welded = 0;
+	for (int i = 0; i < segment_count * 2; i++) {
+		const Vector3 &point = p_segments[i];
+		bool added;
+		ends[i] = welder.weld(Vector2(point.dot(u), point.dot(v)), added);
+		if (added) {
+			r_points.push_back(point);
+		} else {
+			r_welded++;
+		}
+	}
+	r_mapped = welder.points;
+
+	// Segments are used up once they're part of a loop. Ones collapsed down to a single
+	// point and repeats never get used at all
+	LocalVector<uint8_t> used;
+	used.resize(segment_count);
+	HashMap<uint64_t, int> traced;
+	for (int i = 0; i < segment_count; i++) {
+		int from = ends[i * 2];
+		int to = ends[i * 2 + 1];
+		used[i] = from == to;
+		if (used[i]) {
+			continue;
+		}
+
+		uint64_t key = ((uint64_t)MIN(from, to) << 32) | (uint64_t)MAX(from, to);
+		int *existing = traced.getptr(key);
+		if (!existing) {
+			traced.insert(key, i);
+			continue;
+		}
+
+		used[i] = 1;
+		if (ends[*existing * 2] != from) {
+			used[*existing] = 1;
+			traced.erase(key);
+		}
+	}
+
+	// Segments meeting at each point, laid out back to back
+	int point_count = r_points.size();
+	LocalVector<int> adjacency_start;
+	LocalVector<int> adjacency;
+	adjacency_start.resize(point_count + 1);
+	for (int i = 0; i <= point_count; i++) {
+		adjacency_start[i] = 0;
+	}
+	for (int i = 0; i < segment_count; i++) {
+		if (!used[i]) {
+			adjacency_start[ends[i * 2] + 1]++;
+			adjacency_start[ends[i * 2 + 1] + 1]++;
+		}
+	}
+	for (int i = 0; i < point_count; i++) {
+		adjacency_start[i + 1] += adjacency_start[i];
+	}
+
+	LocalVector<int> fill;
+	fill.resize(point_count);
+	for (int i = 0; i < point_count; i++) {
+		fill[i] = adjacency_start[i];
+	}
+	adjacency.resize(adjacency_start[point_count]);
+	for (int i = 0; i < segment_count; i++) {
+		if (!used[i]) {
+			adjacency[fill[ends[i * 2]]++] = i;
+			adjacency[fill[ends[i * 2 + 1]]++] = i;
+		}
+	}
+
+	auto walk = [&](int p_start, int p_segment, LocalVector<int> &r_chain) {
+		r_chain.push_back(p_start);
+		int current = p_start;
+		int segment = p_segment;
+		while (segment != -1) {
+			used[segment] = 1;
+			current = ends[segment * 2] == current ? ends[segment * 2 + 1] : ends[segment * 2];
+			if (current == p_start) {
+				return true;
+			}
+			r_chain.push_back(current);
+
+			segment = -1;
+			for (int i = adjacency_start[current]; i < adjacency_start[current + 1]; i++) {
+				if (!used[adjacency[i]]) {
+					segment = adjacency[i];
+					break;
+				}
+			}
+		}
+		return false;
+	};
+
+	// Points with an odd number of segments are the ends of chains that didn't close up,
+	// which get walked first so that each comes out in one piece. Everything left over
+	// after that is a closed loop
+	LocalVector<LocalVector<int>> open_chains;
+	for (int pass = 0; pass < 2; pass++) {
+		for (int i = 0; i < point_count; i++) {
+			int degree = adjacency_start[i + 1] - adjacency_start[i];
+			if (pass == 0 && degree % 2 == 0) {
+				continue;
+			}
+
+			for (int j = adjacency_start[i]; j < adjacency_start[i + 1]; j++) {
+				if (used[adjacency[j]]) {
+					continue;
+				}
+
+				LocalVector<int> chain;
+				if (walk(i, adjacency[j], chain)) {
+					CapLoop loop;
+					loop.points = chain;
+					r_loops.push_back(loop);
+				} else {
+					open_chains.push_back(chain);
+				}
+			}
+		}
+	}
+
+	// Whatever didn't close up is down to a gap the welding missed, or to a mesh that
+	// wasn't closed in the first place. Chains get joined end to end with whichever open
+	// end is closest until they come back around to their own start
+	while (open_chains.size() > 0) {
+		LocalVector<int> chain = open_chains[open_chains.size() - 1];
+		open_chains.resize(open_chains.size() - 1);
+
+		while (true) {
+			Vector2 end = r_mapped[chain[chain.size() - 1]];
+			real_t best_distance = end.distance_squared_to(r_mapped[chain[0]]);
+			int best = -1;
+			bool best_reversed = false;
+			for (uint32_t i = 0; i < open_chains.size(); i++) {
+				real_t to_start = end.distance_squared_to(r_mapped[open_chains[i][0]]);
+				real_t to_end = end.distance_squared_to(r_mapped[open_chains[i][open_chains[i].size() - 1]]);
+				if (to_start < best_distance) {
+					best_distance = to_start;
+					best = i;
+					best_reversed = false;
+				}
+				if (to_end < best_distance) {
+					best_distance = to_end;
+					best = i;
+					best_reversed = true;
+				}
+			}
+
+			if (best == -1) {
+				break;
+			}
+
+			const LocalVector<int> &next = open_chains[best];
+			for (uint32_t i = 0; i < next.size(); i++) {
+				chain.push_back(next[best_reversed ? next.size() - 1 - i : i]);
+			}
+			open_chains.remove_at_unordered(best);
+		}
+
+		CapLoop loop;
+		loop.points = chain;
+		r_loops.push_back(loop);
+	}
+}
+
+/**
+ * Works out which loops are holes in which by even-odd nesting: a loop inside an even
+ * number of others is the outline of an island, one inside an odd number is a hole in
+ * the smallest loop around it. Islands come out wound counterclockwise and their holes
+ * clockwise, whichever way the faces around them were wound
+ */
+static void nest_loops(const LocalVector<Vector2> &p_mapped, LocalVector<CapLoop> &r_loops, LocalVector<CapIsland> &r_islands) {
+	LocalVector<int> order;
+	for (uint32_t i = 0; i < r_loops.size(); i++) {
+		CapLoop &loop = r_loops[i];
+		if (loop.points.size() < 3) {
+			continue;
+		}
+
+		loop.min = p_mapped[loop.points[0]];
+		loop.max = loop.min;
+		loop.area = 0;
+		for (uint32_t j = 0; j < loop.points.size(); j++) {
+			const Vector2 &a = p_mapped[loop.points[j]];
+			const Vector2 &b = p_mapped[loop.points[(j + 1) % loop.points.size()]];
+			loop.area += a.x * b.y - b.x * a.y;
+			loop.min = loop.min.min(a);
+			loop.max = loop.max.max(a);
+		}
+		loop.area *= 0.5;
+
+		if (Math::abs(loop.area) > DEGENERATE_AREA) {
+			order.push_back(i);
+		}
+	}
+
+	// Largest first, so every loop that could contain another one comes before it
+	std::stable_sort(order.ptr(), order.ptr() + order.size(), [&](int a, int b) {
+		return Math::abs(r_loops[a].area) > Math::abs(r_loops[b].area);
+	});
+
+	for (uint32_t i = 0; i < order.size(); i++) {
+		CapLoop &loop = r_loops[order[i]];
+		const Vector2 &point = p_mapped[loop.points[0]];
+		for (uint32_t j = 0; j < i; j++) {
+			const CapLoop &other = r_loops[order[j]];
+			if (point.x < other.min.x || point.x > other.max.x || point.y < other.min.y || point.y > other.max.y) {
+				continue;
+			}
+
+			bool inside = false;
+			for (uint32_t k = 0, l = other.points.size() - 1; k < other.points.size(); l = k++) {
+				const Vector2 &a = p_mapped[other.points[k]];
+				const Vector2 &b = p_mapped[other.points[l]];
+				if ((a.y > point.y) != (b.y > point.y) && point.x < (b.x - a.x) * (point.y - a.y) / (b.y - a.y) + a.x) {
+					inside = !inside;
+				}
+			}
+
+			if (inside) {
+				loop.depth++;
+				loop.parent = order[j];
+			}
+		}
+
+		bool is_hole = loop.depth % 2 == 1;
+		if ((loop.area > 0) == is_hole) {
+			loop.points.invert();
+			loop.area = -loop.area;
+		}
+
+		if (!is_hole) {
+			CapIsland island;
+			island.outer = order[i];
+			r_islands.push_back(island);
+		}
+	}
+
+	for (uint32_t i = 0; i < r_islands.size(); i++) {
+		r_loops[r_islands[i].outer].parent = i;
+	}
+	for (uint32_t i = 0; i < order.size(); i++) {
+		const CapLoop &loop = r_loops[order[i]];
+		if (loop.depth % 2 == 1) {
+			r_islands[r_loops[loop.parent].parent].holes.push_back(order[i]);
+		}
+	}
+}
+
+/**
+ * Cuts each hole into the outline around it along a bridge to a vertex it can see,
+ * leaving a single polygon which winds around the island and back out of every hole
+ */
+static void bridge_holes(const LocalVector<Vector2> &p_mapped, const LocalVector<CapLoop> &p_loops, const CapIsland &p_island, LocalVector<int> &r_polygon) {
+	r_polygon = p_loops[p_island.outer].points;
+
+	// Holes furthest along x go first, so the ray cast from each hole only ever has to
+	// find the outline and the holes bridged into it so far
+	LocalVector<int> holes = p_island.holes;
+	LocalVector<int> rightmost;
+	for (uint32_t i = 0; i < holes.size(); i++) {
+		const LocalVector<int> &points = p_loops[holes[i]].points;
+		int best = 0;
+		for (uint32_t j = 1; j < points.size(); j++) {
+			if (p_mapped[points[j]].x > p_mapped[points[best]].x) {
+				best = j;
+			}
+		}
+		rightmost.push_back(best);
+	}
+
+	LocalVector<int> hole_order;
+	for (uint32_t i = 0; i < holes.size(); i++) {
+		hole_order.push_back(i);
+	}
+	std::stable_sort(hole_order.ptr(), hole_order.ptr() + hole_order.size(), [&](int a, int b) {
+		return p_mapped[p_loops[holes[a]].points[rightmost[a]]].x > p_mapped[p_loops[holes[b]].points[rightmost[b]]].x;
+	});
+
+	for (uint32_t h = 0; h < hole_order.size(); h++) {
+		const LocalVector<int> &hole = p_loops[holes[hole_order[h]]].points;
+		int start = rightmost[hole_order[h]];
+		Vector2 m = p_mapped[hole[start]];
+
+		// The closest edge straight along +x from the hole's rightmost point
+		int count = r_polygon.size();
+		int edge = -1;
+		real_t hit_x = 0;
+		for (int i = 0; i < count; i++) {
+			const Vector2 &a = p_mapped[r_polygon[i]];
+			const Vector2 &b = p_mapped[r_polygon[(i + 1) % count]];
+			if ((a.y > m.y) == (b.y > m.y)) {
+				continue;
+			}
+
+			real_t x = a.x + (m.y - a.y) * (b.x - a.x) / (b.y - a.y);
+			if (x >= m.x && (edge == -1 || x < hit_x)) {
+				edge = i;
+				hit_x = x;
+			}
+		}
+
+		if (edge == -1) {
+			continue;
+		}
+
+		// The edge's end furthest along x can usually be seen from the hole, unless a
+		// reflex vertex pokes into the triangle between them. In that case the one of
+		// those closest in angle to the ray is used instead
+		Vector2 hit(hit_x, m.y);
+		int bridge = p_mapped[r_polygon[edge]].x > p_mapped[r_polygon[(edge + 1) % count]].x ? edge : (edge + 1) % count;
+		Vector2 target = p_mapped[r_polygon[bridge]];
+		real_t best_slope = -1;
+		for (int i = 0; i < count; i++) {
+			const Vector2 &p = p_mapped[r_polygon[i]];
+			if (i == bridge || p == target) {
+				continue;
+			}
+
+			const Vector2 &prev = p_mapped[r_polygon[(i + count - 1) % count]];
+			const Vector2 &next = p_mapped[r_polygon[(i + 1) % count]];
+			if (cross_2d(prev, p, next) >= 0) {
+				continue;
+			}
+
+			bool inside = target.y < m.y ? is_point_in_triangle(p, m, target, hit) : is_point_in_triangle(p, m, hit, target);
+			if (!inside) {
+				continue;
+			}
+
+			real_t slope = (p.x - m.x) / (Math::abs(p.y - m.y) + (p.x - m.x));
+			if (slope > best_slope) {
+				best_slope = slope;
+				bridge = i;
+			}
+		}
+
+		LocalVector<int> bridged;
+		bridged.reserve(count + hole.size() + 2);
+		for (int i = 0; i <= bridge; i++) {
+			bridged.push_back(r_polygon[i]);
+		}
+		for (uint32_t i = 0; i <= hole.size(); i++) {
+			bridged.push_back(hole[(start + i) % hole.size()]);
+		}
+		for (int i = bridge; i < count; i++) {
+			bridged.push_back(r_polygon[i]);
+		}
+		r_polygon = bridged;
+	}
+}
+
+/**
+ * Ear clips a counterclockwise polygon. Only reflex vertices can ever end up inside an ear,
+ * so those are the only ones checked, which keeps mostly convex outlines close to linear
+ */
+static void clip_ears(const LocalVector<Vector2> &p_mapped, const LocalVector<int> &p_polygon, LocalVector<int> &r_triangles) {
+	int count = p_polygon.size();
+	if (count < 3) {
+		return;
+	}
+
+	LocalVector<int> prev;
+	LocalVector<int> next;
+	LocalVector<uint8_t> reflex;
+	LocalVector<uint8_t> removed;
+	LocalVector<int> reflex_points;
+	prev.resize(count);
+	next.resize(count);
+	reflex.resize(count);
+	removed.resize(count);
+
+	auto point = [&](int i) -> const Vector2 & {
+		return p_mapped[p_polygon[i]];
+	};
+
+	auto update_reflex = [&](int i) {
+		bool is_reflex = cross_2d(point(prev[i]), point(i), point(next[i])) <= 0;
+		if (is_reflex && !reflex[i]) {
+			reflex_points.push_back(i);
+		}
+		reflex[i] = is_reflex;
+	};
+
+	for (int i = 0; i < count; i++) {
+		prev[i] = (i + count - 1) % count;
+		next[i] = (i + 1) % count;
+		reflex[i] = 0;
+		removed[i] = 0;
+	}
+	for (int i = 0; i < count; i++) {
+		update_reflex(i);
+	}
+
+	auto is_ear = [&](int i) {
+		const Vector2 &a = point(prev[i]);
+		const Vector2 &b = point(i);
+		const Vector2 &c = point(next[i]);
+		for (uint32_t j = 0; j < reflex_points.size(); j++) {
+			int r = reflex_points[j];
+			if (removed[r] || !reflex[r] || r == prev[i] || r == i || r == next[i]) {
+				continue;
+			}
+
+			// Bridged holes leave the same point in the polygon twice
+			const Vector2 &p = point(r);
+			if (p == a || p == b || p == c) {
+				continue;
+			}
+
+			if (is_point_in_triangle(p, a, b, c)) {
+				return false;
+			}
+		}
+		return true;
+	};
+
+	auto remove = [&](int i) {
+		removed[i] = 1;
+		next[prev[i]] = next[i];
+		prev[next[i]] = prev[i];
+		update_reflex(prev[i]);
+		update_reflex(next[i]);
+	};
+
+	int remaining = count;
+	int current = 0;
+	int stalled = 0;
+	while (remaining > 3) {
+		int a = prev[current];
+		int c = next[current];
+		real_t area = cross_2d(point(a), point(current), point(c));
+
+		// Collinear points and the spikes left by bridges don't add any area, they only
+		// need to be taken out of the way. If nothing looks like an ear all the way around,
+		// the polygon is too far gone numerically and the current point is clipped anyway
+		bool degenerate = Math::abs(area) <= DEGENERATE_AREA;
+		if (degenerate || (area > 0 && is_ear(current)) || stalled > remaining) {
+			if (!degenerate) {
+				r_triangles.push_back(p_polygon[a]);
+				r_triangles.push_back(p_polygon[current]);
+				r_triangles.push_back(p_polygon[c]);
+			}
+			remove(current);
+			remaining--;
+			current = c;
+			stalled = 0;
+			continue;
+		}
+
+		current = c;
+		stalled++;
+	}
+
+	int a = prev[current];
+	int c = next[current];
+	if (cross_2d(point(a), point(current), point(c)) > DEGENERATE_AREA) {
+		r_triangles.push_back(p_polygon[a]);
+		r_triangles.push_back(p_polygon[current]);
+		r_triangles.push_back(p_polygon[c]);
+	}
+}
+
+struct CapTriangulation {
+	const LocalVector<Vector2> *mapped = nullptr;
+	const LocalVector<CapLoop> *loops = nullptr;
+	LocalVector<CapIsland> *islands = nullptr;
+
+	void triangulate_island(uint32_t p_index, void *p_userdata) {
+		CapIsland &island = (*islands)[p_index];
+		LocalVector<int> polygon;
+		bridge_holes(*mapped, *loops, island, polygon);
+		clip_ears(*mapped, polygon, island.triangles);
+	}
+};
+
+FaceBuffer triangulate_segments(const Vector<Vector3> &cut_segments, Vector3 plane_normal, bool p_indexed, int *r_welded) {
+	if (r_welded) {
+		*r_welded = 0;
+	}
+
+	FaceBuffer result;
+	result.set_format(FaceBuffer::ATTRIBUTE_NORMAL | FaceBuffer::ATTRIBUTE_TANGENT | FaceBuffer::ATTRIBUTE_UV | (p_indexed ? FaceBuffer::ATTRIBUTE_INDEX : 0));
+	ERR_FAIL_COND_V(cut_segments.size() % 2 != 0, result);
+	if (cut_segments.size() < 6) {
+		return result;
+	}
+
+	Vector3 u;
+	Vector3 v;
+	get_plane_basis(plane_normal, u, v);
+
+	LocalVector<Vector3> points;
+	LocalVector<Vector2> mapped;
+	LocalVector<CapLoop> loops;
+	int welded;
+	link_segments(cut_segments, u, v, points, mapped, loops, welded);
+	if (r_welded) {
+		*r_welded = welded;
+	}
+
+	LocalVector<CapIsland> islands;
+	nest_loops(mapped, loops, islands);
+	if (islands.size() == 0) {
+		return result;
+	}
+
+	CapTriangulation triangulation;
+	triangulation.mapped = &mapped;
+	triangulation.loops = &loops;
+	triangulation.islands = &islands;
+	if ((int)islands.size() >= PARALLEL_MIN_ISLANDS && (int)points.size() >= PARALLEL_MIN_POINTS) {
+		WorkerThreadPool::GroupID group_id = WorkerThreadPool::get_singleton()->add_template_group_task(&triangulation, &CapTriangulation::triangulate_island, (void *)nullptr, islands.size(), -1, true, "Slicer cross section");
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_id);
+	} else {
+		for (uint32_t i = 0; i < islands.size(); i++) {
+			triangulation.triangulate_island(i, nullptr);
+		}
+	}
+
+	// Same UV mapping as monotone_chain, spread over the bounds of the whole cross section
+	Vector2 min = mapped[0];
+	Vector2 max = mapped[0];
+	for (uint32_t i = 1; i < mapped.size(); i++) {
+		min = min.min(mapped[i]);
+		max = max.max(mapped[i]);
+	}
+	Vector2 size = max - min;
+	size.x = size.x > 0 ? size.x : 1;
+	size.y = size.y > 0 ? size.y : 1;
+
+	// Islands are added in the order they were found in, so the result doesn't depend
+	// on how they got spread across threads
+	int index_count = 0;
+	for (uint32_t i = 0; i < islands.size(); i++) {
+		index_count += islands[i].triangles.size();
+	}
+	result.resize(index_count / 3);
+
+	if (p_indexed) {
+		LocalVector<int> remap;
+		remap.resize(points.size());
+		for (uint32_t i = 0; i < remap.size(); i++) {
+			remap[i] = -1;
+		}
+
+		int vertex_count = 0;
+		int idx = 0;
+		for (uint32_t i = 0; i < islands.size(); i++) {
+			for (uint32_t j = 0; j < islands[i].triangles.size(); j++) {
+				int point = islands[i].triangles[j];
+				if (remap[point] == -1) {
+					remap[point] = vertex_count++;
+				}
+				result.indices[idx++] = remap[point];
+			}
+		}
+
+		result.resize_vertices(vertex_count);
+		for (uint32_t i = 0; i < remap.size(); i++) {
+			if (remap[i] != -1) {
+				result.vertices[remap[i]] = points[i];
+				result.uvs[remap[i]] = (mapped[i] - min) / size;
+				result.normals[remap[i]] = plane_normal;
+			}
+		}
+	} else {
+		int idx = 0;
+		for (uint32_t i = 0; i < islands.size(); i++) {
+			for (uint32_t j = 0; j < islands[i].triangles.size(); j++) {
+				int point = islands[i].triangles[j];
+				result.vertices[idx] = points[point];
+				result.uvs[idx] = (mapped[point] - min) / size;
+				result.normals[idx] = plane_normal;
+				idx++;
+			}
+		}
+	}
+
+	for (int i = 0; i < result.size(); i++) {
+		result.compute_tangents(i);
+	}
+	return result;
+}
 } //namespace Triangulator
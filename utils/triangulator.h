@@ -31,7 +31,7 @@
 #ifndef TRIANGULATOR_H
 #define TRIANGULATOR_H
 
-#include "slicer_face.h"
+#include "face_buffer.h"
 
 /**
  * Contains functions related to performing generative
@@ -44,9 +44,35 @@ namespace Triangulator {
 real_t tri_area_2d(real_t x1, real_t y1, real_t x2, real_t y2, real_t x3, real_t y3);
 
 /**
- * Uses a monotone chain algorithm to generate the faces of a convex hull from a set of points
+ * Collapses points lying on the plane with the passed in normal that are close enough to be
+ * the same point, keeping the first of each in its original order. Returns how many points
+ * were removed
  */
-Vector<SlicerFace> monotone_chain(const Vector<Vector3> &interception_points, Vector3 plane_normal);
+int compact_points(Vector<Vector3> &r_points, Vector3 plane_normal);
+
+/**
+ * Uses a monotone chain algorithm to generate the faces of a convex hull from a set of points.
+ * When p_indexed is set each hull point is only emitted once and shared by the faces using it.
+ * Coincident points are collapsed before the hull is built, see compact_points
+ */
+FaceBuffer monotone_chain(const Vector<Vector3> &interception_points, Vector3 plane_normal, bool p_indexed = false);
+
+/**
+ * Builds the faces of a cross section out of the segments a plane cut across the faces of
+ * a mesh, see SplitResult::cut_segments. The segments are linked back up into the loops
+ * of the section's outline, which can be concave, have holes and make up any number of
+ * separate islands. Islands are triangulated on their own, across the WorkerThreadPool
+ * when there are a lot of them.
+ *
+ * Edges lying on the plane can be traced more than once, by the faces lying flat on it and
+ * by the faces below it, see Intersector. A segment repeated the same way round is only
+ * kept the once, while two going opposite ways round cancel each other out.
+ *
+ * Segment ends at the same spot get collapsed into a single point, the same way
+ * compact_points collapses them. When r_welded is passed in it's set to how many of the
+ * ends were collapsed onto a point before them
+ */
+FaceBuffer triangulate_segments(const Vector<Vector3> &cut_segments, Vector3 plane_normal, bool p_indexed = false, int *r_welded = nullptr);
 } //namespace Triangulator
 
 #endif // TRIANGULATOR_H
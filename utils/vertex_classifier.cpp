@@ -0,0 +1,143 @@
+/**************************************************************************/
+/*  vertex_classifier.cpp                                                 */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "vertex_classifier.h"
+
+#include <string.h>
+
+#if !defined(REAL_T_IS_DOUBLE) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define VERTEX_CLASSIFIER_SSE2
+#include <emmintrin.h>
+#elif !defined(REAL_T_IS_DOUBLE) && (defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64))
+#define VERTEX_CLASSIFIER_NEON
+#include <arm_neon.h>
+#endif
+
+using Intersector::SideOfPlane;
+
+// The vectorized paths build side codes arithmetically out of comparison masks, which
+// relies on both of these
+static_assert(SideOfPlane::OVER == 0 && SideOfPlane::UNDER == 1 && SideOfPlane::ON == 2, "VertexClassifier expects OVER, UNDER and ON to be 0, 1 and 2");
+static_assert(sizeof(SideOfPlane) == 1, "VertexClassifier writes side codes as bytes");
+
+namespace VertexClassifier {
+void classify_scalar(const Plane &plane, const Vector3 *p_vertices, int p_count, real_t *r_distances, SideOfPlane *r_sides) {
+	for (int i = 0; i < p_count; i++) {
+		real_t dist = plane.distance_to(p_vertices[i]);
+		r_distances[i] = dist;
+		r_sides[i] = Intersector::get_side_of_distance(dist);
+	}
+}
+
+#if defined(VERTEX_CLASSIFIER_SSE2)
+void classify(const Plane &plane, const Vector3 *p_vertices, int p_count, real_t *r_distances, SideOfPlane *r_sides) {
+	static_assert(sizeof(Vector3) == sizeof(float) * 3, "Vector3 is expected to be tightly packed");
+	const float *src = reinterpret_cast<const float *>(p_vertices);
+
+	// Four tightly packed vertices span exactly three registers, so rather than shuffling
+	// the positions apart we line the normal up against them in the same repeating order
+	const __m128 n0 = _mm_setr_ps(plane.normal.x, plane.normal.y, plane.normal.z, plane.normal.x);
+	const __m128 n1 = _mm_setr_ps(plane.normal.y, plane.normal.z, plane.normal.x, plane.normal.y);
+	const __m128 n2 = _mm_setr_ps(plane.normal.z, plane.normal.x, plane.normal.y, plane.normal.z);
+	const __m128 d = _mm_set1_ps(plane.d);
+	const __m128 over_epsilon = _mm_set1_ps(CMP_EPSILON);
+	const __m128 under_epsilon = _mm_set1_ps(-CMP_EPSILON);
+	const __m128i on_code = _mm_set1_epi32(SideOfPlane::ON);
+	const __m128i over_offset = _mm_set1_epi32(SideOfPlane::OVER - SideOfPlane::ON);
+
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		// p0 = x0 y0 z0 x1, p1 = y1 z1 x2 y2, p2 = z2 x3 y3 z3, each already multiplied
+		// by the matching component of the normal
+		__m128 p0 = _mm_mul_ps(_mm_loadu_ps(src + i * 3), n0);
+		__m128 p1 = _mm_mul_ps(_mm_loadu_ps(src + i * 3 + 4), n1);
+		__m128 p2 = _mm_mul_ps(_mm_loadu_ps(src + i * 3 + 8), n2);
+
+		// Regroup the products into one register per component so the dot products of
+		// all four vertices can be summed at once
+		__m128 x = _mm_shuffle_ps(p0, _mm_shuffle_ps(p1, p2, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+		__m128 y = _mm_shuffle_ps(_mm_shuffle_ps(p0, p1, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(p1, p2, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+		__m128 z = _mm_shuffle_ps(_mm_shuffle_ps(p0, p1, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(p2, p2, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+		__m128 dist = _mm_sub_ps(_mm_add_ps(_mm_add_ps(x, y), z), d);
+		_mm_storeu_ps(r_distances + i, dist);
+
+		// Start everyone off as ON and knock the codes down from there. The masks are
+		// all ones where the comparison holds, which is -1 as an integer
+		__m128i over = _mm_castps_si128(_mm_cmpgt_ps(dist, over_epsilon));
+		__m128i under = _mm_castps_si128(_mm_cmplt_ps(dist, under_epsilon));
+		__m128i codes = _mm_add_epi32(_mm_add_epi32(on_code, _mm_and_si128(over, over_offset)), under);
+
+		codes = _mm_packs_epi32(codes, codes);
+		codes = _mm_packus_epi16(codes, codes);
+		int packed = _mm_cvtsi128_si32(codes);
+		memcpy(r_sides + i, &packed, 4);
+	}
+
+	classify_scalar(plane, p_vertices + i, p_count - i, r_distances + i, r_sides + i);
+}
+#elif defined(VERTEX_CLASSIFIER_NEON)
+void classify(const Plane &plane, const Vector3 *p_vertices, int p_count, real_t *r_distances, SideOfPlane *r_sides) {
+	static_assert(sizeof(Vector3) == sizeof(float) * 3, "Vector3 is expected to be tightly packed");
+	const float *src = reinterpret_cast<const float *>(p_vertices);
+
+	const float32x4_t nx = vdupq_n_f32(plane.normal.x);
+	const float32x4_t ny = vdupq_n_f32(plane.normal.y);
+	const float32x4_t nz = vdupq_n_f32(plane.normal.z);
+	const float32x4_t d = vdupq_n_f32(plane.d);
+	const float32x4_t over_epsilon = vdupq_n_f32(CMP_EPSILON);
+	const float32x4_t under_epsilon = vdupq_n_f32(-CMP_EPSILON);
+	const uint32x4_t on_code = vdupq_n_u32(SideOfPlane::ON);
+	const uint32x4_t over_offset = vdupq_n_u32(SideOfPlane::ON - SideOfPlane::OVER);
+	const uint32x4_t under_offset = vdupq_n_u32(SideOfPlane::ON - SideOfPlane::UNDER);
+
+	int i = 0;
+	for (; i + 4 <= p_count; i += 4) {
+		// NEON can deinterleave the positions straight out of memory
+		float32x4x3_t position = vld3q_f32(src + i * 3);
+		float32x4_t dist = vsubq_f32(vaddq_f32(vaddq_f32(vmulq_f32(position.val[0], nx), vmulq_f32(position.val[1], ny)), vmulq_f32(position.val[2], nz)), d);
+		vst1q_f32(r_distances + i, dist);
+
+		uint32x4_t over = vcgtq_f32(dist, over_epsilon);
+		uint32x4_t under = vcltq_f32(dist, under_epsilon);
+		uint32x4_t codes = vsubq_u32(vsubq_u32(on_code, vandq_u32(over, over_offset)), vandq_u32(under, under_offset));
+
+		uint8x8_t narrowed = vmovn_u16(vcombine_u16(vmovn_u32(codes), vdup_n_u16(0)));
+		uint32_t packed = vget_lane_u32(vreinterpret_u32_u8(narrowed), 0);
+		memcpy(r_sides + i, &packed, 4);
+	}
+
+	classify_scalar(plane, p_vertices + i, p_count - i, r_distances + i, r_sides + i);
+}
+#else
+void classify(const Plane &plane, const Vector3 *p_vertices, int p_count, real_t *r_distances, SideOfPlane *r_sides) {
+	classify_scalar(plane, p_vertices, p_count, r_distances, r_sides);
+}
+#endif
+} //namespace VertexClassifier
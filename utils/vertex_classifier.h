@@ -0,0 +1,56 @@
+/**************************************************************************/
+/*  vertex_classifier.h                                                   */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef VERTEX_CLASSIFIER_H
+#define VERTEX_CLASSIFIER_H
+
+#include "intersector.h"
+
+/**
+ * Works out which side of a plane every vertex in a stream falls on in a single sweep,
+ * rather than one point at a time as faces get visited. On x86 this uses SSE2 and on
+ * ARM NEON, four vertices at a time, with a scalar fallback for everything else
+ * (including double precision builds)
+ */
+namespace VertexClassifier {
+/**
+ * Fills r_distances with the signed distance of each vertex from the plane and r_sides
+ * with the matching Intersector::get_side_of result. Both need room for p_count entries
+ */
+void classify(const Plane &plane, const Vector3 *p_vertices, int p_count, real_t *r_distances, Intersector::SideOfPlane *r_sides);
+
+/**
+ * The plain, one vertex at a time version of classify. Mostly here so the SIMD paths
+ * have something to be checked against
+ */
+void classify_scalar(const Plane &plane, const Vector3 *p_vertices, int p_count, real_t *r_distances, Intersector::SideOfPlane *r_sides);
+} //namespace VertexClassifier
+
+#endif // VERTEX_CLASSIFIER_H